@@ -31,7 +31,7 @@ void fpi_drvcb_open_complete(struct fp_dev *dev, int status)
 	fp_dbg("status %d", status);
 	BUG_ON(dev->state != DEV_STATE_INITIALIZING);
 	dev->state = (status) ? DEV_STATE_ERROR : DEV_STATE_INITIALIZED;
-	opened_devices = g_slist_prepend(opened_devices, dev);
+	dev->ctx->opened_devices = g_slist_prepend(dev->ctx->opened_devices, dev);
 	if (dev->open_cb)
 		dev->open_cb(dev, status, dev->open_cb_data);
 }
@@ -52,6 +52,7 @@ API_EXPORTED int fp_async_dev_open(struct fp_dscv_dev *ddev, fp_dev_open_cb cb,
 	}
 
 	dev = g_malloc0(sizeof(*dev));
+	dev->ctx = fpi_get_context();
 	dev->drv = drv;
 	dev->udev = udevh;
 	dev->__enroll_stage = -1;
@@ -92,9 +93,10 @@ API_EXPORTED void fp_async_dev_close(struct fp_dev *dev,
 {
 	struct fp_driver *drv = dev->drv;
 
-	if (g_slist_index(opened_devices, (gconstpointer) dev) == -1)
+	if (g_slist_index(dev->ctx->opened_devices, (gconstpointer) dev) == -1)
 		fp_err("device %p not in opened list!", dev);
-	opened_devices = g_slist_remove(opened_devices, (gconstpointer) dev);
+	dev->ctx->opened_devices = g_slist_remove(dev->ctx->opened_devices,
+		(gconstpointer) dev);
 
 	dev->close_cb = callback;
 	dev->close_cb_data = user_data;
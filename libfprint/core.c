@@ -30,8 +30,9 @@
 static int log_level = 0;
 static int log_level_fixed = 0;
 
-libusb_context *fpi_usb_ctx = NULL;
-GSList *opened_devices = NULL;
+/* the context set up by fp_init(), used by threads without one of their own */
+static struct fp_context default_ctx;
+static GPrivate current_ctx;
 
 /**
  * \mainpage libfprint API Reference
@@ -177,6 +178,34 @@ GSList *opened_devices = NULL;
 
 /** @defgroup core Core library operations */
 
+/**
+ * @defgroup context Library contexts
+ * A context holds the USB context, the open devices, the pending timeouts
+ * and the poll fds that the library works with. fp_init() sets up a default
+ * context, which serves applications that do not care about threads.
+ * Further contexts can be created with fp_context_new().
+ *
+ * Every libfprint call operates on the context of the calling thread: the
+ * one chosen with fp_context_set_thread_default(), or else the default
+ * context. Devices are discovered and opened in that context, and their
+ * events are only handled by fp_handle_events() and event loops of that
+ * context.
+ *
+ * \section threading Threading
+ * Separate contexts can be used from different threads at the same time,
+ * for example one thread per USB bus, each with its own context. A context
+ * must only be used by one thread at a time. Threads sharing a context must
+ * serialize their libfprint calls on it with a lock of their own, and set
+ * the context as their thread default.
+ *
+ * Print data, images and galleries can be used from any thread, as long as
+ * a single object is not used from two threads at once. Print matching runs
+ * on an internal worker pool and may be called from any thread.
+ *
+ * fp_init() and fp_exit() must not run at the same time as any other
+ * libfprint call.
+ */
+
 /**
  * @defgroup dev Device operations
  * In order to interact with fingerprint scanners, your software will
@@ -279,6 +308,7 @@ GSList *opened_devices = NULL;
  * circumstances, you don't have to worry about driver IDs at all.
  */
 
+/* built by fp_init() and only read afterwards, from any context */
 static GSList *registered_drivers = NULL;
 
 void fpi_log(enum fpi_log_level level, const char *component,
@@ -434,6 +464,18 @@ API_EXPORTED struct fp_driver **fprint_get_drivers (void)
 	return (struct fp_driver **) g_ptr_array_free (array, FALSE);
 }
 
+struct fp_driver *fpi_find_driver(uint16_t driver_id)
+{
+	GSList *elem;
+
+	for (elem = registered_drivers; elem; elem = g_slist_next(elem)) {
+		struct fp_driver *drv = elem->data;
+		if (drv->id == driver_id)
+			return drv;
+	}
+	return NULL;
+}
+
 static struct fp_driver *find_supporting_driver(libusb_device *udev,
 	const struct usb_id **usb_id, uint32_t *devtype)
 {
@@ -538,7 +580,7 @@ API_EXPORTED struct fp_dscv_dev **fp_discover_devs(void)
 	if (registered_drivers == NULL)
 		return NULL;
 
-	r = libusb_get_device_list(fpi_usb_ctx, &devs);
+	r = libusb_get_device_list(fpi_get_context()->usb_ctx, &devs);
 	if (r < 0) {
 		fp_err("couldn't enumerate USB devices, error %d", r);
 		return NULL;
@@ -901,7 +943,123 @@ API_EXPORTED void fp_set_debug(int level)
 		return;
 
 	log_level = level;
-	libusb_set_debug(fpi_usb_ctx, level);
+	libusb_set_debug(fpi_get_context()->usb_ctx, level);
+}
+
+/* returns the context of the calling thread */
+struct fp_context *fpi_get_context(void)
+{
+	struct fp_context *ctx = g_private_get(&current_ctx);
+
+	return ctx ? ctx : &default_ctx;
+}
+
+/* makes ctx the context of the calling thread, NULL meaning the default
+ * context, and returns the previous setting for restoring it later */
+struct fp_context *fpi_set_context(struct fp_context *ctx)
+{
+	struct fp_context *prev = g_private_get(&current_ctx);
+
+	g_private_set(&current_ctx, ctx);
+	return prev;
+}
+
+static int context_init(struct fp_context *ctx)
+{
+	int r;
+
+	r = libusb_init(&ctx->usb_ctx);
+	if (r < 0)
+		return r;
+	if (log_level)
+		libusb_set_debug(ctx->usb_ctx, log_level);
+
+	ctx->opened_devices = NULL;
+	ctx->prefilter_percent = 0;
+	ctx->prefilter_pruned_total = 0;
+	r = fpi_poll_init(ctx);
+	if (r < 0) {
+		libusb_exit(ctx->usb_ctx);
+		ctx->usb_ctx = NULL;
+		return r;
+	}
+	return 0;
+}
+
+static void context_exit(struct fp_context *ctx)
+{
+	struct fp_context *prev_ctx;
+
+	/* the devices are closed through the context's own events */
+	prev_ctx = fpi_set_context(ctx);
+	if (ctx->opened_devices) {
+		GSList *copy = g_slist_copy(ctx->opened_devices);
+		GSList *elem = copy;
+		fp_dbg("naughty app left devices open on exit!");
+
+		do
+			fp_dev_close((struct fp_dev *) elem->data);
+		while ((elem = g_slist_next(elem)));
+
+		g_slist_free(copy);
+		g_slist_free(ctx->opened_devices);
+		ctx->opened_devices = NULL;
+	}
+	fpi_set_context(prev_ctx == ctx ? NULL : prev_ctx);
+
+	fpi_poll_exit(ctx);
+	libusb_exit(ctx->usb_ctx);
+	ctx->usb_ctx = NULL;
+}
+
+/** \ingroup context
+ * Create a library context, with a USB context of its own. fp_init() must
+ * have been called first.
+ * \returns a new context, or NULL on error. Must be freed with
+ * fp_context_free() after use.
+ */
+API_EXPORTED struct fp_context *fp_context_new(void)
+{
+	struct fp_context *ctx;
+
+	if (registered_drivers == NULL) {
+		fp_err("library not initialised");
+		return NULL;
+	}
+
+	ctx = g_malloc0(sizeof(*ctx));
+	if (context_init(ctx) < 0) {
+		g_free(ctx);
+		return NULL;
+	}
+	return ctx;
+}
+
+/** \ingroup context
+ * Free a context created with fp_context_new(). Devices left open in the
+ * context are closed first. If the context is the thread default of the
+ * calling thread, the thread goes back to the default context. It must not
+ * be the thread default of any other thread.
+ * \param ctx the context to free. If NULL, function simply returns.
+ */
+API_EXPORTED void fp_context_free(struct fp_context *ctx)
+{
+	if (!ctx)
+		return;
+
+	context_exit(ctx);
+	g_free(ctx);
+}
+
+/** \ingroup context
+ * Choose the context that the libfprint calls of the calling thread operate
+ * on.
+ * \param ctx a context created with fp_context_new(), or NULL for the
+ * default context
+ */
+API_EXPORTED void fp_context_set_thread_default(struct fp_context *ctx)
+{
+	fpi_set_context(ctx);
 }
 
 /** \ingroup core
@@ -915,20 +1073,17 @@ API_EXPORTED int fp_init(void)
 	int r;
 	fp_dbg("");
 
-	r = libusb_init(&fpi_usb_ctx);
-	if (r < 0)
-		return r;
-
 	if (dbg) {
 		log_level = atoi(dbg);
-		if (log_level) {
+		if (log_level)
 			log_level_fixed = 1;
-			libusb_set_debug(fpi_usb_ctx, log_level);
-		}
 	}
 
+	r = context_init(&default_ctx);
+	if (r < 0)
+		return r;
+
 	register_drivers();
-	fpi_poll_init();
 	return 0;
 }
 
@@ -941,24 +1096,11 @@ API_EXPORTED void fp_exit(void)
 {
 	fp_dbg("");
 
-	if (opened_devices) {
-		GSList *copy = g_slist_copy(opened_devices);
-		GSList *elem = copy;
-		fp_dbg("naughty app left devices open on exit!");
-
-		do
-			fp_dev_close((struct fp_dev *) elem->data);
-		while ((elem = g_slist_next(elem)));
-
-		g_slist_free(copy);
-		g_slist_free(opened_devices);
-		opened_devices = NULL;
-	}
+	context_exit(&default_ctx);
 
 	fpi_data_exit();
-	fpi_poll_exit();
+	fpi_img_exit();
 	g_slist_free(registered_drivers);
 	registered_drivers = NULL;
-	libusb_exit(fpi_usb_ctx);
 }
 
@@ -47,7 +47,9 @@
  * in any fashion that suits you.
  */
 
+/* set up on first use, from any context */
 static char *base_store = NULL;
+static GMutex base_store_lock;
 
 static void storage_setup(void)
 {
@@ -64,9 +66,23 @@ static void storage_setup(void)
 	/* FIXME handle failure */
 }
 
+/* returns the directory prints are stored in, or NULL if there is none */
+static const char *get_base_store(void)
+{
+	const char *ret;
+
+	g_mutex_lock(&base_store_lock);
+	if (!base_store)
+		storage_setup();
+	ret = base_store;
+	g_mutex_unlock(&base_store_lock);
+	return ret;
+}
+
 void fpi_data_exit(void)
 {
 	g_free(base_store);
+	base_store = NULL;
 }
 
 #define FP_FINGER_IS_VALID(finger) \
@@ -107,6 +123,10 @@ static struct fp_print_data *print_data_new(uint16_t driver_id,
 
 void fpi_print_data_item_free(struct fp_print_data_item *item)
 {
+	if (item->bz_tmpl)
+		fpi_img_free_gallery_tmpl(item->bz_tmpl);
+	if (item->mapped)
+		g_mapped_file_unref(item->mapped);
 	g_free(item);
 }
 
@@ -114,6 +134,22 @@ struct fp_print_data_item *fpi_print_data_item_new(size_t length)
 {
 	struct fp_print_data_item *item = g_malloc(sizeof(*item) + length);
 	item->length = length;
+	item->bz_tmpl = NULL;
+	item->data = item->buf;
+	item->mapped = NULL;
+
+	return item;
+}
+
+/* an item whose data lives in a mapped file rather than in the item */
+static struct fp_print_data_item *print_data_item_new_mapped(
+	GMappedFile *mapped, unsigned char *data, size_t length)
+{
+	struct fp_print_data_item *item = g_malloc(sizeof(*item));
+	item->length = length;
+	item->bz_tmpl = NULL;
+	item->data = data;
+	item->mapped = g_mapped_file_ref(mapped);
 
 	return item;
 }
@@ -124,10 +160,54 @@ struct fp_print_data *fpi_print_data_new(struct fp_dev *dev)
 		fpi_driver_get_data_type(dev->drv));
 }
 
+static const uint32_t crc32_nibble_table[16] = {
+	0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac,
+	0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+	0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+	0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+
+/* the CRC-32 of zlib and IEEE 802.3 */
+static uint32_t fp3_crc32(const unsigned char *buf, size_t len)
+{
+	uint32_t crc = 0xffffffff;
+
+	while (len--) {
+		crc ^= *buf++;
+		crc = (crc >> 4) ^ crc32_nibble_table[crc & 0xf];
+		crc = (crc >> 4) ^ crc32_nibble_table[crc & 0xf];
+	}
+	return ~crc;
+}
+
+/* Copies item data between host and FP3 representation, in either direction.
+ * NBIS minutiae items are arrays of 16-bit values, anything else is an opaque
+ * byte string. */
+static void fp3_copy_item_data(enum fp_print_data_type type,
+	unsigned char *dst, const unsigned char *src, size_t len)
+{
+	uint16_t val;
+	size_t i;
+
+	if (G_BYTE_ORDER == G_LITTLE_ENDIAN || type != PRINT_DATA_NBIS_MINUTIAE) {
+		memcpy(dst, src, len);
+		return;
+	}
+
+	for (i = 0; i + sizeof(val) <= len; i += sizeof(val)) {
+		memcpy(&val, src + i, sizeof(val));
+		val = GUINT16_SWAP_LE_BE(val);
+		memcpy(dst + i, &val, sizeof(val));
+	}
+	memcpy(dst + i, src + i, len - i);
+}
+
 /** \ingroup print_data
  * Convert a stored print into a unified representation inside a data buffer.
  * You can then store this data buffer in any way that suits you, and load
- * it back at some later time using fp_print_data_from_data().
+ * it back at some later time using fp_print_data_from_data(). The
+ * representation does not depend on the byte order of the host, so the
+ * buffer can be loaded on a different machine.
  * \param data the stored print
  * \param ret output location for the data buffer. Must be freed with free()
  * after use.
@@ -136,10 +216,11 @@ struct fp_print_data *fpi_print_data_new(struct fp_dev *dev)
 API_EXPORTED size_t fp_print_data_get_data(struct fp_print_data *data,
 	unsigned char **ret)
 {
-	struct fpi_print_data_fp2 *out_data;
-	struct fpi_print_data_item_fp2 *out_item;
+	struct fpi_print_data_fp3 *out_data;
+	struct fpi_print_data_item_fp3 *out_item;
 	struct fp_print_data_item *item;
 	size_t buflen = 0;
+	guint nr_items = 0;
 	GSList *list_item;
 	unsigned char *buf;
 
@@ -148,38 +229,66 @@ API_EXPORTED size_t fp_print_data_get_data(struct fp_print_data *data,
 	list_item = data->prints;
 	while (list_item) {
 		item = list_item->data;
+		if (item->length > G_MAXUINT32) {
+			fp_err("print item too large");
+			return 0;
+		}
 		buflen += sizeof(*out_item);
-		buflen += item->length;
+		buflen += FP3_PADDED(item->length);
+		nr_items++;
 		list_item = g_slist_next(list_item);
 	}
 
+	if (nr_items > G_MAXUINT16) {
+		fp_err("too many items in print");
+		return 0;
+	}
+
 	buflen += sizeof(*out_data);
-	out_data = g_malloc(buflen);
+	out_data = g_malloc0(buflen);
 
 	*ret = (unsigned char *) out_data;
 	buf = out_data->data;
 	out_data->prefix[0] = 'F';
 	out_data->prefix[1] = 'P';
-	out_data->prefix[2] = '2';
+	out_data->prefix[2] = '3';
+	out_data->data_type = data->type;
 	out_data->driver_id = GUINT16_TO_LE(data->driver_id);
+	out_data->nr_items = GUINT16_TO_LE(nr_items);
 	out_data->devtype = GUINT32_TO_LE(data->devtype);
-	out_data->data_type = data->type;
 
 	list_item = data->prints;
 	while (list_item) {
 		item = list_item->data;
-		out_item = (struct fpi_print_data_item_fp2 *)buf;
+		out_item = (struct fpi_print_data_item_fp3 *)buf;
 		out_item->length = GUINT32_TO_LE(item->length);
-		/* FIXME: fp_print_data_item->data content is not endianess agnostic */
-		memcpy(out_item->data, item->data, item->length);
+		fp3_copy_item_data(data->type, out_item->data, item->data,
+			item->length);
+		out_item->crc = GUINT32_TO_LE(fp3_crc32(out_item->data,
+			item->length));
 		buf += sizeof(*out_item);
-		buf += item->length;
+		buf += FP3_PADDED(item->length);
 		list_item = g_slist_next(list_item);
 	}
 
 	return buflen;
 }
 
+/* returns NULL if the data does not hold a valid sample of the given type */
+static struct fp_print_data_item *print_data_item_from_data(
+	enum fp_print_data_type type, unsigned char *buf, size_t len)
+{
+	struct fp_print_data_item *item;
+
+	if (type == PRINT_DATA_NBIS_MINUTIAE)
+		return fpi_img_print_data_item_from_data(buf, len);
+
+	item = fpi_print_data_item_new(len);
+	/* FIXME: fp_print_data->data content is not endianess agnostic */
+	memcpy(item->data, buf, len);
+	return item;
+}
+
 static struct fp_print_data *fpi_print_data_from_fp1_data(unsigned char *buf,
 	size_t buflen)
 {
@@ -191,9 +300,12 @@ static struct fp_print_data *fpi_print_data_from_fp1_data(unsigned char *buf,
 	print_data_len = buflen - sizeof(*raw);
 	data = print_data_new(GUINT16_FROM_LE(raw->driver_id),
 		GUINT32_FROM_LE(raw->devtype), raw->data_type);
-	item = fpi_print_data_item_new(print_data_len);
-	/* FIXME: fp_print_data->data content is not endianess agnostic */
-	memcpy(item->data, raw->data, print_data_len);
+	item = print_data_item_from_data(data->type, raw->data, print_data_len);
+	if (!item) {
+		fp_err("corrupted fingerprint data");
+		fp_print_data_free(data);
+		return NULL;
+	}
 	data->prints = g_slist_prepend(data->prints, item);
 
 	return data;
@@ -227,9 +339,12 @@ static struct fp_print_data *fpi_print_data_from_fp2_data(unsigned char *buf,
 		}
 		total_data_len -= item_len;
 
-		item = fpi_print_data_item_new(item_len);
-		/* FIXME: fp_print_data->data content is not endianess agnostic */
-		memcpy(item->data, raw_item->data, item_len);
+		item = print_data_item_from_data(data->type, raw_item->data,
+			item_len);
+		if (!item) {
+			fp_err("corrupted fingerprint data");
+			break;
+		}
 		data->prints = g_slist_prepend(data->prints, item);
 
 		raw_buf += sizeof(*raw_item);
@@ -245,17 +360,87 @@ static struct fp_print_data *fpi_print_data_from_fp2_data(unsigned char *buf,
 
 }
 
-/** \ingroup print_data
- * Load a stored print from a data buffer. The contents of said buffer must
- * be the untouched contents of a buffer previously supplied to you by the
- * fp_print_data_get_data() function.
- * \param buf the data buffer
- * \param buflen the length of the buffer
- * \returns the stored print represented by the data, or NULL on error. Must
- * be freed with fp_print_data_free() after use.
- */
-API_EXPORTED struct fp_print_data *fp_print_data_from_data(unsigned char *buf,
-	size_t buflen)
+/* Builds an item from FP3 item data. When the data is in a mapped file, and
+ * needs neither byte swapping nor realignment, the item refers to it in place
+ * instead of copying it. */
+static struct fp_print_data_item *fp3_item_new(enum fp_print_data_type type,
+	unsigned char *buf, size_t len, GMappedFile *mapped)
+{
+	struct fp_print_data_item *item;
+
+	if (mapped && G_BYTE_ORDER == G_LITTLE_ENDIAN
+			&& ((uintptr_t) buf % FP3_ALIGN) == 0) {
+		if (type == PRINT_DATA_NBIS_MINUTIAE
+				&& !fpi_img_xyt_is_valid(buf, len))
+			return NULL;
+		return print_data_item_new_mapped(mapped, buf, len);
+	}
+
+	item = fpi_print_data_item_new(len);
+	fp3_copy_item_data(type, item->data, buf, len);
+	if (type == PRINT_DATA_NBIS_MINUTIAE
+			&& !fpi_img_xyt_is_valid(item->data, len)) {
+		fpi_print_data_item_free(item);
+		return NULL;
+	}
+	return item;
+}
+
+static struct fp_print_data *fpi_print_data_from_fp3_data(unsigned char *buf,
+	size_t buflen, GMappedFile *mapped)
+{
+	struct fpi_print_data_fp3 *raw = (struct fpi_print_data_fp3 *) buf;
+	struct fpi_print_data_item_fp3 *raw_item;
+	struct fp_print_data *data;
+	struct fp_print_data_item *item;
+	size_t offset, item_len;
+	guint nr_items, i;
+
+	if (buflen < sizeof(*raw))
+		return NULL;
+
+	data = print_data_new(GUINT16_FROM_LE(raw->driver_id),
+		GUINT32_FROM_LE(raw->devtype), raw->data_type);
+	nr_items = GUINT16_FROM_LE(raw->nr_items);
+	offset = sizeof(*raw);
+
+	for (i = 0; i < nr_items; i++) {
+		if (buflen - offset < sizeof(*raw_item))
+			goto corrupt;
+		raw_item = (struct fpi_print_data_item_fp3 *) (buf + offset);
+		offset += sizeof(*raw_item);
+
+		item_len = GUINT32_FROM_LE(raw_item->length);
+		if (buflen - offset < item_len)
+			goto corrupt;
+		if (fp3_crc32(raw_item->data, item_len)
+				!= GUINT32_FROM_LE(raw_item->crc))
+			goto corrupt;
+
+		item = fp3_item_new(data->type, raw_item->data, item_len, mapped);
+		if (!item)
+			goto corrupt;
+		data->prints = g_slist_prepend(data->prints, item);
+
+		/* the padding of the last item may be missing */
+		offset += MIN(FP3_PADDED(item_len), buflen - offset);
+	}
+
+	if (!data->prints)
+		goto corrupt;
+
+	data->prints = g_slist_reverse(data->prints);
+	return data;
+
+corrupt:
+	fp_err("corrupted fingerprint data");
+	fp_print_data_free(data);
+	return NULL;
+}
+
+/* mapped is the file that buf was mapped from, if any */
+struct fp_print_data *fpi_print_data_from_data(unsigned char *buf,
+	size_t buflen, GMappedFile *mapped)
 {
 	struct fpi_print_data_fp2 *raw = (struct fpi_print_data_fp2 *) buf;
 
@@ -267,6 +452,8 @@ API_EXPORTED struct fp_print_data *fp_print_data_from_data(unsigned char *buf,
 		return fpi_print_data_from_fp1_data(buf, buflen);
 	} else if (strncmp(raw->prefix, "FP2", 3) == 0) {
 		return fpi_print_data_from_fp2_data(buf, buflen);
+	} else if (strncmp(raw->prefix, "FP3", 3) == 0) {
+		return fpi_print_data_from_fp3_data(buf, buflen, mapped);
 	} else {
 		fp_dbg("bad header prefix");
 	}
@@ -274,6 +461,21 @@ API_EXPORTED struct fp_print_data *fp_print_data_from_data(unsigned char *buf,
 	return NULL;
 }
 
+/** \ingroup print_data
+ * Load a stored print from a data buffer. The contents of said buffer must
+ * be the untouched contents of a buffer previously supplied to you by the
+ * fp_print_data_get_data() function, possibly on a different machine.
+ * \param buf the data buffer
+ * \param buflen the length of the buffer
+ * \returns the stored print represented by the data, or NULL on error. Must
+ * be freed with fp_print_data_free() after use.
+ */
+API_EXPORTED struct fp_print_data *fp_print_data_from_data(unsigned char *buf,
+	size_t buflen)
+{
+	return fpi_print_data_from_data(buf, buflen, NULL);
+}
+
 static char *get_path_to_storedir(uint16_t driver_id, uint32_t devtype)
 {
 	char idstr[5];
@@ -305,6 +507,22 @@ static char *get_path_to_print(struct fp_dev *dev, enum fp_finger finger)
 	return __get_path_to_print(dev->drv->id, dev->devtype, finger);
 }
 
+/* The gallery store of a device type sits next to its per-finger directory.
+ * Its name is longer than a devtype, so print discovery skips it. */
+char *fpi_data_get_gallery_path(uint16_t driver_id, uint32_t devtype)
+{
+	char idstr[5];
+	char filename[17];
+
+	if (!get_base_store())
+		return NULL;
+
+	g_snprintf(idstr, sizeof(idstr), "%04x", driver_id);
+	g_snprintf(filename, sizeof(filename), "%08x.gallery", devtype);
+
+	return g_build_filename(base_store, idstr, filename, NULL);
+}
+
 /** \ingroup print_data
  * Saves a stored print to disk, assigned to a specific finger. Even though
  * you are limited to storing only the 10 human fingers, this is a
@@ -330,8 +548,7 @@ API_EXPORTED int fp_print_data_save(struct fp_print_data *data,
 	size_t len;
 	int r;
 
-	if (!base_store)
-		storage_setup();
+	get_base_store();
 
 	fp_dbg("save %s print from driver %04x", finger_num_to_str(finger),
 		data->driver_id);
@@ -389,13 +606,14 @@ gboolean fpi_print_data_compatible(uint16_t driver_id1, uint32_t devtype1,
 
 static int load_from_file(char *path, struct fp_print_data **data)
 {
-	gsize length;
-	gchar *contents;
+	GMappedFile *mapped;
 	GError *err = NULL;
 	struct fp_print_data *fdata;
 
 	fp_dbg("from %s", path);
-	g_file_get_contents(path, &contents, &length, &err);
+	/* items of FP3 prints refer to the mapping rather than copying it, and
+	 * keep it alive after we drop our reference */
+	mapped = g_mapped_file_new(path, FALSE, &err);
 	if (err) {
 		int r = err->code;
 		fp_err("%s load failed: %s", path, err->message);
@@ -407,8 +625,10 @@ static int load_from_file(char *path, struct fp_print_data **data)
 			return r;
 	}
 
-	fdata = fp_print_data_from_data(contents, length);
-	g_free(contents);
+	fdata = fpi_print_data_from_data(
+		(unsigned char *) g_mapped_file_get_contents(mapped),
+		g_mapped_file_get_length(mapped), mapped);
+	g_mapped_file_unref(mapped);
 	if (!fdata)
 		return -EIO;
 	*data = fdata;
@@ -436,8 +656,7 @@ API_EXPORTED int fp_print_data_load(struct fp_dev *dev,
 	struct fp_print_data *fdata;
 	int r;
 
-	if (!base_store)
-		storage_setup();
+	get_base_store();
 
 	path = get_path_to_print(dev, finger);
 	r = load_from_file(path, &fdata);
@@ -660,8 +879,7 @@ API_EXPORTED struct fp_dscv_print **fp_discover_prints(void)
 	struct fp_dscv_print **list;
 	unsigned int i;
 
-	if (!base_store)
-		storage_setup();
+	get_base_store();
 
 	dir = g_dir_open(base_store, 0, &err);
 	if (!dir) {
@@ -0,0 +1,123 @@
+/*
+ * Enrollment sample check test
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Feeds sequences of enrollment samples to fpi_imgdev_enroll_check(), where
+ * samples of the same finger match and samples of different fingers do not,
+ * and checks the results of the stages: a bad first sample is replaced
+ * rather than failing the enrollment, and enrollment only fails after
+ * several samples in a row that contradict a matching pair. */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "fp_internal.h"
+
+#define THRESHOLD	40
+#define NR_STAGES	5
+
+struct enrollment {
+	struct fp_img_dev imgdev;
+	/* fingers of the kept samples, newest first like enroll_data */
+	int kept[NR_STAGES];
+	int nr_kept;
+};
+
+/* adds a sample of finger and returns the result of the stage */
+static int enroll_sample(struct enrollment *e, int finger)
+{
+	int scores[NR_STAGES];
+	int i, r, replace;
+
+	for (i = 0; i < e->nr_kept; i++)
+		scores[i] = e->kept[i] == finger ? THRESHOLD + 10 : 5;
+
+	r = fpi_imgdev_enroll_check(&e->imgdev, scores, e->nr_kept,
+		THRESHOLD, &replace);
+	if (replace >= 0) {
+		if (r != FP_ENROLL_RETRY)
+			return -1;
+		e->kept[replace] = finger;
+	} else if (r == FP_ENROLL_PASS) {
+		memmove(e->kept + 1, e->kept, e->nr_kept * sizeof(int));
+		e->kept[0] = finger;
+		if (++e->nr_kept == NR_STAGES)
+			r = FP_ENROLL_COMPLETE;
+	}
+	return r;
+}
+
+static int check(const char *name, const int *fingers, const int *results,
+	int n)
+{
+	struct enrollment e;
+	int i, r;
+
+	memset(&e, 0, sizeof(e));
+	for (i = 0; i < n; i++) {
+		r = enroll_sample(&e, fingers[i]);
+		if (r != results[i]) {
+			fprintf(stderr, "%s: sample %d gave %d, expected %d\n",
+				name, i, r, results[i]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static const int bad_first_fingers[] = { 2, 1, 1, 1, 1, 1 };
+static const int bad_first_results[] = {
+	FP_ENROLL_PASS, FP_ENROLL_RETRY, FP_ENROLL_PASS, FP_ENROLL_PASS,
+	FP_ENROLL_PASS, FP_ENROLL_COMPLETE,
+};
+
+static const int bad_second_fingers[] = { 1, 2, 1, 1, 1, 1 };
+static const int bad_second_results[] = {
+	FP_ENROLL_PASS, FP_ENROLL_RETRY, FP_ENROLL_RETRY, FP_ENROLL_PASS,
+	FP_ENROLL_PASS, FP_ENROLL_PASS,
+};
+
+static const int fail_fingers[] = { 1, 1, 2, 3, 2 };
+static const int fail_results[] = {
+	FP_ENROLL_PASS, FP_ENROLL_PASS, FP_ENROLL_RETRY, FP_ENROLL_RETRY,
+	FP_ENROLL_FAIL,
+};
+
+static const int recover_fingers[] = { 1, 1, 2, 2, 1, 2, 2, 1, 1 };
+static const int recover_results[] = {
+	FP_ENROLL_PASS, FP_ENROLL_PASS, FP_ENROLL_RETRY, FP_ENROLL_RETRY,
+	FP_ENROLL_PASS, FP_ENROLL_RETRY, FP_ENROLL_RETRY, FP_ENROLL_PASS,
+	FP_ENROLL_COMPLETE,
+};
+
+#define CHECK(name) check(#name, name##_fingers, name##_results, \
+	G_N_ELEMENTS(name##_results))
+
+int main(void)
+{
+	int r = 0;
+
+	if (CHECK(bad_first))
+		r = 1;
+	if (CHECK(bad_second))
+		r = 1;
+	if (CHECK(fail))
+		r = 1;
+	if (CHECK(recover))
+		r = 1;
+	return r;
+}
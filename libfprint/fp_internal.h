@@ -100,6 +100,7 @@ enum fp_dev_state {
 struct fp_driver **fprint_get_drivers (void);
 
 struct fp_dev {
+	struct fp_context *ctx;
 	struct fp_driver *drv;
 	libusb_device_handle *udev;
 	uint32_t devtype;
@@ -162,6 +163,7 @@ enum fp_imgdev_enroll_state {
 	IMG_ACQUIRE_STATE_ACTIVATING,
 	IMG_ACQUIRE_STATE_AWAIT_FINGER_ON,
 	IMG_ACQUIRE_STATE_AWAIT_IMAGE,
+	IMG_ACQUIRE_STATE_PROCESSING,
 	IMG_ACQUIRE_STATE_AWAIT_FINGER_OFF,
 	IMG_ACQUIRE_STATE_DONE,
 	IMG_ACQUIRE_STATE_DEACTIVATING,
@@ -172,6 +174,8 @@ enum fp_imgdev_verify_state {
 	IMG_VERIFY_STATE_ACTIVATING
 };
 
+struct imgdev_capture_job;
+
 struct fp_img_dev {
 	struct fp_dev *dev;
 	libusb_device_handle *udev;
@@ -182,11 +186,26 @@ struct fp_img_dev {
 	struct fp_print_data *enroll_data;
 	struct fp_img *acquire_img;
 	int enroll_stage;
+	/* consecutive enrollment samples that matched no earlier stage */
+	int enroll_mismatches;
+	/* bit n is set if the nth sample of enroll_data matches another one */
+	guint enroll_paired;
 	int action_result;
 
+	/* image being processed on a worker thread, if any */
+	struct imgdev_capture_job *capture_job;
+	/* finger was removed while the image was being processed */
+	gboolean finger_off_pending;
+	/* completions held back until a cancelled job has stopped running */
+	gboolean deactivate_pending;
+	gboolean close_pending;
+
 	/* FIXME: better place to put this? */
 	size_t identify_match_offset;
 
+	/* minutiae detection lookup tables for the size of the last image */
+	struct lfsctx *lfsctx;
+
 	void *priv;
 };
 
@@ -304,10 +323,55 @@ extern struct fp_img_driver etes603_driver;
 #endif
 extern struct fp_img_driver etss801u_driver;
 
-extern libusb_context *fpi_usb_ctx;
-extern GSList *opened_devices;
+/* The state of a library context; see core.c. Only the thread the context
+ * is used from at a time may touch it. */
+struct fp_context {
+	libusb_context *usb_ctx;
+	GSList *opened_devices;
+
+	/* pending timeouts as a min-heap, see poll.c, and those held out of
+	 * it while expired timeouts are being handled */
+	GPtrArray *active_timers;
+	GPtrArray *held_timers;
+	guint64 timer_seq;
+	/* timerfd armed to the first timeout, and the expiry it is armed to;
+	 * -1 where timerfd is not available */
+	int timer_fd;
+	struct timeval timer_fd_expiry;
+
+	/* identification prefilter, see img.c: the share of probe edges in
+	 * percent, and the number of gallery prints pruned so far. Both are
+	 * accessed atomically, from the matching threads. */
+	gint prefilter_percent;
+	gint prefilter_pruned_total;
+
+	/* the poll fds of the context, kept up to date by the notifiers */
+	GArray *pollfds;
+	/* pollfds as struct pollfd for fp_handle_events_timeout(), rebuilt
+	 * only after the fds have changed */
+	GArray *poll_buf;
+	gboolean poll_buf_stale;
+	fp_pollfd_added_cb fd_added_cb;
+	fp_pollfd_removed_cb fd_removed_cb;
+	struct fp_event_loop *event_loop;
+
+	/* work run on worker threads, see poll.c. work_done is protected by
+	 * work_lock. */
+	GThreadPool *work_pool;
+	GMutex work_lock;
+	GSList *work_done;
+	/* readable once work is done; written through wake_write_fd, which
+	 * is the same fd for an eventfd and the write end of a pipe otherwise */
+	int wake_fd;
+	int wake_write_fd;
+};
+
+struct fp_context *fpi_get_context(void);
+struct fp_context *fpi_set_context(struct fp_context *ctx);
 
 void fpi_img_driver_setup(struct fp_img_driver *idriver);
+int fpi_img_driver_get_threshold(struct fp_driver *drv);
+struct fp_driver *fpi_find_driver(uint16_t driver_id);
 
 #define fpi_driver_to_img_driver(drv) \
 	container_of((drv), struct fp_img_driver, driver)
@@ -331,9 +395,21 @@ enum fp_print_data_type {
 	PRINT_DATA_NBIS_MINUTIAE,
 };
 
+struct bz_ctx;
+struct bz_gallery_tmpl;
+struct lfsctx;
+
 struct fp_print_data_item {
 	size_t length;
-	unsigned char data[0];
+	/* Bozorth3 edge table of an NBIS minutiae item, compiled by img.c the
+	 * first time the item is matched against in a gallery or added to an
+	 * index, and kept until it is freed */
+	struct bz_gallery_tmpl *bz_tmpl;
+	/* points at buf, or into the file the item was loaded from when it
+	 * could be used in place, in which case mapped holds a reference */
+	unsigned char *data;
+	GMappedFile *mapped;
+	unsigned char buf[0];
 };
 
 struct fp_print_data {
@@ -356,9 +432,35 @@ struct fpi_print_data_item_fp2 {
 	unsigned char data[0];
 } __attribute__((__packed__));
 
+/* FP3 fields are little-endian, as are the 16-bit values making up an NBIS
+ * minutiae item. Item headers start on an FP3_ALIGN boundary of the buffer,
+ * so that the items of a suitably aligned buffer can be used in place. */
+#define FP3_ALIGN		8
+#define FP3_PADDED(len)		(((len) + FP3_ALIGN - 1) & ~(size_t) (FP3_ALIGN - 1))
+
+struct fpi_print_data_fp3 {
+	char prefix[3];
+	unsigned char data_type;
+	uint16_t driver_id;
+	uint16_t nr_items;
+	uint32_t devtype;
+	uint32_t reserved;	/* written as zero */
+	unsigned char data[0];
+} __attribute__((__packed__));
+
+struct fpi_print_data_item_fp3 {
+	uint32_t length;	/* excluding the padding that follows the data */
+	uint32_t crc;		/* CRC-32 of the data */
+	unsigned char data[0];
+} __attribute__((__packed__));
+
 void fpi_data_exit(void);
 struct fp_print_data *fpi_print_data_new(struct fp_dev *dev);
 struct fp_print_data_item *fpi_print_data_item_new(size_t length);
+void fpi_print_data_item_free(struct fp_print_data_item *item);
+struct fp_print_data *fpi_print_data_from_data(unsigned char *buf,
+	size_t buflen, GMappedFile *mapped);
+char *fpi_data_get_gallery_path(uint16_t driver_id, uint32_t devtype);
 gboolean fpi_print_data_compatible(uint16_t driver_id1, uint32_t devtype1,
 	enum fp_print_data_type type1, uint16_t driver_id2, uint32_t devtype2,
 	enum fp_print_data_type type2);
@@ -374,6 +476,8 @@ struct fp_minutiae {
 #define FP_IMG_H_FLIPPED	(1<<1)
 #define FP_IMG_COLORS_INVERTED	(1<<2)
 #define FP_IMG_BINARIZED_FORM	(1<<3)
+/* minutiae were detected without their reliability from the quality map */
+#define FP_IMG_PARTIAL_MINUTIAE	(1<<4)
 
 #define FP_IMG_STANDARDIZATION_FLAGS (FP_IMG_V_FLIPPED | FP_IMG_H_FLIPPED \
 	| FP_IMG_COLORS_INVERTED)
@@ -392,19 +496,37 @@ struct fp_img *fpi_img_new(size_t length);
 struct fp_img *fpi_img_new_for_imgdev(struct fp_img_dev *dev);
 struct fp_img *fpi_img_resize(struct fp_img *img, size_t newsize);
 gboolean fpi_img_is_sane(struct fp_img *img);
-int fpi_img_detect_minutiae(struct fp_img *img);
+int fpi_img_detect_minutiae(struct fp_img *img, struct lfsctx **lfsctx,
+	int outputs);
+void fpi_img_free_lfsctx(struct lfsctx *lfsctx);
 int fpi_img_to_print_data(struct fp_img_dev *imgdev, struct fp_img *img,
 	struct fp_print_data **ret);
+gboolean fpi_img_xyt_is_valid(const unsigned char *buf, size_t len);
+struct fp_print_data_item *fpi_img_print_data_item_from_data(
+	const unsigned char *buf, size_t len);
 int fpi_img_compare_print_data(struct fp_print_data *enrolled_print,
 	struct fp_print_data *new_print);
-int fpi_img_compare_print_data_to_gallery(struct fp_print_data *print,
-	struct fp_print_data **gallery, int match_threshold, size_t *match_offset);
+int fpi_img_score_samples(struct fp_print_data *enrolled_print,
+	struct fp_print_data *new_print, int *scores);
+int fpi_img_compare_print_data_to_gallery(struct fp_context *fpctx,
+	struct fp_print_data *print, struct fp_print_data **gallery,
+	int match_threshold, size_t *match_offset);
+struct bz_ctx *fpi_img_get_bz_ctx(void);
+struct bz_gallery_tmpl *fpi_img_get_gallery_tmpl(struct bz_ctx *ctx,
+	struct fp_print_data_item *item);
+const unsigned char *fpi_img_get_gallery_sig(struct bz_ctx *ctx,
+	struct fp_print_data_item *item);
+void fpi_img_free_gallery_tmpl(struct bz_gallery_tmpl *tmpl);
+void fpi_img_exit(void);
 struct fp_img *fpi_im_resize(struct fp_img *img, unsigned int w_factor, unsigned int h_factor);
 
+int fpi_print_index_rank(struct fp_print_index *index,
+	struct fp_print_data *print, guint32 **ids);
+
 /* polling and timeouts */
 
-void fpi_poll_init(void);
-void fpi_poll_exit(void);
+int fpi_poll_init(struct fp_context *ctx);
+void fpi_poll_exit(struct fp_context *ctx);
 
 typedef void (*fpi_timeout_fn)(void *data);
 
@@ -413,6 +535,15 @@ struct fpi_timeout *fpi_timeout_add(unsigned int msec, fpi_timeout_fn callback,
 	void *data);
 void fpi_timeout_cancel(struct fpi_timeout *timeout);
 
+/* Work is run on a worker thread, then completed by calling its done
+ * function from the events of the context it was queued in. */
+typedef void (*fpi_work_fn)(void *data);
+
+struct fpi_work;
+struct fpi_work *fpi_work_queue(fpi_work_fn work, fpi_work_fn done,
+	void *data);
+void fpi_work_cancel(struct fpi_work *work, fpi_work_fn destroy);
+
 /* async drv <--> lib comms */
 
 struct fpi_ssm;
@@ -481,6 +612,8 @@ void fpi_imgdev_report_finger_status(struct fp_img_dev *imgdev,
 	gboolean present);
 void fpi_imgdev_image_captured(struct fp_img_dev *imgdev, struct fp_img *img);
 void fpi_imgdev_session_error(struct fp_img_dev *imgdev, int error);
+int fpi_imgdev_enroll_check(struct fp_img_dev *imgdev, const int *scores,
+	int nr_kept, int threshold, int *replace);
 
 #endif
 
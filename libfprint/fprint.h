@@ -34,6 +34,8 @@ struct fp_dev;
 struct fp_driver;
 struct fp_print_data;
 struct fp_img;
+struct fp_print_index;
+struct fp_gallery;
 
 /* misc/general stuff */
 
@@ -251,6 +253,9 @@ static inline int fp_identify_finger(struct fp_dev *dev,
 	return fp_identify_finger_img(dev, print_gallery, match_offset, NULL);
 }
 
+void fp_set_identify_prefilter(unsigned int min_percent);
+unsigned int fp_get_identify_pruned_count(void);
+
 /* Data handling */
 int fp_print_data_load(struct fp_dev *dev, enum fp_finger finger,
 	struct fp_print_data **data);
@@ -265,6 +270,24 @@ struct fp_print_data *fp_print_data_from_data(unsigned char *buf,
 uint16_t fp_print_data_get_driver_id(struct fp_print_data *data);
 uint32_t fp_print_data_get_devtype(struct fp_print_data *data);
 
+/* Gallery storage */
+struct fp_gallery *fp_gallery_open(uint16_t driver_id, uint32_t devtype);
+void fp_gallery_close(struct fp_gallery *gallery);
+int fp_gallery_append(struct fp_gallery *gallery, struct fp_print_data *data);
+int fp_gallery_delete(struct fp_gallery *gallery, int id);
+int fp_gallery_get_nr_records(struct fp_gallery *gallery);
+struct fp_print_data *fp_gallery_get_print(struct fp_gallery *gallery,
+	int id);
+
+/* Print index */
+struct fp_print_index *fp_print_index_new(struct fp_print_data **prints);
+void fp_print_index_free(struct fp_print_index *index);
+int fp_print_index_add(struct fp_print_index *index,
+	struct fp_print_data *print);
+int fp_print_index_remove(struct fp_print_index *index, int id);
+int fp_print_index_identify(struct fp_print_index *index,
+	struct fp_print_data *print, unsigned int max_candidates, int *match_id);
+
 /* Image handling */
 
 /** \ingroup img */
@@ -291,6 +314,8 @@ void fp_img_standardize(struct fp_img *img);
 struct fp_img *fp_img_binarize(struct fp_img *img);
 struct fp_minutia **fp_img_get_minutiae(struct fp_img *img, int *nr_minutiae);
 void fp_img_free(struct fp_img *img);
+int fp_img_compare_batch(struct fp_print_data *print,
+	struct fp_print_data **candidates, int *scores);
 
 /* Polling and timing */
 
@@ -302,6 +327,7 @@ struct fp_pollfd {
 int fp_handle_events_timeout(struct timeval *timeout);
 int fp_handle_events(void);
 size_t fp_get_pollfds(struct fp_pollfd **pollfds);
+size_t fp_peek_pollfds(const struct fp_pollfd **pollfds);
 int fp_get_next_timeout(struct timeval *tv);
 
 typedef void (*fp_pollfd_added_cb)(int fd, short events);
@@ -309,11 +335,24 @@ typedef void (*fp_pollfd_removed_cb)(int fd);
 void fp_set_pollfd_notifiers(fp_pollfd_added_cb added_cb,
 	fp_pollfd_removed_cb removed_cb);
 
+struct fp_event_loop;
+struct fp_event_loop *fp_event_loop_new(void);
+void fp_event_loop_free(struct fp_event_loop *loop);
+int fp_event_loop_get_fd(struct fp_event_loop *loop);
+int fp_event_loop_iterate(struct fp_event_loop *loop, int timeout_ms);
+int fp_event_loop_run(struct fp_event_loop *loop);
+void fp_event_loop_quit(struct fp_event_loop *loop);
+
 /* Library */
 int fp_init(void);
 void fp_exit(void);
 void fp_set_debug(int level);
 
+struct fp_context;
+struct fp_context *fp_context_new(void);
+void fp_context_free(struct fp_context *ctx);
+void fp_context_set_thread_default(struct fp_context *ctx);
+
 /* Asynchronous I/O */
 
 typedef void (*fp_dev_open_cb)(struct fp_dev *dev, int status, void *user_data);
@@ -0,0 +1,400 @@
+/*
+ * Packed print gallery storage for libfprint
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#define FP_COMPONENT "gallery"
+
+#include <config.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include "fp_internal.h"
+
+#define DIR_PERMS 0700
+#define FILE_PERMS 0600
+
+/** @defgroup gallery Gallery storage
+ * fp_print_data_save() keeps one file per finger and device type, which suits
+ * a handful of prints belonging to the current user. Services that identify
+ * against thousands of enrolled prints would spend most of their start-up
+ * time opening and reading those files.
+ *
+ * A gallery keeps all the prints of one device type in a single file beneath
+ * the user's home directory. Prints are appended to the end of the file and
+ * identified by a record ID; deleting a print only marks its record as
+ * deleted. The file is mapped into memory when the gallery is opened, so
+ * reading the prints back does not involve any further system calls, and
+ * on little-endian hosts the minutiae of the prints are used straight from
+ * the mapping.
+ *
+ * Only one process may have a given gallery open at a time. A gallery must
+ * not be used from several threads at once.
+ */
+
+/* All fields little-endian. Every record header, and the FP3 print that
+ * follows it, starts on an FP3_ALIGN boundary of the file. */
+struct fpi_gallery_header {
+	char magic[4];
+	uint16_t driver_id;
+	uint16_t reserved;
+	uint32_t devtype;
+	uint32_t reserved2;
+} __attribute__((__packed__));
+
+struct fpi_gallery_record {
+	uint32_t length;	/* of the FP3 print, excluding padding */
+	uint32_t flags;
+} __attribute__((__packed__));
+
+#define GALLERY_MAGIC			"FPG1"
+#define GALLERY_RECORD_DELETED		(1 << 0)
+
+struct gallery_record {
+	size_t offset;		/* of the FP3 print */
+	uint32_t length;
+	gboolean deleted;
+};
+
+struct fp_gallery {
+	uint16_t driver_id;
+	uint32_t devtype;
+	int fd;
+
+	/* the file as it was at open time or at the last remap; records
+	 * appended since may lie beyond its end */
+	GMappedFile *mapped;
+
+	/* struct gallery_record, by record ID */
+	GArray *records;
+	size_t end;
+};
+
+static int write_all(int fd, const void *buf, size_t len, off_t offset)
+{
+	const unsigned char *p = buf;
+	ssize_t r;
+
+	while (len) {
+		r = pwrite(fd, p, len, offset);
+		if (r < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		p += r;
+		len -= r;
+		offset += r;
+	}
+	return 0;
+}
+
+static int gallery_map(struct fp_gallery *gallery)
+{
+	GMappedFile *mapped;
+	GError *err = NULL;
+
+	mapped = g_mapped_file_new_from_fd(gallery->fd, FALSE, &err);
+	if (!mapped) {
+		fp_err("mapping gallery failed: %s", err->message);
+		g_error_free(err);
+		return -EIO;
+	}
+
+	/* prints loaded from the previous mapping keep it alive */
+	if (gallery->mapped)
+		g_mapped_file_unref(gallery->mapped);
+	gallery->mapped = mapped;
+	return 0;
+}
+
+/* Builds the record index from the mapped file. A record cut short by a
+ * crash during an append ends the gallery, and is truncated away. */
+static int gallery_scan(struct fp_gallery *gallery)
+{
+	const unsigned char *contents =
+		(const unsigned char *) g_mapped_file_get_contents(gallery->mapped);
+	size_t length = g_mapped_file_get_length(gallery->mapped);
+	const struct fpi_gallery_header *hdr;
+	const struct fpi_gallery_record *rec;
+	struct gallery_record record;
+	size_t offset;
+
+	if (length < sizeof(*hdr))
+		return -EIO;
+
+	hdr = (const struct fpi_gallery_header *) contents;
+	if (memcmp(hdr->magic, GALLERY_MAGIC, sizeof(hdr->magic)) != 0
+			|| GUINT16_FROM_LE(hdr->driver_id) != gallery->driver_id
+			|| GUINT32_FROM_LE(hdr->devtype) != gallery->devtype) {
+		fp_err("not a gallery for %04x/%08x", gallery->driver_id,
+			gallery->devtype);
+		return -EINVAL;
+	}
+
+	offset = sizeof(*hdr);
+	while (offset < length && length - offset >= sizeof(*rec)) {
+		rec = (const struct fpi_gallery_record *) (contents + offset);
+		record.length = GUINT32_FROM_LE(rec->length);
+		record.deleted = !!(GUINT32_FROM_LE(rec->flags)
+			& GALLERY_RECORD_DELETED);
+		record.offset = offset + sizeof(*rec);
+		if (length - record.offset < record.length) {
+			fp_dbg("dropping truncated record at %zu", offset);
+			break;
+		}
+
+		g_array_append_val(gallery->records, record);
+		/* the padding of the last record may be missing */
+		offset = record.offset + FP3_PADDED(record.length);
+	}
+
+	fp_dbg("%u records", gallery->records->len);
+	gallery->end = offset;
+	if (offset >= length)
+		return 0;
+
+	/* the mapping must not extend past the end of the file */
+	if (ftruncate(gallery->fd, offset) < 0)
+		return -errno;
+	return gallery_map(gallery);
+}
+
+/** \ingroup gallery
+ * Opens the gallery of a device type, creating it if it does not exist yet.
+ * \param driver_id the driver ID of the prints to be kept in the gallery,
+ * as returned by fp_print_data_get_driver_id()
+ * \param devtype the device type of the prints, as returned by
+ * fp_print_data_get_devtype()
+ * \returns the gallery, or NULL on error. Must be closed with
+ * fp_gallery_close() after use.
+ */
+API_EXPORTED struct fp_gallery *fp_gallery_open(uint16_t driver_id,
+	uint32_t devtype)
+{
+	struct fp_gallery *gallery;
+	struct fpi_gallery_header hdr;
+	struct stat st;
+	char *path;
+	char *dirpath;
+	int fd;
+
+	path = fpi_data_get_gallery_path(driver_id, devtype);
+	if (!path)
+		return NULL;
+
+	dirpath = g_path_get_dirname(path);
+	if (g_mkdir_with_parents(dirpath, DIR_PERMS) < 0) {
+		fp_err("couldn't create storage directory");
+		g_free(dirpath);
+		g_free(path);
+		return NULL;
+	}
+	g_free(dirpath);
+
+	fp_dbg("opening %s", path);
+	fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, FILE_PERMS);
+	g_free(path);
+	if (fd < 0) {
+		fp_err("open failed, errno %d", errno);
+		return NULL;
+	}
+
+	if (flock(fd, LOCK_EX | LOCK_NB) < 0) {
+		fp_err("gallery is in use by another process");
+		close(fd);
+		return NULL;
+	}
+
+	if (fstat(fd, &st) < 0)
+		goto err_fd;
+	if (st.st_size == 0) {
+		memset(&hdr, 0, sizeof(hdr));
+		memcpy(hdr.magic, GALLERY_MAGIC, sizeof(hdr.magic));
+		hdr.driver_id = GUINT16_TO_LE(driver_id);
+		hdr.devtype = GUINT32_TO_LE(devtype);
+		if (write_all(fd, &hdr, sizeof(hdr), 0) < 0)
+			goto err_fd;
+	}
+
+	gallery = g_malloc0(sizeof(*gallery));
+	gallery->driver_id = driver_id;
+	gallery->devtype = devtype;
+	gallery->fd = fd;
+	gallery->records = g_array_new(FALSE, FALSE,
+		sizeof(struct gallery_record));
+
+	if (gallery_map(gallery) < 0 || gallery_scan(gallery) < 0) {
+		fp_gallery_close(gallery);
+		return NULL;
+	}
+
+	return gallery;
+
+err_fd:
+	fp_err("couldn't initialise gallery, errno %d", errno);
+	close(fd);
+	return NULL;
+}
+
+/** \ingroup gallery
+ * Closes a gallery. Prints obtained from it with fp_gallery_get_print()
+ * remain valid.
+ * \param gallery the gallery to close. If NULL, function simply returns.
+ */
+API_EXPORTED void fp_gallery_close(struct fp_gallery *gallery)
+{
+	if (!gallery)
+		return;
+
+	if (gallery->mapped)
+		g_mapped_file_unref(gallery->mapped);
+	g_array_free(gallery->records, TRUE);
+	close(gallery->fd);
+	g_free(gallery);
+}
+
+/** \ingroup gallery
+ * Appends a print to a gallery. The print must come from the device type
+ * that the gallery was opened for.
+ * \param gallery the gallery
+ * \param data the print to store
+ * \returns the record ID of the stored print (the first print appended to
+ * a new gallery has ID 0, the next 1, and so on), or a negative error code
+ */
+API_EXPORTED int fp_gallery_append(struct fp_gallery *gallery,
+	struct fp_print_data *data)
+{
+	struct fpi_gallery_record *rec;
+	struct gallery_record record;
+	unsigned char *buf;
+	unsigned char *out;
+	size_t len, padded;
+	int r;
+
+	if (data->driver_id != gallery->driver_id
+			|| data->devtype != gallery->devtype) {
+		fp_err("print is from a different device type");
+		return -EINVAL;
+	}
+	if (gallery->records->len >= G_MAXINT)
+		return -ENOSPC;
+
+	len = fp_print_data_get_data(data, &buf);
+	if (!len)
+		return -ENOMEM;
+
+	padded = FP3_PADDED(len);
+	out = g_malloc0(sizeof(*rec) + padded);
+	rec = (struct fpi_gallery_record *) out;
+	rec->length = GUINT32_TO_LE(len);
+	memcpy(out + sizeof(*rec), buf, len);
+	free(buf);
+
+	r = write_all(gallery->fd, out, sizeof(*rec) + padded, gallery->end);
+	g_free(out);
+	if (r < 0) {
+		fp_err("append failed, error %d", r);
+		return r;
+	}
+
+	record.offset = gallery->end + sizeof(*rec);
+	record.length = len;
+	record.deleted = FALSE;
+	g_array_append_val(gallery->records, record);
+	gallery->end += sizeof(*rec) + padded;
+
+	return gallery->records->len - 1;
+}
+
+/** \ingroup gallery
+ * Deletes a print from a gallery. Its record ID is not reused.
+ * \param gallery the gallery
+ * \param id the record ID of the print
+ * \returns 0 on success, or a negative error code
+ */
+API_EXPORTED int fp_gallery_delete(struct fp_gallery *gallery, int id)
+{
+	struct gallery_record *record;
+	uint32_t flags = GUINT32_TO_LE(GALLERY_RECORD_DELETED);
+	int r;
+
+	if (id < 0 || (guint) id >= gallery->records->len)
+		return -EINVAL;
+
+	record = &g_array_index(gallery->records, struct gallery_record, id);
+	if (record->deleted)
+		return -ENOENT;
+
+	r = write_all(gallery->fd, &flags, sizeof(flags),
+		record->offset - sizeof(struct fpi_gallery_record)
+		+ G_STRUCT_OFFSET(struct fpi_gallery_record, flags));
+	if (r < 0)
+		return r;
+
+	record->deleted = TRUE;
+	return 0;
+}
+
+/** \ingroup gallery
+ * Gets the number of records in a gallery, including those of deleted
+ * prints. The valid record IDs are 0 up to one less than this number.
+ * \param gallery the gallery
+ * \returns the number of records
+ */
+API_EXPORTED int fp_gallery_get_nr_records(struct fp_gallery *gallery)
+{
+	return gallery->records->len;
+}
+
+/** \ingroup gallery
+ * Loads a print from a gallery.
+ * \param gallery the gallery
+ * \param id the record ID of the print
+ * \returns the print, or NULL if it was deleted or could not be loaded. Must
+ * be freed with fp_print_data_free() after use.
+ */
+API_EXPORTED struct fp_print_data *fp_gallery_get_print(
+	struct fp_gallery *gallery, int id)
+{
+	struct gallery_record *record;
+	unsigned char *contents;
+
+	if (id < 0 || (guint) id >= gallery->records->len)
+		return NULL;
+
+	record = &g_array_index(gallery->records, struct gallery_record, id);
+	if (record->deleted)
+		return NULL;
+
+	/* appended since the file was mapped */
+	if (record->offset + record->length
+			> g_mapped_file_get_length(gallery->mapped)
+			&& gallery_map(gallery) < 0)
+		return NULL;
+
+	contents = (unsigned char *) g_mapped_file_get_contents(gallery->mapped);
+	return fpi_print_data_from_data(contents + record->offset,
+		record->length, gallery->mapped);
+}
+
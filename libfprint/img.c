@@ -232,17 +232,16 @@ API_EXPORTED void fp_img_standardize(struct fp_img *img)
 	}
 }
 
-/* Based on write_minutiae_XYTQ and bz_load */
-static void minutiae_to_xyt(struct fp_minutiae *minutiae, int bwidth,
-	int bheight, unsigned char *buf)
+/* Based on write_minutiae_XYTQ and bz_load. Returns a sample holding only as
+ * many rows as there are minutiae. */
+static struct fp_print_data_item *minutiae_to_xyt(
+	struct fp_minutiae *minutiae, int bwidth, int bheight)
 {
 	int i;
 	struct fp_minutia *minutia;
 	struct minutiae_struct c[MAX_FILE_MINUTIAE];
-	struct xyt_struct *xyt = (struct xyt_struct *) buf;
-
-	/* FIXME: only considers first 150 minutiae (MAX_FILE_MINUTIAE) */
-	/* nist does weird stuff with 150 vs 1000 limits */
+	struct fp_print_data_item *item;
+	struct xyt_packed *xyt;
 	int nmin = min(minutiae->num, MAX_FILE_MINUTIAE);
 
 	for (i = 0; i < nmin; i++){
@@ -256,26 +255,162 @@ static void minutiae_to_xyt(struct fp_minutiae *minutiae, int bwidth,
 			c[i].col[2] -= 360;
 	}
 
+	/* like bz_load, keep the minutiae with the highest reliability that
+	 * Bozorth3 can use, then store them in x, y order. The ranking is only
+	 * as good as the reliability: fpi_img_to_print_data() has it assigned
+	 * from the quality map whenever there are more minutiae than that. */
+	if (nmin > MAX_BOZORTH_MINUTIAE) {
+		qsort((void *) &c, (size_t) nmin, sizeof(struct minutiae_struct),
+				sort_quality_decreasing);
+		nmin = MAX_BOZORTH_MINUTIAE;
+	}
 	qsort((void *) &c, (size_t) nmin, sizeof(struct minutiae_struct),
 			sort_x_y);
 
+	item = fpi_print_data_item_new(XYT_PACKED_SIZE(nmin));
+	xyt = (struct xyt_packed *) item->data;
+	xyt->nrows = nmin;
 	for (i = 0; i < nmin; i++) {
-		xyt->xcol[i]     = c[i].col[0];
-		xyt->ycol[i]     = c[i].col[1];
-		xyt->thetacol[i] = c[i].col[2];
+		XYT_PACKED_X(xyt)[i] = c[i].col[0];
+		XYT_PACKED_Y(xyt)[i] = c[i].col[1];
+		XYT_PACKED_T(xyt)[i] = c[i].col[2];
 	}
-	xyt->nrows = nmin;
+	return item;
+}
+
+/* Images with fewer blocks than this have their maps generated on the calling
+ * thread. */
+#define MAPS_MIN_PARALLEL_BLOCKS 256
+/* number of blocks a worker takes at a time */
+#define MAPS_CHUNK_BLOCKS 32
+
+static GThreadPool *maps_pool = NULL;
+/* images of several devices are processed on the threads of the context
+ * work pools at once, so the shared pools are created under this lock */
+static GMutex pools_lock;
+
+/* A block map computation shared between the workers of the pool. Block
+ * ranges are handed out in increasing order until all blocks are taken or
+ * a range fails; error keeps the first failure. */
+struct maps_job {
+	LFS_BLOCKS_FUNC func;
+	void *arg;
+	gint nr_blocks;
+	gint next_block;
+	gint error;
+
+	GMutex lock;
+	GCond done_cond;
+	int workers_pending;
+};
+
+static void maps_worker(gpointer data, gpointer user_data)
+{
+	struct maps_job *job = data;
+	gint first;
+	int r;
+
+	while ((first = g_atomic_int_add(&job->next_block, MAPS_CHUNK_BLOCKS))
+			< job->nr_blocks) {
+		if (g_atomic_int_get(&job->error))
+			break;
+		r = job->func(job->arg, first,
+			MIN(first + MAPS_CHUNK_BLOCKS, job->nr_blocks));
+		if (r) {
+			g_atomic_int_compare_and_exchange(&job->error, 0, r);
+			break;
+		}
+	}
+
+	g_mutex_lock(&job->lock);
+	if (--job->workers_pending == 0)
+		g_cond_signal(&job->done_cond);
+	g_mutex_unlock(&job->lock);
+}
+
+/* returns the worker pool if the image is worth mapping in parallel */
+static GThreadPool *get_maps_pool(int nr_blocks)
+{
+	GError *err = NULL;
+
+	if (nr_blocks < MAPS_MIN_PARALLEL_BLOCKS)
+		return NULL;
+
+	g_mutex_lock(&pools_lock);
+	if (!maps_pool) {
+		maps_pool = g_thread_pool_new(maps_worker, NULL,
+			g_get_num_processors(), TRUE, &err);
+		if (!maps_pool) {
+			g_mutex_unlock(&pools_lock);
+			fp_err("could not create maps worker pool: %s", err->message);
+			g_error_free(err);
+			return NULL;
+		}
+	}
+	g_mutex_unlock(&pools_lock);
+
+	if (g_thread_pool_get_max_threads(maps_pool) < 2)
+		return NULL;
+	return maps_pool;
 }
 
-int fpi_img_detect_minutiae(struct fp_img *img)
+/* LFS_PARALLEL_FUNC spreading the blocks of an image map over the worker
+ * pool. Every block writes its own map entries only, so the maps are the
+ * same as when generated serially. */
+static int maps_parallel(void *data, LFS_BLOCKS_FUNC func, void *arg,
+	const int nr_blocks)
 {
+	GThreadPool *pool = get_maps_pool(nr_blocks);
+	struct maps_job job;
+	int nr_workers, i;
+
+	if (!pool)
+		return func(arg, 0, nr_blocks);
+
+	nr_workers = g_thread_pool_get_max_threads(pool);
+	job.func = func;
+	job.arg = arg;
+	job.nr_blocks = nr_blocks;
+	job.next_block = 0;
+	job.error = 0;
+	job.workers_pending = nr_workers;
+	g_mutex_init(&job.lock);
+	g_cond_init(&job.done_cond);
+
+	for (i = 0; i < nr_workers; i++)
+		g_thread_pool_push(pool, &job, NULL);
+
+	g_mutex_lock(&job.lock);
+	while (job.workers_pending)
+		g_cond_wait(&job.done_cond, &job.lock);
+	g_mutex_unlock(&job.lock);
+
+	g_mutex_clear(&job.lock);
+	g_cond_clear(&job.done_cond);
+	return job.error;
+}
+
+/* The lookup tables used by minutiae detection only depend on the image size,
+ * so a device keeps them in *lfsctx for its next image, along with an arena
+ * that the detection allocates its working memory from. They are rebuilt
+ * if the size changes. With a NULL lfsctx they are built for this image
+ * alone.
+ *
+ * outputs holds the LFS_OUT_BINARIZED and LFS_OUT_RELIABILITY flags of what
+ * is needed besides the minutiae; the image quality maps are never kept.
+ * Without LFS_OUT_RELIABILITY the quality map is not built, and the minutiae
+ * keep their detection reliability: FP_IMG_PARTIAL_MINUTIAE marks them so
+ * that they get detected again if the full set is asked for later.
+ * LFS_OUT_RELIABILITY_IF_OVER builds it in the same pass only if there are
+ * more minutiae than a sample can hold. */
+int fpi_img_detect_minutiae(struct fp_img *img, struct lfsctx **lfsctx,
+	int outputs)
+{
+	LFSCTX *tmp_lfsctx = NULL;
+	LFSCTX *ctx;
 	struct fp_minutiae *minutiae;
 	int r;
-	int *direction_map, *low_contrast_map, *low_flow_map;
-	int *high_curve_map, *quality_map;
-	int map_w, map_h;
 	unsigned char *bdata;
-	int bw, bh, bd;
 	GTimer *timer;
 
 	if (img->flags & FP_IMG_STANDARDIZATION_FLAGS) {
@@ -283,14 +418,39 @@ int fpi_img_detect_minutiae(struct fp_img *img)
 		return -EINVAL;
 	}
 
+	if (!lfsctx)
+		lfsctx = &tmp_lfsctx;
+	ctx = *lfsctx;
+	if (ctx && !lfsctx_matches(ctx, img->width, img->height,
+			&g_lfsparms_V2)) {
+		fpi_img_free_lfsctx(ctx);
+		ctx = *lfsctx = NULL;
+	}
+	if (!ctx) {
+		r = init_lfsctx(&ctx, img->width, img->height, &g_lfsparms_V2);
+		if (r) {
+			fp_err("lfs context setup failed, code %d", r);
+			return r;
+		}
+		ctx->parallel = maps_parallel;
+		/* a device keeps its working memory arena between images too */
+		if (lfsctx != &tmp_lfsctx)
+			init_lfsarena(&ctx->arena, LFS_ARENA_BLKSIZE);
+		*lfsctx = ctx;
+	}
+
 	/* 25.4 mm per inch */
 	timer = g_timer_new();
-	r = get_minutiae(&minutiae, &quality_map, &direction_map,
-                         &low_contrast_map, &low_flow_map, &high_curve_map,
-                         &map_w, &map_h, &bdata, &bw, &bh, &bd,
-                         img->data, img->width, img->height, 8,
-						 DEFAULT_PPI / (double)25.4, &g_lfsparms_V2);
+	outputs &= LFS_OUT_BINARIZED | LFS_OUT_RELIABILITY
+		| LFS_OUT_RELIABILITY_IF_OVER;
+	ctx->reliability_cap = MAX_BOZORTH_MINUTIAE;
+	r = get_minutiae_flags(&minutiae, NULL, NULL, NULL, NULL, NULL,
+		NULL, NULL, &bdata, NULL, NULL, NULL,
+		img->data, img->width, img->height, 8,
+		DEFAULT_PPI / (double)25.4, &g_lfsparms_V2, ctx, outputs);
 	g_timer_stop(timer);
+	if (tmp_lfsctx)
+		free_lfsctx(tmp_lfsctx);
 	fp_dbg("minutiae scan completed in %f secs", g_timer_elapsed(timer, NULL));
 	g_timer_destroy(timer);
 	if (r) {
@@ -298,17 +458,31 @@ int fpi_img_detect_minutiae(struct fp_img *img)
 		return r;
 	}
 	fp_dbg("detected %d minutiae", minutiae->num);
+	if (img->minutiae)
+		free_minutiae(img->minutiae);
 	img->minutiae = minutiae;
-	img->binarized = bdata;
-
-	free(quality_map);
-	free(direction_map);
-	free(low_contrast_map);
-	free(low_flow_map);
-	free(high_curve_map);
+	if ((outputs & LFS_OUT_RELIABILITY)
+			|| ((outputs & LFS_OUT_RELIABILITY_IF_OVER)
+				&& minutiae->num > MAX_BOZORTH_MINUTIAE))
+		img->flags &= ~FP_IMG_PARTIAL_MINUTIAE;
+	else
+		img->flags |= FP_IMG_PARTIAL_MINUTIAE;
+	if (bdata) {
+		free(img->binarized);
+		img->binarized = bdata;
+	}
 	return minutiae->num;
 }
 
+void fpi_img_free_lfsctx(struct lfsctx *lfsctx)
+{
+	if (!lfsctx)
+		return;
+	if (lfsctx->arena)
+		free_lfsarena(lfsctx->arena);
+	free_lfsctx(lfsctx);
+}
+
 int fpi_img_to_print_data(struct fp_img_dev *imgdev, struct fp_img *img,
 	struct fp_print_data **ret)
 {
@@ -316,8 +490,13 @@ int fpi_img_to_print_data(struct fp_img_dev *imgdev, struct fp_img *img,
 	struct fp_print_data_item *item;
 	int r;
 
+	/* prints hold the minutiae positions and directions, and the
+	 * reliability is only needed to pick the minutiae a sample keeps when
+	 * there are more than it can hold, so the quality map is only built
+	 * when that happens. */
 	if (!img->minutiae) {
-		r = fpi_img_detect_minutiae(img);
+		r = fpi_img_detect_minutiae(img, &imgdev->lfsctx,
+			LFS_OUT_RELIABILITY_IF_OVER);
 		if (r < 0)
 			return r;
 		if (!img->minutiae) {
@@ -326,51 +505,159 @@ int fpi_img_to_print_data(struct fp_img_dev *imgdev, struct fp_img *img,
 		}
 	}
 
-	/* FIXME: space is wasted if we dont hit the max minutiae count. would
-	 * be good to make this dynamic. */
 	print = fpi_print_data_new(imgdev->dev);
-	item = fpi_print_data_item_new(sizeof(struct xyt_struct));
+	item = minutiae_to_xyt(img->minutiae, img->width, img->height);
 	print->type = PRINT_DATA_NBIS_MINUTIAE;
-	minutiae_to_xyt(img->minutiae, img->width, img->height, item->data);
 	print->prints = g_slist_prepend(print->prints, item);
-
-	/* FIXME: the print buffer at this point is endian-specific, and will
-	 * only work when loaded onto machines with identical endianness. not good!
-	 * data format should be platform-independent. */
 	*ret = print;
 
 	return 0;
 }
 
-int fpi_img_compare_print_data(struct fp_print_data *enrolled_print,
-	struct fp_print_data *new_print)
+/* returns TRUE if buf holds a minutiae sample as built by minutiae_to_xyt(),
+ * in host byte order */
+gboolean fpi_img_xyt_is_valid(const unsigned char *buf, size_t len)
 {
-	int score, max_score = 0, probe_len;
-	struct xyt_struct *pstruct = NULL;
-	struct xyt_struct *gstruct = NULL;
-	struct fp_print_data_item *data_item;
-	GSList *list_item;
+	short nrows;
 
-	if (enrolled_print->type != PRINT_DATA_NBIS_MINUTIAE ||
-	     new_print->type != PRINT_DATA_NBIS_MINUTIAE) {
-		fp_err("invalid print format");
-		return -EINVAL;
+	if (len < XYT_PACKED_SIZE(0))
+		return FALSE;
+	memcpy(&nrows, buf, sizeof(nrows));
+	return nrows >= 0 && nrows <= MAX_BOZORTH_MINUTIAE
+		&& len == XYT_PACKED_SIZE(nrows);
+}
+
+/* Builds a minutiae sample from stored data. Samples saved before templates
+ * were sized to their minutiae count hold a whole struct xyt_struct, which is
+ * at least twice the size of the largest packed sample, and are converted.
+ * Returns NULL if the data is not a valid sample. */
+struct fp_print_data_item *fpi_img_print_data_item_from_data(
+	const unsigned char *buf, size_t len)
+{
+	struct fp_print_data_item *item;
+	struct xyt_struct legacy;
+
+	if (len == sizeof(legacy)) {
+		memcpy(&legacy, buf, sizeof(legacy));
+		if (legacy.nrows < 0 || legacy.nrows > MAX_BOZORTH_MINUTIAE)
+			return NULL;
+		item = fpi_print_data_item_new(XYT_PACKED_SIZE(legacy.nrows));
+		xyt_to_packed(&legacy, (struct xyt_packed *) item->data);
+		return item;
 	}
 
-	if (g_slist_length(new_print->prints) != 1) {
-		fp_err("new_print contains more than one sample, is it enrolled print?");
-		return -EINVAL;
+	if (!fpi_img_xyt_is_valid(buf, len))
+		return NULL;
+
+	item = fpi_print_data_item_new(len);
+	memcpy(item->data, buf, len);
+	return item;
+}
+
+/* Each thread that runs Bozorth gets its own match context, allocated on
+ * first use and released when the thread exits. */
+static GPrivate bz_ctx_key = G_PRIVATE_INIT((GDestroyNotify) bz_ctx_free);
+
+struct bz_ctx *fpi_img_get_bz_ctx(void)
+{
+	struct bz_ctx *ctx = g_private_get(&bz_ctx_key);
+
+	if (!ctx) {
+		ctx = bz_ctx_new();
+		g_private_set(&bz_ctx_key, ctx);
 	}
+	return ctx;
+}
+
+void fpi_img_free_gallery_tmpl(struct bz_gallery_tmpl *tmpl)
+{
+	bz_gallery_tmpl_free(tmpl);
+}
+
+/* Returns the compiled Bozorth template of an enrolled sample, building it on
+ * first use, or NULL if it could not be allocated. The template stays with
+ * the item, so this is only worth it for items that are matched again and
+ * again: those of a gallery being identified against or of a print index. */
+struct bz_gallery_tmpl *fpi_img_get_gallery_tmpl(struct bz_ctx *ctx,
+	struct fp_print_data_item *item)
+{
+	struct bz_gallery_tmpl *tmpl = g_atomic_pointer_get(&item->bz_tmpl);
+
+	if (tmpl)
+		return tmpl;
+
+	tmpl = bz_gallery_tmpl_new(ctx, (struct xyt_packed *)item->data);
+	if (!tmpl)
+		return NULL;
+
+	/* the same print may appear twice in a gallery being searched by
+	 * several workers; keep whichever template was stored first */
+	if (!g_atomic_pointer_compare_and_exchange(&item->bz_tmpl, NULL, tmpl)) {
+		bz_gallery_tmpl_free(tmpl);
+		tmpl = g_atomic_pointer_get(&item->bz_tmpl);
+	}
+	return tmpl;
+}
+
+/* Returns the edge signature of an enrolled sample for the prefilters,
+ * building it on first use, or NULL if it could not be allocated. Templates
+ * only carry a signature once a prefilter has asked for it. */
+const unsigned char *fpi_img_get_gallery_sig(struct bz_ctx *ctx,
+	struct fp_print_data_item *item)
+{
+	struct bz_gallery_tmpl *tmpl = fpi_img_get_gallery_tmpl(ctx, item);
+	unsigned char *sig;
+
+	if (!tmpl)
+		return NULL;
+	sig = g_atomic_pointer_get(&tmpl->sig);
+	if (sig)
+		return sig;
+
+	sig = bz_sig_new(tmpl);
+	if (!sig)
+		return NULL;
+	if (!g_atomic_pointer_compare_and_exchange(&tmpl->sig, NULL, sig)) {
+		free(sig);
+		sig = g_atomic_pointer_get(&tmpl->sig);
+	}
+	return sig;
+}
+
+/* Match the probe against one enrolled sample. With cache set, the sample's
+ * edge table is compiled on first use and kept with the item, so later
+ * comparisons only have to run the matching and scoring stages. Otherwise a
+ * table kept earlier is used, but none is built. */
+static int compare_to_gallery_item(struct bz_ctx *ctx, int probe_len,
+	struct xyt_packed *pstruct, struct fp_print_data_item *item,
+	gboolean cache)
+{
+	struct xyt_packed *gstruct = (struct xyt_packed *)item->data;
+	struct bz_gallery_tmpl *tmpl;
+
+	if (cache)
+		tmpl = fpi_img_get_gallery_tmpl(ctx, item);
+	else
+		tmpl = g_atomic_pointer_get(&item->bz_tmpl);
+
+	if (!tmpl)
+		return bozorth_to_gallery_ctx(ctx, probe_len, pstruct, gstruct);
+
+	return bozorth_to_gallery_tmpl_ctx(ctx, probe_len, pstruct, gstruct, tmpl);
+}
 
-	data_item = new_print->prints->data;
-	pstruct = (struct xyt_struct *)data_item->data;
+/* returns the best score of the probe against any sample of the print */
+static int gallery_print_score(struct bz_ctx *ctx, int probe_len,
+	struct xyt_packed *pstruct, struct fp_print_data *gallery_print)
+{
+	struct fp_print_data_item *data_item;
+	GSList *list_item = gallery_print->prints;
+	int score, max_score = 0;
 
-	probe_len = bozorth_probe_init(pstruct);
-	list_item = enrolled_print->prints;
 	do {
 		data_item = list_item->data;
-		gstruct = (struct xyt_struct *)data_item->data;
-		score = bozorth_to_gallery(probe_len, pstruct, gstruct);
+		score = compare_to_gallery_item(ctx, probe_len, pstruct, data_item,
+			FALSE);
 		fp_dbg("score %d", score);
 		max_score = max(score, max_score);
 		list_item = g_slist_next(list_item);
@@ -379,43 +666,464 @@ int fpi_img_compare_print_data(struct fp_print_data *enrolled_print,
 	return max_score;
 }
 
-int fpi_img_compare_print_data_to_gallery(struct fp_print_data *print,
-	struct fp_print_data **gallery, int match_threshold, size_t *match_offset)
+/* Identification prefilter: the share, in percent, of the probe's edges that
+ * must have a compatible edge in an enrolled sample before Bozorth is run on
+ * that sample. 0 disables the prefilter. The share is a setting of the
+ * context, see fp_set_identify_prefilter(). */
+static int prefilter_min_hits(int percent, int probe_len)
+{
+	/* bz_match() looks at the first probe_len - 1 probe edges */
+	if (probe_len < 2)
+		return 0;
+	return percent * (probe_len - 1) / 100;
+}
+
+/* returns TRUE if any sample of the gallery print reaches the threshold.
+ * Samples that cannot reach min_hits in the prefilter are skipped, and
+ * pruned is incremented if all of them were. */
+static gboolean gallery_print_matches(struct bz_ctx *ctx, int probe_len,
+	struct xyt_packed *pstruct, struct fp_print_data *gallery_print,
+	int match_threshold, int min_hits, gint *pruned)
+{
+	struct fp_print_data_item *data_item;
+	const unsigned char *sig;
+	GSList *list_item = gallery_print->prints;
+	gboolean all_pruned = TRUE;
+
+	do {
+		data_item = list_item->data;
+		list_item = g_slist_next(list_item);
+
+		if (min_hits > 0) {
+			sig = fpi_img_get_gallery_sig(ctx, data_item);
+			if (sig && bz_sig_hits(ctx, probe_len, sig) < min_hits)
+				continue;
+		}
+
+		all_pruned = FALSE;
+		if (compare_to_gallery_item(ctx, probe_len, pstruct, data_item,
+				TRUE) >= match_threshold)
+			return TRUE;
+	} while (list_item);
+
+	if (all_pruned)
+		g_atomic_int_inc(pruned);
+	return FALSE;
+}
+
+static struct xyt_packed *get_probe_xyt(struct fp_print_data *print)
 {
-	struct xyt_struct *pstruct;
-	struct xyt_struct *gstruct;
-	struct fp_print_data *gallery_print;
 	struct fp_print_data_item *data_item;
-	int probe_len;
-	size_t i = 0;
-	int r;
-	GSList *list_item;
 
 	if (g_slist_length(print->prints) != 1) {
 		fp_err("new_print contains more than one sample, is it enrolled print?");
-		return -EINVAL;
+		return NULL;
 	}
 
 	data_item = print->prints->data;
-	pstruct = (struct xyt_struct *)data_item->data;
+	return (struct xyt_packed *)data_item->data;
+}
 
-	probe_len = bozorth_probe_init(pstruct);
-	while ((gallery_print = gallery[i++])) {
-		list_item = gallery_print->prints;
+int fpi_img_compare_print_data(struct fp_print_data *enrolled_print,
+	struct fp_print_data *new_print)
+{
+	struct bz_ctx *ctx;
+	struct xyt_packed *pstruct;
+
+	if (enrolled_print->type != PRINT_DATA_NBIS_MINUTIAE ||
+	     new_print->type != PRINT_DATA_NBIS_MINUTIAE) {
+		fp_err("invalid print format");
+		return -EINVAL;
+	}
+
+	pstruct = get_probe_xyt(new_print);
+	if (!pstruct)
+		return -EINVAL;
+
+	ctx = fpi_img_get_bz_ctx();
+	if (!ctx)
+		return -ENOMEM;
+
+	return gallery_print_score(ctx, bozorth_probe_init_ctx(ctx, pstruct),
+		pstruct, enrolled_print);
+}
+
+/* Scores the new print against each sample of the enrolled print, in the
+ * order of its list of samples. Returns 0, or a negative error code. */
+int fpi_img_score_samples(struct fp_print_data *enrolled_print,
+	struct fp_print_data *new_print, int *scores)
+{
+	struct bz_ctx *ctx;
+	struct xyt_packed *pstruct;
+	GSList *list_item;
+	int probe_len, i = 0;
+
+	if (enrolled_print->type != PRINT_DATA_NBIS_MINUTIAE ||
+	     new_print->type != PRINT_DATA_NBIS_MINUTIAE) {
+		fp_err("invalid print format");
+		return -EINVAL;
+	}
+
+	pstruct = get_probe_xyt(new_print);
+	if (!pstruct)
+		return -EINVAL;
+
+	ctx = fpi_img_get_bz_ctx();
+	if (!ctx)
+		return -ENOMEM;
+
+	probe_len = bozorth_probe_init_ctx(ctx, pstruct);
+	for (list_item = enrolled_print->prints; list_item;
+			list_item = g_slist_next(list_item))
+		scores[i++] = compare_to_gallery_item(ctx, probe_len, pstruct,
+			list_item->data, FALSE);
+
+	return 0;
+}
+
+/* Galleries with fewer prints than this are searched on the calling thread;
+ * handing them to the worker pool costs more than it saves. */
+#define MATCH_MIN_PARALLEL_PRINTS 32
+
+static GThreadPool *match_pool = NULL;
+
+/* A single gallery search shared between the workers of the pool. Gallery
+ * indices are handed out in increasing order.
+ *
+ * When scores is set, every print is scored, and its score is stored unless
+ * the array already holds a higher one. Otherwise this is an
+ * identification, and a worker stops as soon as the next index is past the
+ * lowest match found so far. Every index below that match has therefore been
+ * examined, so the result is the same offset that a serial walk of the
+ * gallery would report. */
+struct match_job {
+	struct fp_print_data **gallery;
+	struct xyt_packed *pstruct;
+	int match_threshold;
+	int prefilter_percent;
+	int *scores;
+	gint gallery_len;
+	gint pruned;
+
+	gint next_offset;
+	gint match_offset;
+
+	GMutex lock;
+	GCond done_cond;
+	int workers_pending;
+};
+
+static void match_worker(gpointer data, gpointer user_data)
+{
+	struct match_job *job = data;
+	struct bz_ctx *ctx = fpi_img_get_bz_ctx();
+	int probe_len, min_hits, score;
+	gint i, cur;
+
+	if (!ctx)
+		goto out;
+
+	probe_len = bozorth_probe_init_ctx(ctx, job->pstruct);
+	min_hits = prefilter_min_hits(job->prefilter_percent, probe_len);
+
+	if (job->scores) {
+		while ((i = g_atomic_int_add(&job->next_offset, 1)) < job->gallery_len) {
+			score = gallery_print_score(ctx, probe_len, job->pstruct,
+				job->gallery[i]);
+			job->scores[i] = max(score, job->scores[i]);
+		}
+		goto out;
+	}
+
+	while ((i = g_atomic_int_add(&job->next_offset, 1)) < job->gallery_len) {
+		if (i > g_atomic_int_get(&job->match_offset))
+			break;
+		if (!gallery_print_matches(ctx, probe_len, job->pstruct,
+				job->gallery[i], job->match_threshold, min_hits,
+				&job->pruned))
+			continue;
+
+		/* lower the shared match offset unless another worker already
+		 * matched an earlier print */
 		do {
-			data_item = list_item->data;
-			gstruct = (struct xyt_struct *)data_item->data;
-			r = bozorth_to_gallery(probe_len, pstruct, gstruct);
-			if (r >= match_threshold) {
-				*match_offset = i - 1;
-				return FP_VERIFY_MATCH;
-			}
-			list_item = g_slist_next(list_item);
-		} while (list_item);
+			cur = g_atomic_int_get(&job->match_offset);
+			if (i >= cur)
+				break;
+		} while (!g_atomic_int_compare_and_exchange(&job->match_offset,
+				cur, i));
+		break;
+	}
+
+out:
+	g_mutex_lock(&job->lock);
+	if (--job->workers_pending == 0)
+		g_cond_signal(&job->done_cond);
+	g_mutex_unlock(&job->lock);
+}
+
+/* returns the worker pool if the gallery is worth searching in parallel */
+static GThreadPool *get_match_pool(gint gallery_len)
+{
+	GError *err = NULL;
+
+	if (gallery_len < MATCH_MIN_PARALLEL_PRINTS)
+		return NULL;
+
+	g_mutex_lock(&pools_lock);
+	if (!match_pool) {
+		match_pool = g_thread_pool_new(match_worker, NULL,
+			g_get_num_processors(), TRUE, &err);
+		if (!match_pool) {
+			g_mutex_unlock(&pools_lock);
+			fp_err("could not create match worker pool: %s", err->message);
+			g_error_free(err);
+			return NULL;
+		}
+	}
+	g_mutex_unlock(&pools_lock);
+
+	if (g_thread_pool_get_max_threads(match_pool) < 2)
+		return NULL;
+	return match_pool;
+}
+
+/* runs the job on every worker of the pool and waits for all of them */
+static void match_parallel(GThreadPool *pool, struct match_job *job)
+{
+	int nr_workers = g_thread_pool_get_max_threads(pool);
+	int i;
+
+	job->next_offset = 0;
+	job->match_offset = G_MAXINT;
+	job->workers_pending = nr_workers;
+	g_mutex_init(&job->lock);
+	g_cond_init(&job->done_cond);
+
+	for (i = 0; i < nr_workers; i++)
+		g_thread_pool_push(pool, job, NULL);
+
+	g_mutex_lock(&job->lock);
+	while (job->workers_pending)
+		g_cond_wait(&job->done_cond, &job->lock);
+	g_mutex_unlock(&job->lock);
+
+	g_mutex_clear(&job->lock);
+	g_cond_clear(&job->done_cond);
+}
+
+static void prefilter_account(struct fp_context *fpctx, gint pruned,
+	gint gallery_len)
+{
+	if (!pruned)
+		return;
+	fp_dbg("prefilter pruned %d of %d gallery prints", pruned, gallery_len);
+	g_atomic_int_add(&fpctx->prefilter_pruned_total, pruned);
+}
+
+/* identifies the print in the gallery, with the prefilter settings of the
+ * context of the device */
+int fpi_img_compare_print_data_to_gallery(struct fp_context *fpctx,
+	struct fp_print_data *print, struct fp_print_data **gallery,
+	int match_threshold, size_t *match_offset)
+{
+	struct xyt_packed *pstruct;
+	struct bz_ctx *ctx;
+	GThreadPool *pool;
+	int percent = g_atomic_int_get(&fpctx->prefilter_percent);
+	int probe_len, min_hits;
+	gint gallery_len = 0;
+	gint pruned = 0;
+	gint i;
+
+	pstruct = get_probe_xyt(print);
+	if (!pstruct)
+		return -EINVAL;
+
+	while (gallery[gallery_len])
+		gallery_len++;
+
+	pool = get_match_pool(gallery_len);
+	if (pool) {
+		struct match_job job;
+
+		job.gallery = gallery;
+		job.pstruct = pstruct;
+		job.match_threshold = match_threshold;
+		job.prefilter_percent = percent;
+		job.scores = NULL;
+		job.gallery_len = gallery_len;
+		job.pruned = 0;
+		match_parallel(pool, &job);
+		prefilter_account(fpctx, job.pruned, gallery_len);
+
+		if (job.match_offset == G_MAXINT) {
+			/* offsets that were never handed out mean that no
+			 * worker could allocate its match context */
+			if (job.next_offset < gallery_len)
+				return -ENOMEM;
+			return FP_VERIFY_NO_MATCH;
+		}
+		*match_offset = job.match_offset;
+		return FP_VERIFY_MATCH;
 	}
+
+	ctx = fpi_img_get_bz_ctx();
+	if (!ctx)
+		return -ENOMEM;
+
+	probe_len = bozorth_probe_init_ctx(ctx, pstruct);
+	min_hits = prefilter_min_hits(percent, probe_len);
+	for (i = 0; i < gallery_len; i++) {
+		if (gallery_print_matches(ctx, probe_len, pstruct, gallery[i],
+				match_threshold, min_hits, &pruned)) {
+			prefilter_account(fpctx, pruned, gallery_len);
+			*match_offset = i;
+			return FP_VERIFY_MATCH;
+		}
+	}
+	prefilter_account(fpctx, pruned, gallery_len);
 	return FP_VERIFY_NO_MATCH;
 }
 
+/** \ingroup dev
+ * Enables a quick first pass over the gallery during identification, which
+ * discards enrolled prints that are clearly different from the scanned print
+ * before the full matching algorithm is run on them. This makes searching
+ * large galleries cheaper, at the risk of missing some genuine matches.
+ *
+ * For each enrolled sample, the first pass counts the pairs of minutiae in
+ * the scanned print that have a compatible pair in the sample. The sample
+ * is skipped if that count is below the given share of all pairs looked at.
+ * Samples of the same finger reach a much higher share than samples of other
+ * fingers, but how much higher depends on the device and on image quality.
+ * Lower values keep more genuine matches, higher values prune more prints;
+ * the trade-off should be measured on your own data, using
+ * fp_get_identify_pruned_count() to see how much is being pruned.
+ *
+ * The setting belongs to the context of the calling thread, and applies to
+ * identifications on the devices opened in it.
+ *
+ * This only affects identification with imaging devices. It has no effect
+ * on verification or on fp_img_compare_batch().
+ *
+ * \param min_percent the share of pairs, in percent, that an enrolled sample
+ * must match to be considered. 0 (the default) disables the first pass, so
+ * that every print in the gallery is fully compared.
+ */
+API_EXPORTED void fp_set_identify_prefilter(unsigned int min_percent)
+{
+	if (min_percent > 100)
+		min_percent = 100;
+	g_atomic_int_set(&fpi_get_context()->prefilter_percent, min_percent);
+}
+
+/** \ingroup dev
+ * Gets the number of gallery prints that were discarded by the first pass
+ * enabled with fp_set_identify_prefilter(), over all identifications in the
+ * context of the calling thread since it was created.
+ * \returns the number of pruned gallery prints
+ */
+API_EXPORTED unsigned int fp_get_identify_pruned_count(void)
+{
+	return g_atomic_int_get(&fpi_get_context()->prefilter_pruned_total);
+}
+
+/** \ingroup img
+ * Compares a print against a list of candidate prints in a single call, for
+ * example to look for duplicates in a set of enrolled prints. No device needs
+ * to be open: the comparison only works on the print data.
+ *
+ * Each sample of the print is prepared for matching once, and the candidates
+ * are then scored one after the other, spread over several threads for large
+ * lists. For each candidate, the best score between any sample of the print
+ * and any of the candidate's samples is reported. Higher scores indicate a
+ * better match; the scores are those that libfprint compares against a
+ * driver's match threshold when verifying or identifying prints.
+ *
+ * Only prints produced by imaging devices can be compared this way, and
+ * scores are only meaningful between prints from the same type of device.
+ *
+ * \param print the print to compare, such as an enrolled print
+ * \param candidates a NULL-terminated array of prints to compare against
+ * \param scores output array with room for one score per candidate, in the
+ * order of the candidates array
+ * \returns 0 on success, or a negative error code on failure. In that case,
+ * the contents of scores are undefined.
+ */
+API_EXPORTED int fp_img_compare_batch(struct fp_print_data *print,
+	struct fp_print_data **candidates, int *scores)
+{
+	struct fp_print_data_item *data_item;
+	struct xyt_packed *pstruct;
+	struct bz_ctx *ctx;
+	GThreadPool *pool;
+	GSList *list_item;
+	int probe_len, score;
+	gint nr_candidates;
+	gint i;
+
+	if (print->type != PRINT_DATA_NBIS_MINUTIAE) {
+		fp_err("invalid print format");
+		return -EINVAL;
+	}
+
+	for (nr_candidates = 0; candidates[nr_candidates]; nr_candidates++) {
+		if (candidates[nr_candidates]->type != PRINT_DATA_NBIS_MINUTIAE) {
+			fp_err("invalid format for candidate %d", nr_candidates);
+			return -EINVAL;
+		}
+		scores[nr_candidates] = 0;
+	}
+
+	pool = get_match_pool(nr_candidates);
+	ctx = fpi_img_get_bz_ctx();
+	if (!pool && !ctx)
+		return -ENOMEM;
+
+	for (list_item = print->prints; list_item;
+			list_item = g_slist_next(list_item)) {
+		data_item = list_item->data;
+		pstruct = (struct xyt_packed *)data_item->data;
+
+		if (pool) {
+			struct match_job job;
+
+			job.gallery = candidates;
+			job.pstruct = pstruct;
+			job.match_threshold = 0;
+			job.prefilter_percent = 0;
+			job.scores = scores;
+			job.gallery_len = nr_candidates;
+			job.pruned = 0;
+			match_parallel(pool, &job);
+			if (job.next_offset < nr_candidates)
+				return -ENOMEM;
+			continue;
+		}
+
+		probe_len = bozorth_probe_init_ctx(ctx, pstruct);
+		for (i = 0; i < nr_candidates; i++) {
+			score = gallery_print_score(ctx, probe_len, pstruct,
+				candidates[i]);
+			scores[i] = max(score, scores[i]);
+		}
+	}
+
+	return 0;
+}
+
+void fpi_img_exit(void)
+{
+	if (match_pool) {
+		g_thread_pool_free(match_pool, FALSE, TRUE);
+		match_pool = NULL;
+	}
+	if (maps_pool) {
+		g_thread_pool_free(maps_pool, FALSE, TRUE);
+		maps_pool = NULL;
+	}
+}
+
 /** \ingroup img
  * Get a binarized form of a standardized scanned image. This is where the
  * fingerprint image has been "enhanced" and is a set of pure black ridges
@@ -447,7 +1155,8 @@ API_EXPORTED struct fp_img *fp_img_binarize(struct fp_img *img)
 	}
 
 	if (!img->binarized) {
-		int r = fpi_img_detect_minutiae(img);
+		int r = fpi_img_detect_minutiae(img, NULL,
+			LFS_OUT_BINARIZED | LFS_OUT_RELIABILITY);
 		if (r < 0)
 			return NULL;
 		if (!img->binarized) {
@@ -494,8 +1203,9 @@ API_EXPORTED struct fp_minutia **fp_img_get_minutiae(struct fp_img *img,
 		return NULL;
 	}
 
-	if (!img->minutiae) {
-		int r = fpi_img_detect_minutiae(img);
+	if (!img->minutiae || (img->flags & FP_IMG_PARTIAL_MINUTIAE)) {
+		int r = fpi_img_detect_minutiae(img, NULL,
+			LFS_OUT_BINARIZED | LFS_OUT_RELIABILITY);
 		if (r < 0)
 			return NULL;
 		if (!img->minutiae) {
@@ -26,6 +26,37 @@
 #define MIN_ACCEPTABLE_MINUTIAE 10
 #define BOZORTH3_DEFAULT_THRESHOLD 40
 #define IMG_ENROLL_STAGES 5
+/* enrollment fails after this many samples in a row match none of the
+ * earlier ones while those back each other up */
+#define ENROLL_MAX_MISMATCHES 3
+
+/* A captured image on its way through minutiae detection and matching on a
+ * worker thread. The worker only reads the fields up to img and fills in
+ * those below it; the device is updated once the job is completed from the
+ * events of its context. A cancelled job owns its image and enrollment data,
+ * and the device holds back its deactivation and close completions until
+ * the worker is done with them, see capture_cancelled(). */
+struct imgdev_capture_job {
+	struct fp_img_dev *imgdev;
+	enum fp_imgdev_action action;
+	struct fp_print_data *enroll_data;
+	struct fp_print_data *verify_data;
+	struct fp_print_data **gallery;
+	struct fp_img *img;
+
+	/* NULL if the image was unusable, result then tells why */
+	struct fp_print_data *print;
+	int result;
+	/* enrollment: scores against each sample of the earlier stages, in the
+	 * order of enroll_data, or NULL if they could not be computed */
+	int *scores;
+	size_t match_offset;
+
+	struct fpi_work *work;
+	gboolean cancelled;
+};
+
+static void cancel_capture(struct fp_img_dev *imgdev);
 
 static int img_dev_open(struct fp_dev *dev, unsigned long driver_data)
 {
@@ -65,6 +96,8 @@ static void img_dev_close(struct fp_dev *dev)
 	struct fp_img_dev *imgdev = dev->priv;
 	struct fp_img_driver *imgdrv = fpi_driver_to_img_driver(dev->drv);
 
+	cancel_capture(imgdev);
+
 	if (imgdrv->close)
 		imgdrv->close(imgdev);
 	else
@@ -73,7 +106,14 @@ static void img_dev_close(struct fp_dev *dev)
 
 void fpi_imgdev_close_complete(struct fp_img_dev *imgdev)
 {
+	if (imgdev->capture_job) {
+		fp_dbg("waiting for image processing to stop");
+		imgdev->close_pending = TRUE;
+		return;
+	}
+
 	fpi_drvcb_close_complete(imgdev->dev);
+	fpi_img_free_lfsctx(imgdev->lfsctx);
 	g_free(imgdev);
 }
 
@@ -127,6 +167,12 @@ void fpi_imgdev_report_finger_status(struct fp_img_dev *imgdev,
 
 	fp_dbg(present ? "finger on sensor" : "finger removed");
 
+	/* the results are reported once the image has been processed */
+	if (!present && imgdev->action_state == IMG_ACQUIRE_STATE_PROCESSING) {
+		imgdev->finger_off_pending = TRUE;
+		return;
+	}
+
 	if (present && imgdev->action_state == IMG_ACQUIRE_STATE_AWAIT_FINGER_ON) {
 		dev_change_state(imgdev, IMGDEV_STATE_CAPTURE);
 		imgdev->action_state = IMG_ACQUIRE_STATE_AWAIT_IMAGE;
@@ -180,46 +226,285 @@ void fpi_imgdev_report_finger_status(struct fp_img_dev *imgdev,
 	}
 }
 
-static void verify_process_img(struct fp_img_dev *imgdev)
+/* returns the Bozorth3 score from which prints of an imaging driver match */
+int fpi_img_driver_get_threshold(struct fp_driver *drv)
 {
-	struct fp_img_driver *imgdrv = fpi_driver_to_img_driver(imgdev->dev->drv);
-	int match_score = imgdrv->bz3_threshold;
-	int r;
+	struct fp_img_driver *imgdrv = fpi_driver_to_img_driver(drv);
 
-	if (match_score == 0)
-		match_score = BOZORTH3_DEFAULT_THRESHOLD;
+	if (imgdrv->bz3_threshold == 0)
+		return BOZORTH3_DEFAULT_THRESHOLD;
+	return imgdrv->bz3_threshold;
+}
 
-	r = fpi_img_compare_print_data(imgdev->dev->verify_data,
-		imgdev->acquire_data);
+static int verify_process_img(struct imgdev_capture_job *job,
+	struct fp_print_data *print)
+{
+	int match_score = fpi_img_driver_get_threshold(job->imgdev->dev->drv);
+	int r;
+
+	r = fpi_img_compare_print_data(job->verify_data, print);
 
 	if (r >= match_score)
 		r = FP_VERIFY_MATCH;
 	else if (r >= 0)
 		r = FP_VERIFY_NO_MATCH;
 
-	imgdev->action_result = r;
+	return r;
 }
 
-static void identify_process_img(struct fp_img_dev *imgdev)
+static int identify_process_img(struct imgdev_capture_job *job,
+	struct fp_print_data *print)
 {
-	struct fp_img_driver *imgdrv = fpi_driver_to_img_driver(imgdev->dev->drv);
-	int match_score = imgdrv->bz3_threshold;
-	size_t match_offset;
+	int match_score = fpi_img_driver_get_threshold(job->imgdev->dev->drv);
+
+	return fpi_img_compare_print_data_to_gallery(job->imgdev->dev->ctx,
+		print, job->gallery, match_score, &job->match_offset);
+}
+
+/* Decides on a new enrollment sample from its scores against the nr_kept
+ * samples of the earlier stages, while the finger is still on the sensor, so
+ * that a sample of another finger, or of a different part of it, is retried
+ * straight away rather than making the whole enrollment fail to verify
+ * later. The scores are computed with the rest of the processing of the
+ * image, see process_capture(); scores is NULL if that failed.
+ *
+ * A mismatch is blamed on a pair of samples rather than on the newest one:
+ * a sample matching none of the kept ones replaces a kept sample that
+ * matches no other kept sample either, such as a bad first sample, and the
+ * stage is retried. Only when all kept samples back each other up is the
+ * new sample retried on its own, and enrollment fails after
+ * ENROLL_MAX_MISMATCHES such samples in a row.
+ *
+ * Returns FP_ENROLL_PASS to add the sample as the first of the kept ones,
+ * FP_ENROLL_RETRY with the position of the kept sample it replaces in
+ * replace, or -1 to drop it, or FP_ENROLL_FAIL. */
+int fpi_imgdev_enroll_check(struct fp_img_dev *imgdev, const int *scores,
+	int nr_kept, int threshold, int *replace)
+{
+	guint matched = 0;
+	int i;
+
+	*replace = -1;
+	if (nr_kept == 0 || !scores) {
+		if (nr_kept)
+			fp_dbg("cannot score sample, keeping it");
+		imgdev->enroll_paired <<= 1;
+		return FP_ENROLL_PASS;
+	}
+
+	for (i = 0; i < nr_kept; i++)
+		if (scores[i] >= threshold)
+			matched |= 1U << i;
+
+	if (matched) {
+		imgdev->enroll_mismatches = 0;
+		imgdev->enroll_paired = (imgdev->enroll_paired | matched) << 1
+			| 1;
+		return FP_ENROLL_PASS;
+	}
+
+	for (i = 0; i < nr_kept; i++) {
+		if (!(imgdev->enroll_paired & (1U << i))) {
+			fp_dbg("sample matches no earlier stage, replacing the "
+				"unmatched sample %d", i);
+			*replace = i;
+			return FP_ENROLL_RETRY;
+		}
+	}
+
+	fp_dbg("sample matches no earlier stage");
+	if (++imgdev->enroll_mismatches >= ENROLL_MAX_MISMATCHES)
+		return FP_ENROLL_FAIL;
+	return FP_ENROLL_RETRY;
+}
+
+/* Applies the decision of fpi_imgdev_enroll_check() on a new sample, taking
+ * over or freeing print. Returns the enrollment result to report. */
+static int enroll_add_sample(struct fp_img_dev *imgdev,
+	struct fp_print_data *print, const int *scores)
+{
+	struct fp_print_data_item *item;
+	GSList *kept = NULL;
+	int nr_kept = 0;
+	int replace, r;
+
+	if (imgdev->enroll_data) {
+		kept = imgdev->enroll_data->prints;
+		nr_kept = g_slist_length(kept);
+	}
+	r = fpi_imgdev_enroll_check(imgdev, scores, nr_kept,
+		fpi_img_driver_get_threshold(imgdev->dev->drv), &replace);
+	if (r != FP_ENROLL_PASS && replace < 0) {
+		fp_print_data_free(print);
+		return r;
+	}
+
+	if (!imgdev->enroll_data) {
+		imgdev->enroll_data = fpi_print_data_new(imgdev->dev);
+	}
+	BUG_ON(g_slist_length(print->prints) != 1);
+	/* Move print data from the new print into enroll_data */
+	item = print->prints->data;
+	print->prints = g_slist_remove(print->prints, item);
+	fp_print_data_free(print);
+
+	if (replace >= 0) {
+		kept = g_slist_nth(kept, replace);
+		fpi_print_data_item_free(kept->data);
+		kept->data = item;
+		return r;
+	}
+
+	imgdev->enroll_data->prints =
+		g_slist_prepend(imgdev->enroll_data->prints, item);
+	imgdev->enroll_stage++;
+	if (imgdev->enroll_stage == imgdev->dev->nr_enroll_stages)
+		return FP_ENROLL_COMPLETE;
+	return FP_ENROLL_PASS;
+}
+
+/* Runs on a worker thread. Apart from the minutiae detection tables, which
+ * are left alone until the device is closed, the device is only reached
+ * through the job. */
+static void process_capture(void *data)
+{
+	struct imgdev_capture_job *job = data;
+	struct fp_img_dev *imgdev = job->imgdev;
+	struct fp_img *img = job->img;
+	struct fp_print_data *print;
 	int r;
 
-	if (match_score == 0)
-		match_score = BOZORTH3_DEFAULT_THRESHOLD;
+	r = fpi_img_to_print_data(imgdev, img, &print);
+	if (r < 0) {
+		fp_dbg("image to print data conversion error: %d", r);
+		job->result = FP_ENROLL_RETRY;
+		return;
+	} else if (img->minutiae->num < MIN_ACCEPTABLE_MINUTIAE) {
+		fp_dbg("not enough minutiae, %d/%d", img->minutiae->num,
+			MIN_ACCEPTABLE_MINUTIAE);
+		fp_print_data_free(print);
+		/* depends on FP_ENROLL_RETRY == FP_VERIFY_RETRY */
+		job->result = FP_ENROLL_RETRY;
+		return;
+	}
 
-	r = fpi_img_compare_print_data_to_gallery(imgdev->acquire_data,
-		imgdev->dev->identify_gallery, match_score, &match_offset);
+	job->print = print;
+	switch (job->action) {
+	case IMG_ACTION_ENROLL:
+		if (!job->enroll_data)
+			break;
+		job->scores = g_new(int,
+			g_slist_length(job->enroll_data->prints));
+		r = fpi_img_score_samples(job->enroll_data, print,
+			job->scores);
+		if (r < 0) {
+			fp_dbg("cannot score sample (%d)", r);
+			g_free(job->scores);
+			job->scores = NULL;
+		}
+		break;
+	case IMG_ACTION_VERIFY:
+		job->result = verify_process_img(job, print);
+		break;
+	case IMG_ACTION_IDENTIFY:
+		job->result = identify_process_img(job, print);
+		break;
+	default:
+		BUG();
+		break;
+	}
+}
+
+static void capture_processed(void *data)
+{
+	struct imgdev_capture_job *job = data;
+	struct fp_img_dev *imgdev = job->imgdev;
+	struct fp_print_data *print = job->print;
+
+	imgdev->capture_job = NULL;
+	if (!print) {
+		imgdev->action_result = job->result;
+		goto next_state;
+	}
+
+	switch (imgdev->action) {
+	case IMG_ACTION_ENROLL:
+		imgdev->action_result = enroll_add_sample(imgdev, print,
+			job->scores);
+		break;
+	case IMG_ACTION_VERIFY:
+		imgdev->acquire_data = print;
+		imgdev->action_result = job->result;
+		break;
+	case IMG_ACTION_IDENTIFY:
+		imgdev->acquire_data = print;
+		imgdev->action_result = job->result;
+		imgdev->identify_match_offset = job->match_offset;
+		break;
+	default:
+		BUG();
+		break;
+	}
+
+next_state:
+	g_free(job->scores);
+	g_free(job);
+	imgdev->action_state = IMG_ACQUIRE_STATE_AWAIT_FINGER_OFF;
+	if (imgdev->finger_off_pending) {
+		imgdev->finger_off_pending = FALSE;
+		fpi_imgdev_report_finger_status(imgdev, FALSE);
+	}
+}
+
+/* The worker of a cancelled job has returned: free what it was using and
+ * complete the deactivation or close it held back. */
+static void capture_cancelled(void *data)
+{
+	struct imgdev_capture_job *job = data;
+	struct fp_img_dev *imgdev = job->imgdev;
+
+	imgdev->capture_job = NULL;
+	fp_print_data_free(job->print);
+	fp_print_data_free(job->enroll_data);
+	fp_img_free(job->img);
+	g_free(job->scores);
+	g_free(job);
+
+	if (imgdev->deactivate_pending) {
+		imgdev->deactivate_pending = FALSE;
+		fpi_imgdev_deactivate_complete(imgdev);
+	}
+	if (imgdev->close_pending) {
+		imgdev->close_pending = FALSE;
+		fpi_imgdev_close_complete(imgdev);
+	}
+}
+
+/* Drop the result of the image being processed, without waiting for the
+ * worker. The job takes over the data the worker may still be reading. */
+static void cancel_capture(struct fp_img_dev *imgdev)
+{
+	struct imgdev_capture_job *job = imgdev->capture_job;
+
+	if (!job || job->cancelled)
+		return;
 
-	imgdev->action_result = r;
-	imgdev->identify_match_offset = match_offset;
+	if (job->action == IMG_ACTION_ENROLL)
+		imgdev->enroll_data = NULL;
+	else
+		job->enroll_data = NULL;
+	imgdev->acquire_img = NULL;
+	job->cancelled = TRUE;
+	fpi_work_cancel(job->work, capture_cancelled);
 }
 
+/* Minutiae detection and matching run on a worker thread, so that the events
+ * of the other devices of the context are not held up by them. The device
+ * moves on to wait for the finger to be removed in the meantime, and the
+ * results are reported once both have happened. */
 void fpi_imgdev_image_captured(struct fp_img_dev *imgdev, struct fp_img *img)
 {
-	struct fp_print_data *print;
+	struct imgdev_capture_job *job;
 	int r;
 	fp_dbg("");
 
@@ -242,56 +527,25 @@ void fpi_imgdev_image_captured(struct fp_img_dev *imgdev, struct fp_img *img)
 
 	fp_img_standardize(img);
 	imgdev->acquire_img = img;
-	if (imgdev->action != IMG_ACTION_CAPTURE) {
-		r = fpi_img_to_print_data(imgdev, img, &print);
-		if (r < 0) {
-			fp_dbg("image to print data conversion error: %d", r);
-			imgdev->action_result = FP_ENROLL_RETRY;
-			goto next_state;
-		} else if (img->minutiae->num < MIN_ACCEPTABLE_MINUTIAE) {
-			fp_dbg("not enough minutiae, %d/%d", img->minutiae->num,
-				MIN_ACCEPTABLE_MINUTIAE);
-			fp_print_data_free(print);
-			/* depends on FP_ENROLL_RETRY == FP_VERIFY_RETRY */
-			imgdev->action_result = FP_ENROLL_RETRY;
-			goto next_state;
-		}
-	}
-
-	imgdev->acquire_data = print;
-	switch (imgdev->action) {
-	case IMG_ACTION_ENROLL:
-		if (!imgdev->enroll_data) {
-			imgdev->enroll_data = fpi_print_data_new(imgdev->dev);
-		}
-		BUG_ON(g_slist_length(print->prints) != 1);
-		/* Move print data from acquire data into enroll_data */
-		imgdev->enroll_data->prints =
-			g_slist_prepend(imgdev->enroll_data->prints, print->prints->data);
-		print->prints = g_slist_remove(print->prints, print->prints->data);
-
-		fp_print_data_free(imgdev->acquire_data);
-		imgdev->acquire_data = NULL;
-		imgdev->enroll_stage++;
-		if (imgdev->enroll_stage == imgdev->dev->nr_enroll_stages)
-			imgdev->action_result = FP_ENROLL_COMPLETE;
-		else
-			imgdev->action_result = FP_ENROLL_PASS;
-		break;
-	case IMG_ACTION_VERIFY:
-		verify_process_img(imgdev);
-		break;
-	case IMG_ACTION_IDENTIFY:
-		identify_process_img(imgdev);
-		break;
-	case IMG_ACTION_CAPTURE:
+	if (imgdev->action == IMG_ACTION_CAPTURE) {
 		imgdev->action_result = FP_CAPTURE_COMPLETE;
-		break;
-	default:
-		BUG();
-		break;
+		goto next_state;
 	}
 
+	job = g_malloc0(sizeof(*job));
+	job->imgdev = imgdev;
+	job->action = imgdev->action;
+	job->enroll_data = imgdev->enroll_data;
+	job->verify_data = imgdev->dev->verify_data;
+	job->gallery = imgdev->dev->identify_gallery;
+	job->img = img;
+	imgdev->capture_job = job;
+	imgdev->finger_off_pending = FALSE;
+	imgdev->action_state = IMG_ACQUIRE_STATE_PROCESSING;
+	job->work = fpi_work_queue(process_capture, capture_processed, job);
+	dev_change_state(imgdev, IMGDEV_STATE_AWAIT_FINGER_OFF);
+	return;
+
 next_state:
 	imgdev->action_state = IMG_ACQUIRE_STATE_AWAIT_FINGER_OFF;
 	dev_change_state(imgdev, IMGDEV_STATE_AWAIT_FINGER_OFF);
@@ -352,6 +606,13 @@ void fpi_imgdev_deactivate_complete(struct fp_img_dev *imgdev)
 {
 	fp_dbg("");
 
+	/* the print data of the action is in use until the worker returns */
+	if (imgdev->capture_job) {
+		fp_dbg("waiting for image processing to stop");
+		imgdev->deactivate_pending = TRUE;
+		return;
+	}
+
 	switch (imgdev->action) {
 	case IMG_ACTION_ENROLL:
 		fpi_drvcb_enroll_stopped(imgdev->dev);
@@ -426,6 +687,8 @@ static int generic_acquire_start(struct fp_dev *dev, int action)
 	imgdev->action = action;
 	imgdev->action_state = IMG_ACQUIRE_STATE_ACTIVATING;
 	imgdev->enroll_stage = 0;
+	imgdev->enroll_mismatches = 0;
+	imgdev->enroll_paired = 0;
 
 	r = dev_activate(imgdev, IMGDEV_STATE_AWAIT_FINGER_ON);
 	if (r < 0)
@@ -437,6 +700,9 @@ static int generic_acquire_start(struct fp_dev *dev, int action)
 
 static void generic_acquire_stop(struct fp_img_dev *imgdev)
 {
+	cancel_capture(imgdev);
+	imgdev->finger_off_pending = FALSE;
+
 	imgdev->action_state = IMG_ACQUIRE_STATE_DEACTIVATING;
 	dev_deactivate(imgdev);
 
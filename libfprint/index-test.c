@@ -0,0 +1,195 @@
+/*
+ * Print index test
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Indexes a set of synthetic prints, removes just over half of them, so that
+ * the last removal compacts the postings, and checks that probes rank the
+ * remaining prints in the same order as an index built from those prints
+ * alone. All prints share a few minutiae, so that some cells are held by
+ * every print and the vote weights depend on how many prints are still
+ * indexed. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fp_internal.h"
+
+#include <bozorth.h>
+
+#define NR_PRINTS	24
+#define NR_MINUTIAE	40
+#define NR_SHARED	8
+
+static unsigned int seed = 1;
+
+/* a fixed pseudo-random sequence, unlike rand() */
+static int next_random(int n)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 8) % n;
+}
+
+struct minutia_xyt {
+	int x, y, t;
+};
+
+static int cmp_xyt(const void *a, const void *b)
+{
+	const struct minutia_xyt *ma = a;
+	const struct minutia_xyt *mb = b;
+
+	if (ma->x != mb->x)
+		return ma->x - mb->x;
+	return ma->y - mb->y;
+}
+
+static void gen_minutiae(struct minutia_xyt *m, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		m[i].x = 10 + next_random(236);
+		m[i].y = 10 + next_random(300);
+		m[i].t = next_random(360) - 179;
+	}
+}
+
+/* a print of one sample, stored in x, y order like minutiae_to_xyt() */
+static struct fp_print_data *new_print(struct minutia_xyt *m, int n)
+{
+	struct fp_print_data *print = g_malloc0(sizeof(*print));
+	struct fp_print_data_item *item;
+	struct xyt_packed *xyt;
+	int i;
+
+	qsort(m, n, sizeof(*m), cmp_xyt);
+	item = fpi_print_data_item_new(XYT_PACKED_SIZE(n));
+	xyt = (struct xyt_packed *) item->data;
+	xyt->nrows = n;
+	for (i = 0; i < n; i++) {
+		XYT_PACKED_X(xyt)[i] = m[i].x;
+		XYT_PACKED_Y(xyt)[i] = m[i].y;
+		XYT_PACKED_T(xyt)[i] = m[i].t;
+	}
+
+	print->type = PRINT_DATA_NBIS_MINUTIAE;
+	print->prints = g_slist_prepend(NULL, item);
+	return print;
+}
+
+/* print 0 and the prints with odd IDs are removed, 13 of 24, which compacts
+ * the postings on the last removal. The remaining prints get IDs 0, 1,
+ * 2, ... in a fresh index. */
+static gboolean is_removed(guint32 id)
+{
+	return id == 0 || id % 2;
+}
+
+static int check_ranking(struct fp_print_index *index,
+	struct fp_print_index *fresh, struct fp_print_data *probe)
+{
+	guint32 *ids, *fresh_ids;
+	int n, fresh_n, i, r = 0;
+
+	n = fpi_print_index_rank(index, probe, &ids);
+	fresh_n = fpi_print_index_rank(fresh, probe, &fresh_ids);
+	if (n < 0 || fresh_n < 0) {
+		fprintf(stderr, "ranking failed: %d, %d\n", n, fresh_n);
+		return -1;
+	}
+
+	if (n != fresh_n) {
+		fprintf(stderr, "%d prints ranked, %d in a fresh index\n",
+			n, fresh_n);
+		r = -1;
+	}
+	for (i = 0; i < MIN(n, fresh_n); i++) {
+		if (is_removed(ids[i]) || ids[i] / 2 - 1 != fresh_ids[i]) {
+			fprintf(stderr, "rank %d: print %u, %u in a fresh index\n",
+				i, ids[i], (fresh_ids[i] + 1) * 2);
+			r = -1;
+		}
+	}
+
+	g_free(ids);
+	g_free(fresh_ids);
+	return r;
+}
+
+int main(void)
+{
+	struct fp_print_data *prints[NR_PRINTS + 1];
+	struct fp_print_data *kept[NR_PRINTS + 1];
+	struct fp_print_data *probe;
+	struct fp_print_index *index, *fresh;
+	struct minutia_xyt shared[NR_SHARED];
+	struct minutia_xyt m[NR_MINUTIAE];
+	struct minutia_xyt genuine[NR_MINUTIAE];
+	int i, nr_kept = 0, r = 0;
+
+	gen_minutiae(shared, NR_SHARED);
+	for (i = 0; i < NR_PRINTS; i++) {
+		memcpy(m, shared, sizeof(shared));
+		gen_minutiae(m + NR_SHARED, NR_MINUTIAE - NR_SHARED);
+		if (i == 10)
+			memcpy(genuine, m, sizeof(m));
+		prints[i] = new_print(m, NR_MINUTIAE);
+		if (!is_removed(i))
+			kept[nr_kept++] = prints[i];
+	}
+	prints[NR_PRINTS] = NULL;
+	kept[nr_kept] = NULL;
+
+	index = fp_print_index_new(prints);
+	fresh = fp_print_index_new(kept);
+	if (!index || !fresh) {
+		fprintf(stderr, "could not create the indexes\n");
+		return 1;
+	}
+
+	for (i = 0; i < NR_PRINTS; i++) {
+		if (is_removed(i) && fp_print_index_remove(index, i) < 0) {
+			fprintf(stderr, "could not remove print %d\n", i);
+			return 1;
+		}
+	}
+
+	/* a noisy capture of print 10, with a few minutiae missing */
+	for (i = 0; i < NR_MINUTIAE - 4; i++) {
+		genuine[i].x += next_random(5) - 2;
+		genuine[i].y += next_random(5) - 2;
+	}
+	probe = new_print(genuine, NR_MINUTIAE - 4);
+	if (check_ranking(index, fresh, probe))
+		r = 1;
+	fp_print_data_free(probe);
+
+	/* a print that is not indexed, but has the shared minutiae */
+	memcpy(m, shared, sizeof(shared));
+	gen_minutiae(m + NR_SHARED, NR_MINUTIAE - NR_SHARED);
+	probe = new_print(m, NR_MINUTIAE);
+	if (check_ranking(index, fresh, probe))
+		r = 1;
+	fp_print_data_free(probe);
+
+	fp_print_index_free(index);
+	fp_print_index_free(fresh);
+	for (i = 0; i < NR_PRINTS; i++)
+		fp_print_data_free(prints[i]);
+	return r;
+}
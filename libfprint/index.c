@@ -0,0 +1,500 @@
+/*
+ * Print index for libfprint
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#define FP_COMPONENT "index"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "fp_internal.h"
+#include "nbis/include/bozorth.h"
+
+/** @defgroup print_index Print index
+ * Identifying a scan against a gallery with fp_identify_finger() compares it
+ * with every print of the gallery in turn. For galleries of many thousands
+ * of prints, a print index finds the likely candidates first and only runs
+ * the full comparison on those.
+ *
+ * The index records, for each enrolled print, which kinds of minutiae pairs
+ * (by distance between the two minutiae and by their angles to the line
+ * joining them) occur in it. To identify a print, every pair of minutiae in
+ * the print votes for the indexed prints holding a compatible pair, with
+ * rarer kinds of pairs carrying more weight. The prints with the most votes
+ * are then compared in full, and the best of those that match is reported.
+ *
+ * Only prints from imaging devices can be indexed, and all prints in an
+ * index must come from the same type of device. The index refers to the
+ * prints added to it rather than copying them, so a print must not be
+ * freed while it is in an index.
+ *
+ * The index is a prefilter that makes identification cheaper by a constant
+ * factor, not a search whose cost stays flat as the gallery grows. Each
+ * kind of minutiae pair occurs in a fixed share of all prints, so the votes
+ * cast by a query still grow with the number of indexed prints, just much
+ * more slowly than full comparisons do. Kinds of pairs held by more than a
+ * small share of the prints are not looked at, which bounds the votes to
+ * that share of the prints per pair of the query. Likewise, the chance that
+ * the genuine print is among the candidates compared in full goes down as
+ * the gallery grows, unless more candidates are compared.
+ *
+ * An index can be queried from several threads at once, but must not be
+ * modified while it is being queried.
+ */
+
+/* Candidates compared in full when the caller does not say otherwise */
+#define INDEX_DEFAULT_CANDIDATES 100
+
+/* Cells held by more than one in INDEX_COMMON_CELL_SHARE of the prints, and
+ * by more than INDEX_COMMON_CELL_MIN prints, are skipped when voting: their
+ * votes weigh little and walking them would cost the most. */
+#define INDEX_COMMON_CELL_SHARE 16
+#define INDEX_COMMON_CELL_MIN 64
+
+struct fp_print_index {
+	uint16_t driver_id;
+	uint32_t devtype;
+
+	/* indexed prints by ID, NULL for removed prints */
+	GPtrArray *prints;
+	unsigned int nr_live;
+	/* removed prints whose IDs are still in the postings */
+	unsigned int nr_removed;
+
+	/* for each signature cell, the IDs (guint32) of the prints that have
+	 * a minutiae pair in that cell, in increasing order */
+	GArray *postings[BZ_SIG_CELLS];
+};
+
+struct index_vote {
+	guint32 id;
+	float votes;
+};
+
+/** \ingroup print_index
+ * Creates a new print index, optionally filled with an initial set of
+ * prints. The prints receive IDs 0, 1, 2, ... in the order of the array.
+ * \param prints a NULL-terminated array of prints to index, or NULL to
+ * create an empty index
+ * \returns a new print index, or NULL on error. Must be freed with
+ * fp_print_index_free() after use.
+ */
+API_EXPORTED struct fp_print_index *fp_print_index_new(
+	struct fp_print_data **prints)
+{
+	struct fp_print_index *index = g_malloc0(sizeof(*index));
+	int i;
+
+	index->prints = g_ptr_array_new();
+	if (!prints)
+		return index;
+
+	for (i = 0; prints[i]; i++) {
+		if (fp_print_index_add(index, prints[i]) < 0) {
+			fp_print_index_free(index);
+			return NULL;
+		}
+	}
+
+	return index;
+}
+
+/** \ingroup print_index
+ * Frees a print index. The indexed prints themselves are not freed.
+ * \param index the index to free. If NULL, function simply returns.
+ */
+API_EXPORTED void fp_print_index_free(struct fp_print_index *index)
+{
+	int i;
+
+	if (!index)
+		return;
+
+	for (i = 0; i < BZ_SIG_CELLS; i++)
+		if (index->postings[i])
+			g_array_free(index->postings[i], TRUE);
+	g_ptr_array_free(index->prints, TRUE);
+	g_free(index);
+}
+
+/* ORs the signatures of all samples of a print into sig. The signatures of
+ * the samples are only kept if a prefilter built them already. */
+static int print_signature(struct fp_print_data *print, unsigned char *sig)
+{
+	struct bz_ctx *ctx = fpi_img_get_bz_ctx();
+	struct bz_gallery_tmpl *tmpl;
+	const unsigned char *tmpl_sig;
+	unsigned char *new_sig;
+	GSList *elem;
+	int i;
+
+	if (!ctx)
+		return -ENOMEM;
+
+	memset(sig, 0, BZ_SIG_SIZE);
+	for (elem = print->prints; elem; elem = g_slist_next(elem)) {
+		tmpl = fpi_img_get_gallery_tmpl(ctx, elem->data);
+		if (!tmpl)
+			return -ENOMEM;
+		new_sig = NULL;
+		tmpl_sig = g_atomic_pointer_get(&tmpl->sig);
+		if (!tmpl_sig) {
+			tmpl_sig = new_sig = bz_sig_new(tmpl);
+			if (!new_sig)
+				return -ENOMEM;
+		}
+		for (i = 0; i < BZ_SIG_SIZE; i++)
+			sig[i] |= tmpl_sig[i];
+		free(new_sig);
+	}
+
+	return 0;
+}
+
+/** \ingroup print_index
+ * Adds a print to an index. The print must stay valid until it is removed
+ * from the index or the index is freed.
+ * \param index the index
+ * \param print an enrolled print from an imaging device of the same type as
+ * the prints already in the index
+ * \returns the ID of the print in the index (0 or higher), or a negative
+ * error code
+ */
+API_EXPORTED int fp_print_index_add(struct fp_print_index *index,
+	struct fp_print_data *print)
+{
+	unsigned char *sig;
+	guint32 id;
+	int i, bit, r;
+
+	if (print->type != PRINT_DATA_NBIS_MINUTIAE || !print->prints) {
+		fp_err("invalid print format");
+		return -EINVAL;
+	}
+
+	if (index->prints->len == 0) {
+		index->driver_id = print->driver_id;
+		index->devtype = print->devtype;
+	} else if (print->driver_id != index->driver_id
+			|| print->devtype != index->devtype) {
+		fp_err("print is from %02x/%04x, index holds prints from %02x/%04x",
+			print->driver_id, print->devtype, index->driver_id,
+			index->devtype);
+		return -EINVAL;
+	}
+
+	if (index->prints->len >= G_MAXINT)
+		return -ENOSPC;
+
+	sig = g_malloc(BZ_SIG_SIZE);
+	r = print_signature(print, sig);
+	if (r < 0) {
+		g_free(sig);
+		return r;
+	}
+
+	id = index->prints->len;
+	g_ptr_array_add(index->prints, print);
+	index->nr_live++;
+
+	for (i = 0; i < BZ_SIG_SIZE; i++) {
+		if (!sig[i])
+			continue;
+		for (bit = 0; bit < 8; bit++) {
+			GArray **posting = &index->postings[i * 8 + bit];
+
+			if (!(sig[i] & (1 << bit)))
+				continue;
+			if (!*posting)
+				*posting = g_array_new(FALSE, FALSE, sizeof(guint32));
+			g_array_append_val(*posting, id);
+		}
+	}
+
+	g_free(sig);
+	return id;
+}
+
+/* drops the IDs of removed prints from all postings */
+static void index_compact(struct fp_print_index *index)
+{
+	GArray *posting;
+	guint32 *ids;
+	guint src, dst;
+	int i;
+
+	for (i = 0; i < BZ_SIG_CELLS; i++) {
+		posting = index->postings[i];
+		if (!posting)
+			continue;
+
+		ids = (guint32 *) posting->data;
+		for (src = 0, dst = 0; src < posting->len; src++)
+			if (g_ptr_array_index(index->prints, ids[src]))
+				ids[dst++] = ids[src];
+		g_array_set_size(posting, dst);
+	}
+
+	index->nr_removed = 0;
+}
+
+/** \ingroup print_index
+ * Removes a print from an index. The IDs of the other prints do not change,
+ * and the ID of the removed print is not reused.
+ * \param index the index
+ * \param id the ID of the print, as returned by fp_print_index_add()
+ * \returns 0 on success, or a negative error code if there is no print with
+ * that ID in the index
+ */
+API_EXPORTED int fp_print_index_remove(struct fp_print_index *index, int id)
+{
+	if (id < 0 || (guint) id >= index->prints->len
+			|| !g_ptr_array_index(index->prints, id))
+		return -ENOENT;
+
+	g_ptr_array_index(index->prints, id) = NULL;
+	index->nr_live--;
+
+	/* votes for removed prints are discarded when querying; only clean up
+	 * the postings once removed prints make up more than half of the
+	 * prints in them */
+	if (++index->nr_removed > index->nr_live)
+		index_compact(index);
+
+	return 0;
+}
+
+static int cmp_votes(const void *a, const void *b)
+{
+	const struct index_vote *va = a;
+	const struct index_vote *vb = b;
+
+	if (va->votes != vb->votes)
+		return va->votes > vb->votes ? -1 : 1;
+	return va->id < vb->id ? -1 : (va->id > vb->id);
+}
+
+/* adds up, for each indexed print, the pairs of the probe's samples that
+ * fall into or next to one of its cells. A pair is weighted by how rare the
+ * cell is among the indexed prints, log(prints / prints in the cell), so
+ * that the common kinds of pairs, which nearly every print has, do not
+ * drown out the rare ones that tell prints apart; the most common cells
+ * are skipped altogether. Until the postings are compacted, removed prints
+ * still count towards the prints in a cell. Most prints still get some
+ * votes, so plain arrays over all prints are cheaper here than a sparse
+ * map. */
+static int index_vote(struct fp_print_index *index, struct fp_print_data *print,
+	float *votes)
+{
+	struct bz_ctx *ctx = fpi_img_get_bz_ctx();
+	struct fp_print_data_item *item;
+	guint32 *stamps;
+	float *weights;
+	guint32 stamp = 0;
+	guint nr_live = index->nr_live;
+	guint max_len = MAX(nr_live / INDEX_COMMON_CELL_SHARE,
+		INDEX_COMMON_CELL_MIN);
+	int cells[BZ_SIG_NEAR];
+	GSList *elem;
+	int probe_len, k, n, c;
+	float w;
+	guint i;
+
+	if (!ctx)
+		return -ENOMEM;
+
+	/* a print only gets one vote per probe pair, however many of the
+	 * neighbouring cells it has, weighted by the rarest of them; stamps
+	 * records the last pair it got and weights the weight of that vote */
+	stamps = g_new0(guint32, index->prints->len);
+	weights = g_new(float, index->prints->len);
+
+	for (elem = print->prints; elem; elem = g_slist_next(elem)) {
+		item = elem->data;
+		probe_len = bozorth_probe_init_ctx(ctx,
+			(struct xyt_packed *)item->data);
+
+		for (k = 1; k < probe_len; k++) {
+			stamp++;
+			n = bz_sig_cells_near(ctx->scolpt[k - 1], cells);
+			for (c = 0; c < n; c++) {
+				GArray *posting = index->postings[cells[c]];
+				guint32 *ids;
+
+				/* a cell that all prints have tells them
+				 * nothing, and a common one little */
+				if (!posting || posting->len >= nr_live
+						|| posting->len > max_len)
+					continue;
+				w = logf((float) nr_live / posting->len);
+				ids = (guint32 *) posting->data;
+				for (i = 0; i < posting->len; i++) {
+					guint32 id = ids[i];
+
+					if (stamps[id] != stamp) {
+						stamps[id] = stamp;
+						weights[id] = w;
+						votes[id] += w;
+					} else if (w > weights[id]) {
+						votes[id] += w - weights[id];
+						weights[id] = w;
+					}
+				}
+			}
+		}
+	}
+
+	g_free(weights);
+	g_free(stamps);
+	return 0;
+}
+
+/* Ranks the indexed prints that got any votes from print, most votes first
+ * and by ID among equal votes. Returns the number of ranked prints, whose
+ * IDs are stored in a newly allocated array at ids, or a negative error
+ * code. */
+int fpi_print_index_rank(struct fp_print_index *index,
+	struct fp_print_data *print, guint32 **ids)
+{
+	struct index_vote *ranked;
+	float *votes;
+	guint nr_prints = index->prints->len;
+	guint nr_ranked = 0;
+	guint i;
+	int r;
+
+	votes = g_new0(float, nr_prints);
+	r = index_vote(index, print, votes);
+	if (r < 0) {
+		g_free(votes);
+		return r;
+	}
+
+	ranked = g_new(struct index_vote, nr_prints);
+	for (i = 0; i < nr_prints; i++) {
+		if (!votes[i] || !g_ptr_array_index(index->prints, i))
+			continue;
+		ranked[nr_ranked].id = i;
+		ranked[nr_ranked].votes = votes[i];
+		nr_ranked++;
+	}
+	g_free(votes);
+
+	qsort(ranked, nr_ranked, sizeof(*ranked), cmp_votes);
+	*ids = g_new(guint32, nr_ranked);
+	for (i = 0; i < nr_ranked; i++)
+		(*ids)[i] = ranked[i].id;
+	g_free(ranked);
+
+	return nr_ranked;
+}
+
+/** \ingroup print_index
+ * Identifies a print against the prints in an index. The indexed prints
+ * that share the most minutiae pairs with the print are compared with it in
+ * full, and the one with the best score is reported if it matches.
+ *
+ * Comparing more candidates makes it less likely that a genuine match is
+ * missed because of poor votes, at the cost of more time per query.
+ *
+ * \param index the index
+ * \param print the print to identify, such as one obtained by enrolling
+ * \param max_candidates how many of the prints with the most votes to
+ * compare in full, or 0 for the default of 100
+ * \param match_id output location to store the ID of the matching print.
+ * Only valid if FP_VERIFY_MATCH was returned.
+ * \returns negative code on error, otherwise FP_VERIFY_MATCH or
+ * FP_VERIFY_NO_MATCH
+ */
+API_EXPORTED int fp_print_index_identify(struct fp_print_index *index,
+	struct fp_print_data *print, unsigned int max_candidates, int *match_id)
+{
+	struct fp_driver *drv;
+	struct fp_print_data **candidates;
+	guint32 *ranked;
+	int *scores;
+	guint nr_prints = index->prints->len;
+	guint nr_ranked;
+	guint i;
+	int threshold, best = -1, best_score = 0;
+	int r;
+
+	if (print->type != PRINT_DATA_NBIS_MINUTIAE || !print->prints) {
+		fp_err("invalid print format");
+		return -EINVAL;
+	}
+	if (nr_prints == 0)
+		return FP_VERIFY_NO_MATCH;
+	if (print->driver_id != index->driver_id
+			|| print->devtype != index->devtype) {
+		fp_err("print is from %02x/%04x, index holds prints from %02x/%04x",
+			print->driver_id, print->devtype, index->driver_id,
+			index->devtype);
+		return -EINVAL;
+	}
+
+	drv = fpi_find_driver(index->driver_id);
+	if (!drv || drv->type != DRIVER_IMAGING) {
+		fp_err("no imaging driver with ID %02x", index->driver_id);
+		return -ENODEV;
+	}
+	threshold = fpi_img_driver_get_threshold(drv);
+
+	if (max_candidates == 0)
+		max_candidates = INDEX_DEFAULT_CANDIDATES;
+
+	r = fpi_print_index_rank(index, print, &ranked);
+	if (r < 0)
+		return r;
+	nr_ranked = r;
+	if (nr_ranked > max_candidates)
+		nr_ranked = max_candidates;
+	fp_dbg("comparing %u of %u prints", nr_ranked, nr_prints);
+
+	candidates = g_new(struct fp_print_data *, nr_ranked + 1);
+	for (i = 0; i < nr_ranked; i++)
+		candidates[i] = g_ptr_array_index(index->prints, ranked[i]);
+	candidates[nr_ranked] = NULL;
+	scores = g_new(int, nr_ranked + 1);
+
+	r = fp_img_compare_batch(print, candidates, scores);
+	if (r == 0) {
+		/* candidates are in vote order, so ties go to more votes */
+		for (i = 0; i < nr_ranked; i++) {
+			if (scores[i] >= threshold && scores[i] > best_score) {
+				best = ranked[i];
+				best_score = scores[i];
+			}
+		}
+		if (best >= 0) {
+			fp_dbg("print %d matched with score %d", best, best_score);
+			*match_id = best;
+			r = FP_VERIFY_MATCH;
+		} else {
+			r = FP_VERIFY_NO_MATCH;
+		}
+	}
+
+	g_free(scores);
+	g_free(candidates);
+	g_free(ranked);
+	return r;
+}
@@ -0,0 +1,13 @@
+#!/bin/sh
+# Check that the vectorised and the scalar DFT give identical Direction,
+# Low Contrast and Low Flow Maps, from 6-bit pixels and at full precision.
+
+for bits in 6 8; do
+	./nbis-maps-test $bits > nbis-maps-test.out || exit 1
+	./nbis-maps-test-scalar $bits > nbis-maps-test.out-scalar || exit 1
+	if ! cmp nbis-maps-test.out nbis-maps-test.out-scalar; then
+		echo "maps from $bits-bit pixels differ" >&2
+		exit 1
+	fi
+done
+exit 0
@@ -83,6 +83,11 @@ identified are necessarily the best available for the purpose.
 #cat: bz_final_loop - (declared static) a final postprocess after
 #cat:            the main match table traversal which looks to combine
 #cat:            clusters of compatible paths
+#cat: bz_match_ctx, bz_match_score_ctx - variants of bz_match and
+#cat:            bz_match_score operating on a caller supplied context;
+#cat:            the plain versions use the shared default context
+#cat: bz_match_tmpl_ctx - variant of bz_match_ctx taking the gallery
+#cat:            table from a compiled gallery template
 
 ***********************************************************************/
 
@@ -95,26 +100,23 @@ static const int m1_xyt = 0;
 /***********************************************************************/
 void bz_comp(
 	int npoints,				/* INPUT: # of points */
-	int xcol[     MAX_BOZORTH_MINUTIAE ],	/* INPUT: x cordinates */
-	int ycol[     MAX_BOZORTH_MINUTIAE ],	/* INPUT: y cordinates */
-	int thetacol[ MAX_BOZORTH_MINUTIAE ],	/* INPUT: theta values */
+	short xcol[],				/* INPUT: x cordinates */
+	short ycol[],				/* INPUT: y cordinates */
+	short thetacol[],			/* INPUT: theta values */
 
 	int * ncomparisons,			/* OUTPUT: number of pointwise comparisons */
 	int cols[][ COLS_SIZE_2 ],		/* OUTPUT: pointwise comparison table */
 	int * colptrs[]				/* INPUT and OUTPUT: sorted list of pointers to rows in cols[] */
 	)
 {
-int i, j, k;
-
-int b;
-int t;
-int n;
-int l;
+int j, k;
 
 int table_index;
 
 int dx;
 int dy;
+int adx;
+int ady;
 int distance;
 
 int theta_kj;
@@ -158,17 +160,18 @@ for ( k = 0; k < npoints - 1; k++ ) {
 		if ( dx == 0 )
 			theta_kj = 90;
 		else {
-			double dz;
-
+			/* Look up the rounded atan( dy / dx ) in the first octant */
+			/* and map it back; dx and dy are both within [ -DM, DM ].  */
 			if ( m1_xyt )
-				dz = ( 180.0F / PI_SINGLE ) * atanf( (float) -dy / (float) dx );
-			else
-				dz = ( 180.0F / PI_SINGLE ) * atanf( (float) dy / (float) dx );
-			if ( dz < 0.0F )
-				dz -= 0.5F;
+				dy = -dy;
+			adx = ( dx < 0 ) ? -dx : dx;
+			ady = ( dy < 0 ) ? -dy : dy;
+			if ( ady <= adx )
+				theta_kj = bz_atan_table[ adx * ( adx + 1 ) / 2 + ady ];
 			else
-				dz += 0.5F;
-			theta_kj = (int) dz;
+				theta_kj = 90 - bz_atan_table[ ady * ( ady + 1 ) / 2 + adx ];
+			if ( ( dx < 0 ) != ( dy < 0 ) )
+				theta_kj = -theta_kj;
 		}
 
 
@@ -197,65 +200,7 @@ for ( k = 0; k < npoints - 1; k++ ) {
 		}
 
 
-
-
-
-
-		b = 0;
-		t = table_index + 1;
-		l = 1;
-		n = -1;			/* Init binary search state ... */
-
-
-
-
-		while ( t - b > 1 ) {
-			int * midpoint;
-
-			l = ( b + t ) / 2;
-			midpoint = colptrs[l-1];
-
-
-
-
-			for ( i=0; i < 3; i++ ) {
-				int dd, ff;
-
-				dd = cols[table_index][i];
-
-				ff = midpoint[i];
-
-
-				n = SENSE(dd,ff);
-
-
-				if ( n < 0 ) {
-					t = l;
-					break;
-				}
-				if ( n > 0 ) {
-					b = l;
-					break;
-				}
-			}
-
-			if ( n == 0 ) {
-				n = 1;
-				b = l;
-			}
-		} /* END while */
-
-		if ( n == 1 )
-			++l;
-
-
-
-
-		for ( i = table_index; i >= l; --i )
-			colptrs[i] = colptrs[i-1];
-
-
-		colptrs[l-1] = &cols[table_index][0];
+		colptrs[table_index] = &cols[table_index][0];
 		++table_index;
 
 
@@ -274,6 +219,10 @@ for ( k = 0; k < npoints - 1; k++ ) {
 COMP_END:
 	*ncomparisons = table_index;
 
+	/* Sort the row pointers once the table is complete; equal rows keep */
+	/* their table order, as they did with the former insertion sort.   */
+	qsort( (void *) colptrs, (size_t) table_index, sizeof(int *), sort_colptrs );
+
 }
 
 /***********************************************************************/
@@ -352,8 +301,11 @@ while ( shiftcount-- > 0 ) {
 /*	and lastly on Subject's J point index.              */
 /* Return value is the # of compatible edge pairs           */
 /***********************************************************************/
-int bz_match(
+static int bz_match_colpt(
+	struct bz_ctx * ctx,		/* INPUT and OUTPUT: match context holding the tables below */
 	int probe_ptrlist_len,		/* INPUT:  pruned length of Subject's pointer list */
+	int ** fcolpt,			/* INPUT:  On-File Record's sorted row-pointer list, or */
+	short (* frows)[ COLS_SIZE_2 ],	/* INPUT:  its sorted rows from a gallery template */
 	int gallery_ptrlist_len		/* INPUT:  pruned length of On-File Record's pointer list */
 	)
 {
@@ -364,6 +316,7 @@ float dz;		/* Delta difference and delta angle stats */
 float fi;		/* Distance limit based on factor TK */
 int * ss;		/* Subject's comparison stats row */
 int * ff;		/* On-File Record's comparison stats row */
+int frow[ COLS_SIZE_2 ];	/* Row widened from frows[] */
 int j;			/* On-File Record's row index */
 int k;			/* Subject's row index */
 int st;			/* Starting On-File Record's row index */
@@ -377,21 +330,17 @@ int t;			/* Top of search range */
 register int * rotptr;
 
 
-#define ROT_SIZE_1 20000
-#define ROT_SIZE_2 5
-
-static int rot[ ROT_SIZE_1 ][ ROT_SIZE_2 ];
+int (* rot)[ ROT_SIZE_2 ] = ctx->rot;
 
 
-static int * rtp[ ROT_SIZE_1 ];
+int ** rtp = ctx->rtp;
 
 
 
 
-/* These now externally defined in bozorth.h */
-/* extern int * scolpt[ SCOLPT_SIZE ];			 INPUT */
-/* extern int * fcolpt[ FCOLPT_SIZE ];			 INPUT */
-/* extern int   colp[ COLP_SIZE_1 ][ COLP_SIZE_2 ];	 OUTPUT */
+/* These are now held in the match context */
+int ** scolpt = ctx->scolpt;			/* INPUT */
+int (* colp)[ COLP_SIZE_2 ] = ctx->colp;	/* OUTPUT */
 /* extern int verbose_bozorth; */
 /* extern FILE * stderr; */
 /* extern char * get_progname( void ); */
@@ -413,7 +362,12 @@ for ( k = 1; k < probe_ptrlist_len; k++ ) {
 	/* Foreach sorted edge in On-File Record's Web ... */
 
 	for ( j = st; j <= gallery_ptrlist_len; j++ ) {
-		ff = fcolpt[j-1];
+		if ( frows != NULL ) {
+			for ( i = 0; i < COLS_SIZE_2; i++ )
+				frow[i] = frows[j-1][i];
+			ff = frow;
+		} else
+			ff = fcolpt[j-1];
 		dz = *ff - *ss;
 
 		fi = ( 2.0F * TK ) * ( *ff + *ss );
@@ -592,6 +546,11 @@ END:
 
 
 	}
+
+	/* bz_match_score() looks one row past the last edge pair; terminate */
+	/* the table so it never sees what a previous match left behind, and */
+	/* the score depends only on this Probe and Gallery pair.            */
+	INT_SET( colp_ptr, COLP_SIZE_2, 0 );
 }
 
 
@@ -599,23 +558,51 @@ END:
 return edge_pair_index;			/* Return the number of compatible edge pairs stored into colp[][] */
 }
 
+/***********************************************************************/
+int bz_match_ctx(
+	struct bz_ctx * ctx,		/* INPUT and OUTPUT: match context */
+	int probe_ptrlist_len,		/* INPUT:  pruned length of Subject's pointer list */
+	int gallery_ptrlist_len		/* INPUT:  pruned length of On-File Record's pointer list */
+	)
+{
+return bz_match_colpt( ctx, probe_ptrlist_len, ctx->fcolpt, NULL,
+		gallery_ptrlist_len );
+}
+
+/***********************************************************************/
+/* As bz_match_ctx(), but takes the On-File Record's Web from a gallery */
+/* template compiled earlier instead of from the context's fcols table. */
+/***********************************************************************/
+int bz_match_tmpl_ctx(
+	struct bz_ctx * ctx,		/* INPUT and OUTPUT: match context */
+	int probe_ptrlist_len,		/* INPUT:  pruned length of Subject's pointer list */
+	struct bz_gallery_tmpl * tmpl	/* INPUT:  compiled On-File Record's Web */
+	)
+{
+return bz_match_colpt( ctx, probe_ptrlist_len, NULL, tmpl->rows, tmpl->len );
+}
+
+/***********************************************************************/
+int bz_match(
+	int probe_ptrlist_len,		/* INPUT:  pruned length of Subject's pointer list */
+	int gallery_ptrlist_len		/* INPUT:  pruned length of On-File Record's pointer list */
+	)
+{
+return bz_match_ctx( &bz_default_ctx, probe_ptrlist_len, gallery_ptrlist_len );
+}
+
 /**************************************************************************/
-/* These global arrays are declared "static" as they are only used        */
-/* between bz_match_score() & bz_final_loop()                             */
+/* The ct, gct, ctt, ctp and yy arrays (formerly file statics) are only   */
+/* used between bz_match_score() & bz_final_loop()                        */
 /**************************************************************************/
-static int ct[ CT_SIZE ];
-static int gct[ GCT_SIZE ];
-static int ctt[ CTT_SIZE ];
-static int ctp[ CTP_SIZE_1 ][ CTP_SIZE_2 ];
-static int yy[ YY_SIZE_1 ][ YY_SIZE_2 ][ YY_SIZE_3 ];
-
-static int    bz_final_loop( int );
+static int    bz_final_loop( struct bz_ctx *, int );
 
 /**************************************************************************/
-int bz_match_score(
+int bz_match_score_ctx(
+	struct bz_ctx * ctx,
 	int np,
-	struct xyt_struct * pstruct,
-	struct xyt_struct * gstruct
+	struct xyt_packed * pstruct,
+	struct xyt_packed * gstruct
 	)
 {
 int kx, kq;
@@ -632,11 +619,33 @@ int match_score;
 int qq_overflow = 0;
 float fi;
 
-/* These next 3 arrays originally declared global, but moved here */
-/* locally because they are only used herein */
-int rr[ RR_SIZE ];
-int avn[ AVN_SIZE ];
-int avv[ AVV_SIZE_1 ][ AVV_SIZE_2 ];
+/* These next 3 arrays originally declared global, then moved to */
+/* the stack; they now live in the match context with the rest    */
+int * rr = ctx->rr;
+int * avn = ctx->avn;
+int (* avv)[ AVV_SIZE_2 ] = ctx->avv;
+
+int (* colp)[ COLP_SIZE_2 ] = ctx->colp;
+int (* yl)[ YL_SIZE_2 ] = ctx->yl;
+int (* yy)[ YY_SIZE_2 ][ YY_SIZE_3 ] = ctx->yy;
+int (* ctp)[ CTP_SIZE_2 ] = ctx->ctp;
+int * sc  = ctx->sc;
+int * cp  = ctx->cp;
+int * rp  = ctx->rp;
+int * tq  = ctx->tq;
+int * rq  = ctx->rq;
+int * zz  = ctx->zz;
+int * qq  = ctx->qq;
+int * rk  = ctx->rk;
+int * rx  = ctx->rx;
+int * mm  = ctx->mm;
+int * nn  = ctx->nn;
+int * y   = ctx->y;
+int * ct  = ctx->ct;
+int * gct = ctx->gct;
+int * ctt = ctx->ctt;
+int (* rf)[ RF_SIZE_2 ] = ctx->rf;
+int (* cf)[ CF_SIZE_2 ] = ctx->cf;
 
 /* These now externally defined in bozorth.h */
 /* extern FILE * stderr; */
@@ -690,18 +699,18 @@ if ( gstruct->nrows < MIN_COMPUTABLE_BOZORTH_MINUTIAE ) {
 
 
 								/* initialize tables to 0's */
-INT_SET( (int *) &yl, YL_SIZE_1 * YL_SIZE_2, 0 );
+INT_SET( (int *) yl, YL_SIZE_1 * YL_SIZE_2, 0 );
 
 
 
-INT_SET( (int *) &sc, SC_SIZE, 0 );
-INT_SET( (int *) &cp, CP_SIZE, 0 );
-INT_SET( (int *) &rp, RP_SIZE, 0 );
-INT_SET( (int *) &tq, TQ_SIZE, 0 );
-INT_SET( (int *) &rq, RQ_SIZE, 0 );
-INT_SET( (int *) &zz, ZZ_SIZE, 1000 );				/* zz[] initialized to 1000's */
+INT_SET( sc, SC_SIZE, 0 );
+INT_SET( cp, CP_SIZE, 0 );
+INT_SET( rp, RP_SIZE, 0 );
+INT_SET( tq, TQ_SIZE, 0 );
+INT_SET( rq, RQ_SIZE, 0 );
+INT_SET( zz, ZZ_SIZE, 1000 );				/* zz[] initialized to 1000's */
 
-INT_SET( (int *) &avn, AVN_SIZE, 0 );				/* avn[0...4] <== 0; */
+INT_SET( avn, AVN_SIZE, 0 );				/* avn[0...4] <== 0; */
 
 
 
@@ -757,7 +766,7 @@ for ( k = 0; k < np - 1; k++ ) {
 			kz = colp[kx][2];
 			l  = colp[kx][4];
 			kx++;
-			bz_sift( &ww, kz, &qh, l, kx, ftt, &tot, &qq_overflow );
+			bz_sift( ctx, &ww, kz, &qh, l, kx, ftt, &tot, &qq_overflow );
 			if ( qq_overflow ) {
 				fprintf( stderr, "%s: WARNING: bz_match_score(): qq[] overflow from bz_sift() #1 [p=%s; g=%s]\n",
 							get_progname(), get_probe_filename(), get_gallery_filename() );
@@ -809,7 +818,7 @@ for ( k = 0; k < np - 1; k++ ) {
 
 					if ( z != colp[k][1] && l != colp[k][3] ) {
 						kx = i + 1;
-						bz_sift( &ww, z, &qh, l, kx, ftt, &tot, &qq_overflow );
+						bz_sift( ctx, &ww, z, &qh, l, kx, ftt, &tot, &qq_overflow );
 						if ( qq_overflow ) {
 							fprintf( stderr, "%s: WARNING: bz_match_score(): qq[] overflow from bz_sift() #2 [p=%s; g=%s]\n",
 								get_progname(), get_probe_filename(), get_gallery_filename() );
@@ -881,7 +890,7 @@ for ( k = 0; k < np - 1; k++ ) {
 						kz = colp[kx][2];
 						l  = colp[kx][4];
 						kx++;
-						bz_sift( &ww, kz, &qh, l, kx, ftt, &tot, &qq_overflow );
+						bz_sift( ctx, &ww, kz, &qh, l, kx, ftt, &tot, &qq_overflow );
 						if ( qq_overflow ) {
 							fprintf( stderr, "%s: WARNING: bz_match_score(): qq[] overflow from bz_sift() #3 [p=%s; g=%s]\n",
 								get_progname(), get_probe_filename(), get_gallery_filename() );
@@ -1012,12 +1021,12 @@ for ( k = 0; k < np - 1; k++ ) {
 						}
 						break;
 					  case 2:
-						avn[ii-1] += pstruct->xcol[jj-1];
-						avn[ii] += pstruct->ycol[jj-1];
+						avn[ii-1] += XYT_PACKED_X(pstruct)[jj-1];
+						avn[ii] += XYT_PACKED_Y(pstruct)[jj-1];
 						break;
 					  default:
-						avn[ii] += gstruct->xcol[jj-1];
-						avn[ii+1] += gstruct->ycol[jj-1];
+						avn[ii] += XYT_PACKED_X(gstruct)[jj-1];
+						avn[ii+1] += XYT_PACKED_Y(gstruct)[jj-1];
 						break;
 					} /* switch */
 				} /* END for ii = [1..3] */
@@ -1467,14 +1476,28 @@ if ( match_score < MMSTR ) {
 	return match_score;
 }
 
-match_score = bz_final_loop( tp );
+match_score = bz_final_loop( ctx, tp );
 return match_score;
 }
 
+/**************************************************************************/
+int bz_match_score(
+	int np,
+	struct xyt_struct * pstruct,
+	struct xyt_struct * gstruct
+	)
+{
+struct xyt_packed p, g;
+
+xyt_to_packed( pstruct, &p );
+xyt_to_packed( gstruct, &g );
+return bz_match_score_ctx( &bz_default_ctx, np, &p, &g );
+}
+
 
 /***********************************************************************/
 /* These globals signficantly used by bz_sift () */
-/* Now externally defined in bozorth.h */
+/* Now held in the match context passed by the caller */
 /* extern int sc[ SC_SIZE ]; */
 /* extern int rq[ RQ_SIZE ]; */
 /* extern int tq[ TQ_SIZE ]; */
@@ -1491,6 +1514,7 @@ return match_score;
 /* extern int y[ Y_SIZE ]; */
 
 void bz_sift(
+	struct bz_ctx * ctx,	/* INPUT and OUTPUT; match context holding the tables below */
 	int * ww,		/* INPUT and OUTPUT; endpoint groups index; *ww may be bumped by one or by two */
 	int   kz,		/* INPUT only;       endpoint of lookahead Subject edge */
 	int * qh,		/* INPUT and OUTPUT; the value is an index into qq[] and is stored in zz[]; *qh may be bumped by one */
@@ -1504,6 +1528,21 @@ void bz_sift(
 int n;
 int t;
 
+int * sc = ctx->sc;
+int * rq = ctx->rq;
+int * tq = ctx->tq;
+int * zz = ctx->zz;
+int * rx = ctx->rx;
+int * mm = ctx->mm;
+int * nn = ctx->nn;
+int * qq = ctx->qq;
+int * rk = ctx->rk;
+int * cp = ctx->cp;
+int * rp = ctx->rp;
+int * y  = ctx->y;
+int (* rf)[ RF_SIZE_2 ] = ctx->rf;
+int (* cf)[ CF_SIZE_2 ] = ctx->cf;
+
 /* These now externally defined in bozorth.h */
 /* extern FILE * stderr; */
 /* extern char * get_progname( void ); */
@@ -1685,17 +1724,26 @@ if ( t ) {
 
 /**************************************************************************/
 
-static int bz_final_loop( int tp )
+static int bz_final_loop( struct bz_ctx * ctx, int tp )
 {
 int ii, i, t, b, n, k, j, kk, jj;
 int lim;
 int match_score;
 
-/* This array originally declared global, but moved here */
-/* locally because it is only used herein.  The use of   */
-/* "static" is required as the array will exceed the     */
-/* stack allocation on our local systems otherwise.      */
-static int sct[ SCT_SIZE_1 ][ SCT_SIZE_2 ];
+/* This array originally declared global, then moved here  */
+/* as a local "static" because it would exceed the stack   */
+/* allocation otherwise. It now lives in the match context */
+/* so that concurrent matches do not share it.             */
+int (* sct)[ SCT_SIZE_2 ] = ctx->sct;
+
+int (* ctp)[ CTP_SIZE_2 ] = ctx->ctp;
+int * ct  = ctx->ct;
+int * gct = ctx->gct;
+int * ctt = ctx->ctt;
+int * cp  = ctx->cp;
+int * rp  = ctx->rp;
+int * rk  = ctx->rk;
+int * y   = ctx->y;
 
 match_score = 0;
 for ( ii = 0; ii < tp; ii++ ) {				/* For each index up to the current value of TP ... */
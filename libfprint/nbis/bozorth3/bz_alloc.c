@@ -68,6 +68,11 @@ identified are necessarily the best available for the purpose.
 #cat:        specified length exiting directly upon system error
 #cat: malloc_or_return_error - allocates a buffer of bytes from the heap
 #cat:        of specified length returning an error code upon system error
+#cat: bz_ctx_new - allocates a zeroed match context so that matches may
+#cat:        run without touching the shared default context
+#cat: bz_ctx_free - releases a match context allocated by bz_ctx_new
+#cat: bz_gallery_tmpl_free - releases a gallery template allocated by
+#cat:        bz_gallery_tmpl_new, along with its signature
 
 ***********************************************************************/
 
@@ -117,3 +122,37 @@ if ( p == CNULL ) {
 }
 return p;
 }
+
+/***********************************************************************/
+/* returns BZ_CTX_NULL on error */
+struct bz_ctx * bz_ctx_new( void )
+{
+struct bz_ctx * ctx;
+
+/* Zero-filled to match the initial state of the former global tables */
+ctx = (struct bz_ctx *) calloc( 1, sizeof(struct bz_ctx) );
+if ( ctx == BZ_CTX_NULL ) {
+	fprintf( stderr, "%s: ERROR: calloc() of %zu bytes for match context failed: %s\n",
+						get_progname(),
+						sizeof(struct bz_ctx),
+						strerror( errno )
+						);
+	return BZ_CTX_NULL;
+}
+return ctx;
+}
+
+/***********************************************************************/
+void bz_ctx_free( struct bz_ctx * ctx )
+{
+free( (void *) ctx );
+}
+
+/***********************************************************************/
+void bz_gallery_tmpl_free( struct bz_gallery_tmpl * tmpl )
+{
+if ( tmpl == BZ_GALLERY_TMPL_NULL )
+	return;
+free( (void *) tmpl->sig );
+free( (void *) tmpl );
+}
@@ -0,0 +1,614 @@
+/*******************************************************************************
+
+License: 
+This software was developed at the National Institute of Standards and 
+Technology (NIST) by employees of the Federal Government in the course 
+of their official duties. Pursuant to title 17 Section 105 of the 
+United States Code, this software is not subject to copyright protection 
+and is in the public domain. NIST assumes no responsibility  whatsoever for 
+its use by other parties, and makes no guarantees, expressed or implied, 
+about its quality, reliability, or any other characteristic. 
+
+Disclaimer: 
+This software was developed to promote biometric standards and biometric
+technology testing for the Federal Government in accordance with the USA
+PATRIOT Act and the Enhanced Border Security and Visa Entry Reform Act.
+Specific hardware and software products identified in this software were used
+in order to perform the software development.  In no case does such
+identification imply recommendation or endorsement by the National Institute
+of Standards and Technology, nor does it imply that the products and equipment
+identified are necessarily the best available for the purpose.  
+
+*******************************************************************************/
+
+/***********************************************************************
+      LIBRARY: FING - NIST Fingerprint Systems Utilities
+
+      FILE:           BZ_ATAN.C
+
+      Contains the lookup table used by bz_comp() to find the angle
+      of the line joining two minutiae without calling atanf().
+
+      Minutiae that bz_comp() pairs up are never more than DM (125)
+      pixels apart on either axis, so every angle it can need is
+      covered by the first octant, dx = 1..125 and dy = 0..dx. The
+      entry for (dx,dy) is at index dx*(dx+1)/2+dy, and holds
+
+          ROUND( ( 180 / PI ) * atanf( dy / dx ) )
+
+      computed as in the original bz_comp(). The rounded angle is at
+      least 1.6e-4 degrees away from any rounding boundary for all of
+      these ratios, so the table does not depend on the precision of
+      PI or of the atanf() used to compute it.
+
+***********************************************************************
+***********************************************************************/
+
+#include <bozorth.h>
+
+/**************************************************************************/
+/* Rounded atan( dy / dx ) in degrees, for 0 <= dy <= dx <= DM */
+/**************************************************************************/
+
+const unsigned char bz_atan_table[ BZ_ATAN_TABLE_SIZE ] = {
+	/*   0 */  0,
+	/*   1 */  0, 45,
+	/*   2 */  0, 27, 45,
+	/*   3 */  0, 18, 34, 45,
+	/*   4 */  0, 14, 27, 37, 45,
+	/*   5 */  0, 11, 22, 31, 39, 45,
+	/*   6 */  0,  9, 18, 27, 34, 40, 45,
+	/*   7 */  0,  8, 16, 23, 30, 36, 41, 45,
+	/*   8 */  0,  7, 14, 21, 27, 32, 37, 41, 45,
+	/*   9 */  0,  6, 13, 18, 24, 29, 34, 38, 42, 45,
+	/*  10 */  0,  6, 11, 17, 22, 27, 31, 35, 39, 42, 45,
+	/*  11 */  0,  5, 10, 15, 20, 24, 29, 32, 36, 39, 42, 45,
+	/*  12 */  0,  5,  9, 14, 18, 23, 27, 30, 34, 37, 40, 43, 45,
+	/*  13 */  0,  4,  9, 13, 17, 21, 25, 28, 32, 35, 38, 40, 43, 45,
+	/*  14 */  0,  4,  8, 12, 16, 20, 23, 27, 30, 33, 36, 38, 41, 43, 45,
+	/*  15 */  0,  4,  8, 11, 15, 18, 22, 25, 28, 31, 34, 36, 39, 41, 43, 45,
+	/*  16 */  0,  4,  7, 11, 14, 17, 21, 24, 27, 29, 32, 35, 37, 39, 41, 43,
+	          45,
+	/*  17 */  0,  3,  7, 10, 13, 16, 19, 22, 25, 28, 30, 33, 35, 37, 39, 41,
+	          43, 45,
+	/*  18 */  0,  3,  6,  9, 13, 16, 18, 21, 24, 27, 29, 31, 34, 36, 38, 40,
+	          42, 43, 45,
+	/*  19 */  0,  3,  6,  9, 12, 15, 18, 20, 23, 25, 28, 30, 32, 34, 36, 38,
+	          40, 42, 43, 45,
+	/*  20 */  0,  3,  6,  9, 11, 14, 17, 19, 22, 24, 27, 29, 31, 33, 35, 37,
+	          39, 40, 42, 44, 45,
+	/*  21 */  0,  3,  5,  8, 11, 13, 16, 18, 21, 23, 25, 28, 30, 32, 34, 36,
+	          37, 39, 41, 42, 44, 45,
+	/*  22 */  0,  3,  5,  8, 10, 13, 15, 18, 20, 22, 24, 27, 29, 31, 32, 34,
+	          36, 38, 39, 41, 42, 44, 45,
+	/*  23 */  0,  2,  5,  7, 10, 12, 15, 17, 19, 21, 23, 26, 28, 29, 31, 33,
+	          35, 36, 38, 40, 41, 42, 44, 45,
+	/*  24 */  0,  2,  5,  7,  9, 12, 14, 16, 18, 21, 23, 25, 27, 28, 30, 32,
+	          34, 35, 37, 38, 40, 41, 43, 44, 45,
+	/*  25 */  0,  2,  5,  7,  9, 11, 13, 16, 18, 20, 22, 24, 26, 27, 29, 31,
+	          33, 34, 36, 37, 39, 40, 41, 43, 44, 45,
+	/*  26 */  0,  2,  4,  7,  9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 28, 30,
+	          32, 33, 35, 36, 38, 39, 40, 41, 43, 44, 45,
+	/*  27 */  0,  2,  4,  6,  8, 10, 13, 15, 17, 18, 20, 22, 24, 26, 27, 29,
+	          31, 32, 34, 35, 37, 38, 39, 40, 42, 43, 44, 45,
+	/*  28 */  0,  2,  4,  6,  8, 10, 12, 14, 16, 18, 20, 21, 23, 25, 27, 28,
+	          30, 31, 33, 34, 36, 37, 38, 39, 41, 42, 43, 44, 45,
+	/*  29 */  0,  2,  4,  6,  8, 10, 12, 14, 15, 17, 19, 21, 22, 24, 26, 27,
+	          29, 30, 32, 33, 35, 36, 37, 38, 40, 41, 42, 43, 44, 45,
+	/*  30 */  0,  2,  4,  6,  8,  9, 11, 13, 15, 17, 18, 20, 22, 23, 25, 27,
+	          28, 30, 31, 32, 34, 35, 36, 37, 39, 40, 41, 42, 43, 44, 45,
+	/*  31 */  0,  2,  4,  6,  7,  9, 11, 13, 14, 16, 18, 20, 21, 23, 24, 26,
+	          27, 29, 30, 32, 33, 34, 35, 37, 38, 39, 40, 41, 42, 43, 44, 45,
+	/*  32 */  0,  2,  4,  5,  7,  9, 11, 12, 14, 16, 17, 19, 21, 22, 24, 25,
+	          27, 28, 29, 31, 32, 33, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44,
+	          45,
+	/*  33 */  0,  2,  3,  5,  7,  9, 10, 12, 14, 15, 17, 18, 20, 22, 23, 24,
+	          26, 27, 29, 30, 31, 32, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43,
+	          44, 45,
+	/*  34 */  0,  2,  3,  5,  7,  8, 10, 12, 13, 15, 16, 18, 19, 21, 22, 24,
+	          25, 27, 28, 29, 30, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42,
+	          43, 44, 45,
+	/*  35 */  0,  2,  3,  5,  7,  8, 10, 11, 13, 14, 16, 17, 19, 20, 22, 23,
+	          25, 26, 27, 28, 30, 31, 32, 33, 34, 36, 37, 38, 39, 40, 41, 42,
+	          42, 43, 44, 45,
+	/*  36 */  0,  2,  3,  5,  6,  8,  9, 11, 13, 14, 16, 17, 18, 20, 21, 23,
+	          24, 25, 27, 28, 29, 30, 31, 33, 34, 35, 36, 37, 38, 39, 40, 41,
+	          42, 43, 43, 44, 45,
+	/*  37 */  0,  2,  3,  5,  6,  8,  9, 11, 12, 14, 15, 17, 18, 19, 21, 22,
+	          23, 25, 26, 27, 28, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+	          41, 42, 43, 43, 44, 45,
+	/*  38 */  0,  2,  3,  5,  6,  7,  9, 10, 12, 13, 15, 16, 18, 19, 20, 22,
+	          23, 24, 25, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39,
+	          40, 41, 42, 43, 43, 44, 45,
+	/*  39 */  0,  1,  3,  4,  6,  7,  9, 10, 12, 13, 14, 16, 17, 18, 20, 21,
+	          22, 24, 25, 26, 27, 28, 29, 31, 32, 33, 34, 35, 36, 37, 38, 38,
+	          39, 40, 41, 42, 43, 43, 44, 45,
+	/*  40 */  0,  1,  3,  4,  6,  7,  9, 10, 11, 13, 14, 15, 17, 18, 19, 21,
+	          22, 23, 24, 25, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38,
+	          39, 40, 40, 41, 42, 43, 44, 44, 45,
+	/*  41 */  0,  1,  3,  4,  6,  7,  8, 10, 11, 12, 14, 15, 16, 18, 19, 20,
+	          21, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37,
+	          38, 39, 40, 40, 41, 42, 43, 44, 44, 45,
+	/*  42 */  0,  1,  3,  4,  5,  7,  8,  9, 11, 12, 13, 15, 16, 17, 18, 20,
+	          21, 22, 23, 24, 25, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 36,
+	          37, 38, 39, 40, 41, 41, 42, 43, 44, 44, 45,
+	/*  43 */  0,  1,  3,  4,  5,  7,  8,  9, 11, 12, 13, 14, 16, 17, 18, 19,
+	          20, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36,
+	          37, 38, 38, 39, 40, 41, 41, 42, 43, 44, 44, 45,
+	/*  44 */  0,  1,  3,  4,  5,  6,  8,  9, 10, 12, 13, 14, 15, 16, 18, 19,
+	          20, 21, 22, 23, 24, 26, 27, 28, 29, 30, 31, 32, 32, 33, 34, 35,
+	          36, 37, 38, 39, 39, 40, 41, 42, 42, 43, 44, 44, 45,
+	/*  45 */  0,  1,  3,  4,  5,  6,  8,  9, 10, 11, 13, 14, 15, 16, 17, 18,
+	          20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35,
+	          35, 36, 37, 38, 39, 39, 40, 41, 42, 42, 43, 44, 44, 45,
+	/*  46 */  0,  1,  2,  4,  5,  6,  7,  9, 10, 11, 12, 13, 15, 16, 17, 18,
+	          19, 20, 21, 22, 23, 25, 26, 27, 28, 29, 29, 30, 31, 32, 33, 34,
+	          35, 36, 36, 37, 38, 39, 40, 40, 41, 42, 42, 43, 44, 44, 45,
+	/*  47 */  0,  1,  2,  4,  5,  6,  7,  8, 10, 11, 12, 13, 14, 15, 17, 18,
+	          19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 33,
+	          34, 35, 36, 37, 37, 38, 39, 40, 40, 41, 42, 42, 43, 44, 44, 45,
+	/*  48 */  0,  1,  2,  4,  5,  6,  7,  8,  9, 11, 12, 13, 14, 15, 16, 17,
+	          18, 20, 21, 22, 23, 24, 25, 26, 27, 28, 28, 29, 30, 31, 32, 33,
+	          34, 35, 35, 36, 37, 38, 38, 39, 40, 41, 41, 42, 43, 43, 44, 44,
+	          45,
+	/*  49 */  0,  1,  2,  4,  5,  6,  7,  8,  9, 10, 12, 13, 14, 15, 16, 17,
+	          18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 31, 32,
+	          33, 34, 35, 36, 36, 37, 38, 39, 39, 40, 41, 41, 42, 43, 43, 44,
+	          44, 45,
+	/*  50 */  0,  1,  2,  3,  5,  6,  7,  8,  9, 10, 11, 12, 13, 15, 16, 17,
+	          18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 27, 28, 29, 30, 31, 32,
+	          33, 33, 34, 35, 36, 37, 37, 38, 39, 39, 40, 41, 41, 42, 43, 43,
+	          44, 44, 45,
+	/*  51 */  0,  1,  2,  3,  4,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16,
+	          17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 30, 31,
+	          32, 33, 34, 34, 35, 36, 37, 37, 38, 39, 39, 40, 41, 41, 42, 43,
+	          43, 44, 44, 45,
+	/*  52 */  0,  1,  2,  3,  4,  5,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16,
+	          17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 27, 28, 29, 30, 31,
+	          32, 32, 33, 34, 35, 35, 36, 37, 38, 38, 39, 40, 40, 41, 41, 42,
+	          43, 43, 44, 44, 45,
+	/*  53 */  0,  1,  2,  3,  4,  5,  6,  8,  9, 10, 11, 12, 13, 14, 15, 16,
+	          17, 18, 19, 20, 21, 22, 23, 23, 24, 25, 26, 27, 28, 29, 30, 30,
+	          31, 32, 33, 33, 34, 35, 36, 36, 37, 38, 38, 39, 40, 40, 41, 42,
+	          42, 43, 43, 44, 44, 45,
+	/*  54 */  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 12, 13, 14, 15, 16,
+	          17, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 27, 28, 29, 30,
+	          31, 31, 32, 33, 34, 34, 35, 36, 37, 37, 38, 39, 39, 40, 40, 41,
+	          42, 42, 43, 43, 44, 44, 45,
+	/*  55 */  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+	          16, 17, 18, 19, 20, 21, 22, 23, 24, 24, 25, 26, 27, 28, 29, 29,
+	          30, 31, 32, 32, 33, 34, 35, 35, 36, 37, 37, 38, 39, 39, 40, 41,
+	          41, 42, 42, 43, 43, 44, 44, 45,
+	/*  56 */  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+	          16, 17, 18, 19, 20, 21, 21, 22, 23, 24, 25, 26, 27, 27, 28, 29,
+	          30, 31, 31, 32, 33, 33, 34, 35, 36, 36, 37, 38, 38, 39, 39, 40,
+	          41, 41, 42, 42, 43, 43, 44, 44, 45,
+	/*  57 */  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+	          16, 17, 18, 18, 19, 20, 21, 22, 23, 24, 25, 25, 26, 27, 28, 29,
+	          29, 30, 31, 32, 32, 33, 34, 34, 35, 36, 36, 37, 38, 38, 39, 40,
+	          40, 41, 41, 42, 42, 43, 43, 44, 44, 45,
+	/*  58 */  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+	          15, 16, 17, 18, 19, 20, 21, 22, 22, 23, 24, 25, 26, 27, 27, 28,
+	          29, 30, 30, 31, 32, 33, 33, 34, 35, 35, 36, 37, 37, 38, 38, 39,
+	          40, 40, 41, 41, 42, 42, 43, 43, 44, 45, 45,
+	/*  59 */  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 11, 12, 13, 14,
+	          15, 16, 17, 18, 19, 20, 20, 21, 22, 23, 24, 25, 25, 26, 27, 28,
+	          28, 29, 30, 31, 31, 32, 33, 33, 34, 35, 35, 36, 37, 37, 38, 39,
+	          39, 40, 40, 41, 41, 42, 42, 43, 44, 44, 45, 45,
+	/*  60 */  0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  9, 10, 11, 12, 13, 14,
+	          15, 16, 17, 18, 18, 19, 20, 21, 22, 23, 23, 24, 25, 26, 27, 27,
+	          28, 29, 30, 30, 31, 32, 32, 33, 34, 34, 35, 36, 36, 37, 37, 38,
+	          39, 39, 40, 40, 41, 41, 42, 43, 43, 44, 44, 45, 45,
+	/*  61 */  0,  1,  2,  3,  4,  5,  6,  7,  7,  8,  9, 10, 11, 12, 13, 14,
+	          15, 16, 16, 17, 18, 19, 20, 21, 21, 22, 23, 24, 25, 25, 26, 27,
+	          28, 28, 29, 30, 31, 31, 32, 33, 33, 34, 35, 35, 36, 36, 37, 38,
+	          38, 39, 39, 40, 40, 41, 42, 42, 43, 43, 44, 44, 45, 45,
+	/*  62 */  0,  1,  2,  3,  4,  5,  6,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+	          14, 15, 16, 17, 18, 19, 20, 20, 21, 22, 23, 24, 24, 25, 26, 27,
+	          27, 28, 29, 29, 30, 31, 32, 32, 33, 33, 34, 35, 35, 36, 37, 37,
+	          38, 38, 39, 39, 40, 41, 41, 42, 42, 43, 43, 44, 44, 45, 45,
+	/*  63 */  0,  1,  2,  3,  4,  5,  5,  6,  7,  8,  9, 10, 11, 12, 13, 13,
+	          14, 15, 16, 17, 18, 18, 19, 20, 21, 22, 22, 23, 24, 25, 25, 26,
+	          27, 28, 28, 29, 30, 30, 31, 32, 32, 33, 34, 34, 35, 36, 36, 37,
+	          37, 38, 38, 39, 40, 40, 41, 41, 42, 42, 43, 43, 44, 44, 45, 45,
+	/*  64 */  0,  1,  2,  3,  4,  4,  5,  6,  7,  8,  9, 10, 11, 11, 12, 13,
+	          14, 15, 16, 17, 17, 18, 19, 20, 21, 21, 22, 23, 24, 24, 25, 26,
+	          27, 27, 28, 29, 29, 30, 31, 31, 32, 33, 33, 34, 35, 35, 36, 36,
+	          37, 37, 38, 39, 39, 40, 40, 41, 41, 42, 42, 43, 43, 44, 44, 45,
+	          45,
+	/*  65 */  0,  1,  2,  3,  4,  4,  5,  6,  7,  8,  9, 10, 10, 11, 12, 13,
+	          14, 15, 15, 16, 17, 18, 19, 19, 20, 21, 22, 23, 23, 24, 25, 25,
+	          26, 27, 28, 28, 29, 30, 30, 31, 32, 32, 33, 33, 34, 35, 35, 36,
+	          36, 37, 38, 38, 39, 39, 40, 40, 41, 41, 42, 42, 43, 43, 44, 44,
+	          45, 45,
+	/*  66 */  0,  1,  2,  3,  3,  4,  5,  6,  7,  8,  9,  9, 10, 11, 12, 13,
+	          14, 14, 15, 16, 17, 18, 18, 19, 20, 21, 22, 22, 23, 24, 24, 25,
+	          26, 27, 27, 28, 29, 29, 30, 31, 31, 32, 32, 33, 34, 34, 35, 35,
+	          36, 37, 37, 38, 38, 39, 39, 40, 40, 41, 41, 42, 42, 43, 43, 44,
+	          44, 45, 45,
+	/*  67 */  0,  1,  2,  3,  3,  4,  5,  6,  7,  8,  8,  9, 10, 11, 12, 13,
+	          13, 14, 15, 16, 17, 17, 18, 19, 20, 20, 21, 22, 23, 23, 24, 25,
+	          26, 26, 27, 28, 28, 29, 30, 30, 31, 31, 32, 33, 33, 34, 34, 35,
+	          36, 36, 37, 37, 38, 38, 39, 39, 40, 40, 41, 41, 42, 42, 43, 43,
+	          44, 44, 45, 45,
+	/*  68 */  0,  1,  2,  3,  3,  4,  5,  6,  7,  8,  8,  9, 10, 11, 12, 12,
+	          13, 14, 15, 16, 16, 17, 18, 19, 19, 20, 21, 22, 22, 23, 24, 25,
+	          25, 26, 27, 27, 28, 29, 29, 30, 30, 31, 32, 32, 33, 33, 34, 35,
+	          35, 36, 36, 37, 37, 38, 38, 39, 39, 40, 40, 41, 41, 42, 42, 43,
+	          43, 44, 44, 45, 45,
+	/*  69 */  0,  1,  2,  2,  3,  4,  5,  6,  7,  7,  8,  9, 10, 11, 11, 12,
+	          13, 14, 15, 15, 16, 17, 18, 18, 19, 20, 21, 21, 22, 23, 23, 24,
+	          25, 26, 26, 27, 28, 28, 29, 29, 30, 31, 31, 32, 33, 33, 34, 34,
+	          35, 35, 36, 36, 37, 38, 38, 39, 39, 40, 40, 41, 41, 41, 42, 42,
+	          43, 43, 44, 44, 45, 45,
+	/*  70 */  0,  1,  2,  2,  3,  4,  5,  6,  7,  7,  8,  9, 10, 11, 11, 12,
+	          13, 14, 14, 15, 16, 17, 17, 18, 19, 20, 20, 21, 22, 23, 23, 24,
+	          25, 25, 26, 27, 27, 28, 28, 29, 30, 30, 31, 32, 32, 33, 33, 34,
+	          34, 35, 36, 36, 37, 37, 38, 38, 39, 39, 40, 40, 41, 41, 42, 42,
+	          42, 43, 43, 44, 44, 45, 45,
+	/*  71 */  0,  1,  2,  2,  3,  4,  5,  6,  6,  7,  8,  9, 10, 10, 11, 12,
+	          13, 13, 14, 15, 16, 16, 17, 18, 19, 19, 20, 21, 22, 22, 23, 24,
+	          24, 25, 26, 26, 27, 28, 28, 29, 29, 30, 31, 31, 32, 32, 33, 34,
+	          34, 35, 35, 36, 36, 37, 37, 38, 38, 39, 39, 40, 40, 41, 41, 42,
+	          42, 42, 43, 43, 44, 44, 45, 45,
+	/*  72 */  0,  1,  2,  2,  3,  4,  5,  6,  6,  7,  8,  9,  9, 10, 11, 12,
+	          13, 13, 14, 15, 16, 16, 17, 18, 18, 19, 20, 21, 21, 22, 23, 23,
+	          24, 25, 25, 26, 27, 27, 28, 28, 29, 30, 30, 31, 31, 32, 33, 33,
+	          34, 34, 35, 35, 36, 36, 37, 37, 38, 38, 39, 39, 40, 40, 41, 41,
+	          42, 42, 43, 43, 43, 44, 44, 45, 45,
+	/*  73 */  0,  1,  2,  2,  3,  4,  5,  5,  6,  7,  8,  9,  9, 10, 11, 12,
+	          12, 13, 14, 15, 15, 16, 17, 17, 18, 19, 20, 20, 21, 22, 22, 23,
+	          24, 24, 25, 26, 26, 27, 27, 28, 29, 29, 30, 30, 31, 32, 32, 33,
+	          33, 34, 34, 35, 35, 36, 36, 37, 37, 38, 38, 39, 39, 40, 40, 41,
+	          41, 42, 42, 43, 43, 43, 44, 44, 45, 45,
+	/*  74 */  0,  1,  2,  2,  3,  4,  5,  5,  6,  7,  8,  8,  9, 10, 11, 11,
+	          12, 13, 14, 14, 15, 16, 17, 17, 18, 19, 19, 20, 21, 21, 22, 23,
+	          23, 24, 25, 25, 26, 27, 27, 28, 28, 29, 30, 30, 31, 31, 32, 32,
+	          33, 34, 34, 35, 35, 36, 36, 37, 37, 38, 38, 39, 39, 39, 40, 40,
+	          41, 41, 42, 42, 43, 43, 43, 44, 44, 45, 45,
+	/*  75 */  0,  1,  2,  2,  3,  4,  5,  5,  6,  7,  8,  8,  9, 10, 11, 11,
+	          12, 13, 13, 14, 15, 16, 16, 17, 18, 18, 19, 20, 20, 21, 22, 22,
+	          23, 24, 24, 25, 26, 26, 27, 27, 28, 29, 29, 30, 30, 31, 32, 32,
+	          33, 33, 34, 34, 35, 35, 36, 36, 37, 37, 38, 38, 39, 39, 40, 40,
+	          40, 41, 41, 42, 42, 43, 43, 43, 44, 44, 45, 45,
+	/*  76 */  0,  1,  2,  2,  3,  4,  5,  5,  6,  7,  7,  8,  9, 10, 10, 11,
+	          12, 13, 13, 14, 15, 15, 16, 17, 18, 18, 19, 20, 20, 21, 22, 22,
+	          23, 23, 24, 25, 25, 26, 27, 27, 28, 28, 29, 30, 30, 31, 31, 32,
+	          32, 33, 33, 34, 34, 35, 35, 36, 36, 37, 37, 38, 38, 39, 39, 40,
+	          40, 41, 41, 41, 42, 42, 43, 43, 43, 44, 44, 45, 45,
+	/*  77 */  0,  1,  1,  2,  3,  4,  4,  5,  6,  7,  7,  8,  9, 10, 10, 11,
+	          12, 12, 13, 14, 15, 15, 16, 17, 17, 18, 19, 19, 20, 21, 21, 22,
+	          23, 23, 24, 24, 25, 26, 26, 27, 27, 28, 29, 29, 30, 30, 31, 31,
+	          32, 32, 33, 34, 34, 35, 35, 36, 36, 37, 37, 37, 38, 38, 39, 39,
+	          40, 40, 41, 41, 41, 42, 42, 43, 43, 43, 44, 44, 45, 45,
+	/*  78 */  0,  1,  1,  2,  3,  4,  4,  5,  6,  7,  7,  8,  9,  9, 10, 11,
+	          12, 12, 13, 14, 14, 15, 16, 16, 17, 18, 18, 19, 20, 20, 21, 22,
+	          22, 23, 24, 24, 25, 25, 26, 27, 27, 28, 28, 29, 29, 30, 31, 31,
+	          32, 32, 33, 33, 34, 34, 35, 35, 36, 36, 37, 37, 38, 38, 38, 39,
+	          39, 40, 40, 41, 41, 41, 42, 42, 43, 43, 43, 44, 44, 45, 45,
+	/*  79 */  0,  1,  1,  2,  3,  4,  4,  5,  6,  6,  7,  8,  9,  9, 10, 11,
+	          11, 12, 13, 14, 14, 15, 16, 16, 17, 18, 18, 19, 20, 20, 21, 21,
+	          22, 23, 23, 24, 24, 25, 26, 26, 27, 27, 28, 29, 29, 30, 30, 31,
+	          31, 32, 32, 33, 33, 34, 34, 35, 35, 36, 36, 37, 37, 38, 38, 39,
+	          39, 39, 40, 40, 41, 41, 42, 42, 42, 43, 43, 44, 44, 44, 45, 45,
+	/*  80 */  0,  1,  1,  2,  3,  4,  4,  5,  6,  6,  7,  8,  9,  9, 10, 11,
+	          11, 12, 13, 13, 14, 15, 15, 16, 17, 17, 18, 19, 19, 20, 21, 21,
+	          22, 22, 23, 24, 24, 25, 25, 26, 27, 27, 28, 28, 29, 29, 30, 30,
+	          31, 31, 32, 33, 33, 34, 34, 35, 35, 35, 36, 36, 37, 37, 38, 38,
+	          39, 39, 40, 40, 40, 41, 41, 42, 42, 42, 43, 43, 44, 44, 44, 45,
+	          45,
+	/*  81 */  0,  1,  1,  2,  3,  4,  4,  5,  6,  6,  7,  8,  8,  9, 10, 10,
+	          11, 12, 13, 13, 14, 15, 15, 16, 17, 17, 18, 18, 19, 20, 20, 21,
+	          22, 22, 23, 23, 24, 25, 25, 26, 26, 27, 27, 28, 29, 29, 30, 30,
+	          31, 31, 32, 32, 33, 33, 34, 34, 35, 35, 36, 36, 37, 37, 37, 38,
+	          38, 39, 39, 40, 40, 40, 41, 41, 42, 42, 42, 43, 43, 44, 44, 44,
+	          45, 45,
+	/*  82 */  0,  1,  1,  2,  3,  3,  4,  5,  6,  6,  7,  8,  8,  9, 10, 10,
+	          11, 12, 12, 13, 14, 14, 15, 16, 16, 17, 18, 18, 19, 19, 20, 21,
+	          21, 22, 23, 23, 24, 24, 25, 25, 26, 27, 27, 28, 28, 29, 29, 30,
+	          30, 31, 31, 32, 32, 33, 33, 34, 34, 35, 35, 36, 36, 37, 37, 38,
+	          38, 38, 39, 39, 40, 40, 40, 41, 41, 42, 42, 42, 43, 43, 44, 44,
+	          44, 45, 45,
+	/*  83 */  0,  1,  1,  2,  3,  3,  4,  5,  6,  6,  7,  8,  8,  9, 10, 10,
+	          11, 12, 12, 13, 14, 14, 15, 15, 16, 17, 17, 18, 19, 19, 20, 20,
+	          21, 22, 22, 23, 23, 24, 25, 25, 26, 26, 27, 27, 28, 28, 29, 30,
+	          30, 31, 31, 32, 32, 33, 33, 34, 34, 34, 35, 35, 36, 36, 37, 37,
+	          38, 38, 38, 39, 39, 40, 40, 41, 41, 41, 42, 42, 42, 43, 43, 44,
+	          44, 44, 45, 45,
+	/*  84 */  0,  1,  1,  2,  3,  3,  4,  5,  5,  6,  7,  7,  8,  9,  9, 10,
+	          11, 11, 12, 13, 13, 14, 15, 15, 16, 17, 17, 18, 18, 19, 20, 20,
+	          21, 21, 22, 23, 23, 24, 24, 25, 25, 26, 27, 27, 28, 28, 29, 29,
+	          30, 30, 31, 31, 32, 32, 33, 33, 34, 34, 35, 35, 36, 36, 36, 37,
+	          37, 38, 38, 39, 39, 39, 40, 40, 41, 41, 41, 42, 42, 43, 43, 43,
+	          44, 44, 44, 45, 45,
+	/*  85 */  0,  1,  1,  2,  3,  3,  4,  5,  5,  6,  7,  7,  8,  9,  9, 10,
+	          11, 11, 12, 13, 13, 14, 15, 15, 16, 16, 17, 18, 18, 19, 19, 20,
+	          21, 21, 22, 22, 23, 24, 24, 25, 25, 26, 26, 27, 27, 28, 28, 29,
+	          29, 30, 30, 31, 31, 32, 32, 33, 33, 34, 34, 35, 35, 36, 36, 37,
+	          37, 37, 38, 38, 39, 39, 39, 40, 40, 41, 41, 41, 42, 42, 43, 43,
+	          43, 44, 44, 44, 45, 45,
+	/*  86 */  0,  1,  1,  2,  3,  3,  4,  5,  5,  6,  7,  7,  8,  9,  9, 10,
+	          11, 11, 12, 12, 13, 14, 14, 15, 16, 16, 17, 17, 18, 19, 19, 20,
+	          20, 21, 22, 22, 23, 23, 24, 24, 25, 25, 26, 27, 27, 28, 28, 29,
+	          29, 30, 30, 31, 31, 32, 32, 33, 33, 34, 34, 34, 35, 35, 36, 36,
+	          37, 37, 38, 38, 38, 39, 39, 40, 40, 40, 41, 41, 41, 42, 42, 43,
+	          43, 43, 44, 44, 44, 45, 45,
+	/*  87 */  0,  1,  1,  2,  3,  3,  4,  5,  5,  6,  7,  7,  8,  8,  9, 10,
+	          10, 11, 12, 12, 13, 14, 14, 15, 15, 16, 17, 17, 18, 18, 19, 20,
+	          20, 21, 21, 22, 22, 23, 24, 24, 25, 25, 26, 26, 27, 27, 28, 28,
+	          29, 29, 30, 30, 31, 31, 32, 32, 33, 33, 34, 34, 35, 35, 35, 36,
+	          36, 37, 37, 38, 38, 38, 39, 39, 40, 40, 40, 41, 41, 42, 42, 42,
+	          43, 43, 43, 44, 44, 44, 45, 45,
+	/*  88 */  0,  1,  1,  2,  3,  3,  4,  5,  5,  6,  6,  7,  8,  8,  9, 10,
+	          10, 11, 12, 12, 13, 13, 14, 15, 15, 16, 16, 17, 18, 18, 19, 19,
+	          20, 21, 21, 22, 22, 23, 23, 24, 24, 25, 26, 26, 27, 27, 28, 28,
+	          29, 29, 30, 30, 31, 31, 32, 32, 32, 33, 33, 34, 34, 35, 35, 36,
+	          36, 36, 37, 37, 38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 42, 42,
+	          42, 43, 43, 43, 44, 44, 44, 45, 45,
+	/*  89 */  0,  1,  1,  2,  3,  3,  4,  4,  5,  6,  6,  7,  8,  8,  9, 10,
+	          10, 11, 11, 12, 13, 13, 14, 14, 15, 16, 16, 17, 17, 18, 19, 19,
+	          20, 20, 21, 21, 22, 23, 23, 24, 24, 25, 25, 26, 26, 27, 27, 28,
+	          28, 29, 29, 30, 30, 31, 31, 32, 32, 33, 33, 34, 34, 34, 35, 35,
+	          36, 36, 37, 37, 37, 38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 42,
+	          42, 42, 43, 43, 43, 44, 44, 44, 45, 45,
+	/*  90 */  0,  1,  1,  2,  3,  3,  4,  4,  5,  6,  6,  7,  8,  8,  9,  9,
+	          10, 11, 11, 12, 13, 13, 14, 14, 15, 16, 16, 17, 17, 18, 18, 19,
+	          20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 25, 26, 26, 27, 27, 28,
+	          28, 29, 29, 30, 30, 30, 31, 31, 32, 32, 33, 33, 34, 34, 35, 35,
+	          35, 36, 36, 37, 37, 37, 38, 38, 39, 39, 39, 40, 40, 41, 41, 41,
+	          42, 42, 42, 43, 43, 43, 44, 44, 44, 45, 45,
+	/*  91 */  0,  1,  1,  2,  3,  3,  4,  4,  5,  6,  6,  7,  8,  8,  9,  9,
+	          10, 11, 11, 12, 12, 13, 14, 14, 15, 15, 16, 17, 17, 18, 18, 19,
+	          19, 20, 20, 21, 22, 22, 23, 23, 24, 24, 25, 25, 26, 26, 27, 27,
+	          28, 28, 29, 29, 30, 30, 31, 31, 32, 32, 33, 33, 33, 34, 34, 35,
+	          35, 36, 36, 36, 37, 37, 38, 38, 38, 39, 39, 39, 40, 40, 41, 41,
+	          41, 42, 42, 42, 43, 43, 43, 44, 44, 44, 45, 45,
+	/*  92 */  0,  1,  1,  2,  2,  3,  4,  4,  5,  6,  6,  7,  7,  8,  9,  9,
+	          10, 10, 11, 12, 12, 13, 13, 14, 15, 15, 16, 16, 17, 17, 18, 19,
+	          19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 25, 25, 26, 26, 27, 27,
+	          28, 28, 29, 29, 29, 30, 30, 31, 31, 32, 32, 33, 33, 34, 34, 34,
+	          35, 35, 36, 36, 36, 37, 37, 38, 38, 38, 39, 39, 40, 40, 40, 41,
+	          41, 41, 42, 42, 42, 43, 43, 43, 44, 44, 44, 45, 45,
+	/*  93 */  0,  1,  1,  2,  2,  3,  4,  4,  5,  6,  6,  7,  7,  8,  9,  9,
+	          10, 10, 11, 12, 12, 13, 13, 14, 14, 15, 16, 16, 17, 17, 18, 18,
+	          19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 25, 25, 26, 26, 27,
+	          27, 28, 28, 29, 29, 30, 30, 31, 31, 32, 32, 32, 33, 33, 34, 34,
+	          35, 35, 35, 36, 36, 37, 37, 37, 38, 38, 39, 39, 39, 40, 40, 40,
+	          41, 41, 41, 42, 42, 42, 43, 43, 43, 44, 44, 44, 45, 45,
+	/*  94 */  0,  1,  1,  2,  2,  3,  4,  4,  5,  5,  6,  7,  7,  8,  8,  9,
+	          10, 10, 11, 11, 12, 13, 13, 14, 14, 15, 15, 16, 17, 17, 18, 18,
+	          19, 19, 20, 20, 21, 21, 22, 23, 23, 24, 24, 25, 25, 26, 26, 27,
+	          27, 28, 28, 28, 29, 29, 30, 30, 31, 31, 32, 32, 33, 33, 33, 34,
+	          34, 35, 35, 35, 36, 36, 37, 37, 37, 38, 38, 39, 39, 39, 40, 40,
+	          40, 41, 41, 41, 42, 42, 42, 43, 43, 43, 44, 44, 44, 45, 45,
+	/*  95 */  0,  1,  1,  2,  2,  3,  4,  4,  5,  5,  6,  7,  7,  8,  8,  9,
+	          10, 10, 11, 11, 12, 12, 13, 14, 14, 15, 15, 16, 16, 17, 18, 18,
+	          19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 25, 25, 26, 26,
+	          27, 27, 28, 28, 29, 29, 30, 30, 31, 31, 31, 32, 32, 33, 33, 34,
+	          34, 34, 35, 35, 36, 36, 36, 37, 37, 38, 38, 38, 39, 39, 39, 40,
+	          40, 40, 41, 41, 41, 42, 42, 42, 43, 43, 43, 44, 44, 44, 45, 45,
+	/*  96 */  0,  1,  1,  2,  2,  3,  4,  4,  5,  5,  6,  7,  7,  8,  8,  9,
+	           9, 10, 11, 11, 12, 12, 13, 13, 14, 15, 15, 16, 16, 17, 17, 18,
+	          18, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 25, 25, 26, 26,
+	          27, 27, 28, 28, 28, 29, 29, 30, 30, 31, 31, 32, 32, 32, 33, 33,
+	          34, 34, 35, 35, 35, 36, 36, 36, 37, 37, 38, 38, 38, 39, 39, 39,
+	          40, 40, 41, 41, 41, 42, 42, 42, 43, 43, 43, 43, 44, 44, 44, 45,
+	          45,
+	/*  97 */  0,  1,  1,  2,  2,  3,  4,  4,  5,  5,  6,  6,  7,  8,  8,  9,
+	           9, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 16, 16, 17, 17, 18,
+	          18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 25, 25, 26,
+	          26, 27, 27, 28, 28, 29, 29, 30, 30, 30, 31, 31, 32, 32, 33, 33,
+	          33, 34, 34, 35, 35, 35, 36, 36, 37, 37, 37, 38, 38, 38, 39, 39,
+	          40, 40, 40, 41, 41, 41, 42, 42, 42, 43, 43, 43, 43, 44, 44, 44,
+	          45, 45,
+	/*  98 */  0,  1,  1,  2,  2,  3,  4,  4,  5,  5,  6,  6,  7,  8,  8,  9,
+	           9, 10, 10, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16, 16, 17, 18,
+	          18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 25, 25, 26,
+	          26, 27, 27, 27, 28, 28, 29, 29, 30, 30, 31, 31, 31, 32, 32, 33,
+	          33, 34, 34, 34, 35, 35, 36, 36, 36, 37, 37, 37, 38, 38, 39, 39,
+	          39, 40, 40, 40, 41, 41, 41, 42, 42, 42, 43, 43, 43, 44, 44, 44,
+	          44, 45, 45,
+	/*  99 */  0,  1,  1,  2,  2,  3,  3,  4,  5,  5,  6,  6,  7,  7,  8,  9,
+	           9, 10, 10, 11, 11, 12, 13, 13, 14, 14, 15, 15, 16, 16, 17, 17,
+	          18, 18, 19, 19, 20, 20, 21, 22, 22, 22, 23, 23, 24, 24, 25, 25,
+	          26, 26, 27, 27, 28, 28, 29, 29, 29, 30, 30, 31, 31, 32, 32, 32,
+	          33, 33, 34, 34, 34, 35, 35, 36, 36, 36, 37, 37, 38, 38, 38, 39,
+	          39, 39, 40, 40, 40, 41, 41, 41, 42, 42, 42, 43, 43, 43, 44, 44,
+	          44, 44, 45, 45,
+	/* 100 */  0,  1,  1,  2,  2,  3,  3,  4,  5,  5,  6,  6,  7,  7,  8,  9,
+	           9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 15, 15, 16, 16, 17, 17,
+	          18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 25, 25,
+	          26, 26, 27, 27, 27, 28, 28, 29, 29, 30, 30, 31, 31, 31, 32, 32,
+	          33, 33, 33, 34, 34, 35, 35, 35, 36, 36, 37, 37, 37, 38, 38, 38,
+	          39, 39, 39, 40, 40, 40, 41, 41, 41, 42, 42, 42, 43, 43, 43, 44,
+	          44, 44, 44, 45, 45,
+	/* 101 */  0,  1,  1,  2,  2,  3,  3,  4,  5,  5,  6,  6,  7,  7,  8,  8,
+	           9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16, 17, 17,
+	          18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 24, 25,
+	          25, 26, 26, 27, 27, 28, 28, 29, 29, 29, 30, 30, 31, 31, 32, 32,
+	          32, 33, 33, 34, 34, 34, 35, 35, 35, 36, 36, 37, 37, 37, 38, 38,
+	          38, 39, 39, 39, 40, 40, 40, 41, 41, 41, 42, 42, 42, 43, 43, 43,
+	          44, 44, 44, 44, 45, 45,
+	/* 102 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  6,  6,  7,  7,  8,  8,
+	           9,  9, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16, 16, 17,
+	          17, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 25,
+	          25, 26, 26, 27, 27, 27, 28, 28, 29, 29, 30, 30, 30, 31, 31, 32,
+	          32, 33, 33, 33, 34, 34, 34, 35, 35, 36, 36, 36, 37, 37, 37, 38,
+	          38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 41, 42, 42, 42, 43, 43,
+	          43, 44, 44, 44, 44, 45, 45,
+	/* 103 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  6,  6,  7,  7,  8,  8,
+	           9,  9, 10, 10, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16, 16, 17,
+	          17, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24, 25,
+	          25, 25, 26, 26, 27, 27, 28, 28, 29, 29, 29, 30, 30, 31, 31, 31,
+	          32, 32, 33, 33, 33, 34, 34, 35, 35, 35, 36, 36, 36, 37, 37, 37,
+	          38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 41, 41, 42, 42, 42, 43,
+	          43, 43, 44, 44, 44, 44, 45, 45,
+	/* 104 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  7,  7,  8,  8,
+	           9,  9, 10, 10, 11, 11, 12, 12, 13, 14, 14, 15, 15, 16, 16, 17,
+	          17, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 22, 23, 23, 24, 24,
+	          25, 25, 26, 26, 27, 27, 27, 28, 28, 29, 29, 30, 30, 30, 31, 31,
+	          32, 32, 32, 33, 33, 34, 34, 34, 35, 35, 35, 36, 36, 37, 37, 37,
+	          38, 38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 41, 41, 42, 42, 42,
+	          43, 43, 43, 44, 44, 44, 44, 45, 45,
+	/* 105 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  7,  7,  8,  8,
+	           9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16, 16,
+	          17, 17, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24, 24,
+	          25, 25, 25, 26, 26, 27, 27, 28, 28, 28, 29, 29, 30, 30, 31, 31,
+	          31, 32, 32, 33, 33, 33, 34, 34, 34, 35, 35, 36, 36, 36, 37, 37,
+	          37, 38, 38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 41, 42, 42, 42,
+	          42, 43, 43, 43, 44, 44, 44, 44, 45, 45,
+	/* 106 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  8,  8,
+	           9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16, 16,
+	          17, 17, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 23, 24,
+	          24, 25, 25, 26, 26, 27, 27, 27, 28, 28, 29, 29, 30, 30, 30, 31,
+	          31, 32, 32, 32, 33, 33, 33, 34, 34, 35, 35, 35, 36, 36, 36, 37,
+	          37, 37, 38, 38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 41, 42, 42,
+	          42, 42, 43, 43, 43, 44, 44, 44, 44, 45, 45,
+	/* 107 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,  8,
+	           9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16, 16,
+	          17, 17, 18, 18, 19, 19, 20, 20, 20, 21, 21, 22, 22, 23, 23, 24,
+	          24, 25, 25, 25, 26, 26, 27, 27, 28, 28, 28, 29, 29, 30, 30, 30,
+	          31, 31, 32, 32, 32, 33, 33, 34, 34, 34, 35, 35, 35, 36, 36, 36,
+	          37, 37, 37, 38, 38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 41, 42,
+	          42, 42, 42, 43, 43, 43, 44, 44, 44, 44, 45, 45,
+	/* 108 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,  8,
+	           8,  9,  9, 10, 10, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16, 16,
+	          17, 17, 17, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23, 24,
+	          24, 24, 25, 25, 26, 26, 27, 27, 27, 28, 28, 29, 29, 29, 30, 30,
+	          31, 31, 31, 32, 32, 33, 33, 33, 34, 34, 34, 35, 35, 35, 36, 36,
+	          37, 37, 37, 38, 38, 38, 39, 39, 39, 39, 40, 40, 40, 41, 41, 41,
+	          42, 42, 42, 43, 43, 43, 43, 44, 44, 44, 44, 45, 45,
+	/* 109 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,  8,
+	           8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16,
+	          16, 17, 17, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 22, 23, 23,
+	          24, 24, 25, 25, 26, 26, 26, 27, 27, 28, 28, 28, 29, 29, 30, 30,
+	          30, 31, 31, 32, 32, 32, 33, 33, 33, 34, 34, 35, 35, 35, 36, 36,
+	          36, 37, 37, 37, 38, 38, 38, 39, 39, 39, 40, 40, 40, 40, 41, 41,
+	          41, 42, 42, 42, 43, 43, 43, 43, 44, 44, 44, 44, 45, 45,
+	/* 110 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,  8,
+	           8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16,
+	          16, 17, 17, 18, 18, 19, 19, 20, 20, 20, 21, 21, 22, 22, 23, 23,
+	          24, 24, 24, 25, 25, 26, 26, 27, 27, 27, 28, 28, 29, 29, 29, 30,
+	          30, 31, 31, 31, 32, 32, 32, 33, 33, 34, 34, 34, 35, 35, 35, 36,
+	          36, 36, 37, 37, 37, 38, 38, 38, 39, 39, 39, 40, 40, 40, 41, 41,
+	          41, 41, 42, 42, 42, 43, 43, 43, 43, 44, 44, 44, 44, 45, 45,
+	/* 111 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,  8,
+	           8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 16,
+	          16, 17, 17, 18, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 23, 23,
+	          23, 24, 24, 25, 25, 26, 26, 26, 27, 27, 28, 28, 28, 29, 29, 30,
+	          30, 30, 31, 31, 31, 32, 32, 33, 33, 33, 34, 34, 34, 35, 35, 35,
+	          36, 36, 36, 37, 37, 37, 38, 38, 38, 39, 39, 39, 40, 40, 40, 41,
+	          41, 41, 41, 42, 42, 42, 43, 43, 43, 43, 44, 44, 44, 44, 45, 45,
+	/* 112 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,  8,
+	           8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15, 15,
+	          16, 16, 17, 17, 18, 18, 19, 19, 20, 20, 21, 21, 21, 22, 22, 23,
+	          23, 24, 24, 24, 25, 25, 26, 26, 27, 27, 27, 28, 28, 29, 29, 29,
+	          30, 30, 31, 31, 31, 32, 32, 32, 33, 33, 33, 34, 34, 35, 35, 35,
+	          36, 36, 36, 37, 37, 37, 38, 38, 38, 38, 39, 39, 39, 40, 40, 40,
+	          41, 41, 41, 41, 42, 42, 42, 43, 43, 43, 43, 44, 44, 44, 44, 45,
+	          45,
+	/* 113 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,  8,
+	           8,  9,  9, 10, 10, 11, 11, 12, 12, 12, 13, 13, 14, 14, 15, 15,
+	          16, 16, 17, 17, 18, 18, 19, 19, 19, 20, 20, 21, 21, 22, 22, 23,
+	          23, 23, 24, 24, 25, 25, 26, 26, 26, 27, 27, 28, 28, 28, 29, 29,
+	          30, 30, 30, 31, 31, 31, 32, 32, 33, 33, 33, 34, 34, 34, 35, 35,
+	          35, 36, 36, 36, 37, 37, 37, 38, 38, 38, 39, 39, 39, 39, 40, 40,
+	          40, 41, 41, 41, 42, 42, 42, 42, 43, 43, 43, 43, 44, 44, 44, 44,
+	          45, 45,
+	/* 114 */  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,  7,
+	           8,  8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15,
+	          16, 16, 17, 17, 18, 18, 18, 19, 19, 20, 20, 21, 21, 22, 22, 22,
+	          23, 23, 24, 24, 25, 25, 25, 26, 26, 27, 27, 27, 28, 28, 29, 29,
+	          29, 30, 30, 30, 31, 31, 32, 32, 32, 33, 33, 33, 34, 34, 34, 35,
+	          35, 35, 36, 36, 36, 37, 37, 37, 38, 38, 38, 39, 39, 39, 40, 40,
+	          40, 40, 41, 41, 41, 42, 42, 42, 42, 43, 43, 43, 43, 44, 44, 44,
+	          44, 45, 45,
+	/* 115 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,
+	           8,  8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15,
+	          16, 16, 16, 17, 17, 18, 18, 19, 19, 20, 20, 21, 21, 21, 22, 22,
+	          23, 23, 23, 24, 24, 25, 25, 26, 26, 26, 27, 27, 28, 28, 28, 29,
+	          29, 29, 30, 30, 31, 31, 31, 32, 32, 32, 33, 33, 33, 34, 34, 34,
+	          35, 35, 35, 36, 36, 36, 37, 37, 37, 38, 38, 38, 39, 39, 39, 40,
+	          40, 40, 40, 41, 41, 41, 42, 42, 42, 42, 43, 43, 43, 43, 44, 44,
+	          44, 44, 45, 45,
+	/* 116 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,
+	           8,  8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15,
+	          15, 16, 16, 17, 17, 18, 18, 19, 19, 19, 20, 20, 21, 21, 22, 22,
+	          22, 23, 23, 24, 24, 25, 25, 25, 26, 26, 27, 27, 27, 28, 28, 29,
+	          29, 29, 30, 30, 30, 31, 31, 31, 32, 32, 33, 33, 33, 34, 34, 34,
+	          35, 35, 35, 36, 36, 36, 37, 37, 37, 37, 38, 38, 38, 39, 39, 39,
+	          40, 40, 40, 40, 41, 41, 41, 42, 42, 42, 42, 43, 43, 43, 43, 44,
+	          44, 44, 45, 45, 45,
+	/* 117 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,
+	           8,  8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 13, 14, 14, 15,
+	          15, 16, 16, 17, 17, 18, 18, 18, 19, 19, 20, 20, 21, 21, 21, 22,
+	          22, 23, 23, 24, 24, 24, 25, 25, 26, 26, 26, 27, 27, 28, 28, 28,
+	          29, 29, 29, 30, 30, 31, 31, 31, 32, 32, 32, 33, 33, 33, 34, 34,
+	          34, 35, 35, 35, 36, 36, 36, 37, 37, 37, 38, 38, 38, 38, 39, 39,
+	          39, 40, 40, 40, 41, 41, 41, 41, 42, 42, 42, 42, 43, 43, 43, 43,
+	          44, 44, 44, 45, 45, 45,
+	/* 118 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,
+	           8,  8,  9,  9, 10, 10, 11, 11, 11, 12, 12, 13, 13, 14, 14, 15,
+	          15, 16, 16, 17, 17, 17, 18, 18, 19, 19, 20, 20, 20, 21, 21, 22,
+	          22, 23, 23, 23, 24, 24, 25, 25, 25, 26, 26, 27, 27, 27, 28, 28,
+	          28, 29, 29, 30, 30, 30, 31, 31, 31, 32, 32, 32, 33, 33, 33, 34,
+	          34, 34, 35, 35, 35, 36, 36, 36, 37, 37, 37, 38, 38, 38, 39, 39,
+	          39, 39, 40, 40, 40, 41, 41, 41, 41, 42, 42, 42, 42, 43, 43, 43,
+	          44, 44, 44, 44, 45, 45, 45,
+	/* 119 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,
+	           8,  8,  9,  9, 10, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15,
+	          15, 15, 16, 16, 17, 17, 18, 18, 19, 19, 19, 20, 20, 21, 21, 22,
+	          22, 22, 23, 23, 24, 24, 24, 25, 25, 26, 26, 26, 27, 27, 28, 28,
+	          28, 29, 29, 29, 30, 30, 30, 31, 31, 32, 32, 32, 33, 33, 33, 34,
+	          34, 34, 35, 35, 35, 36, 36, 36, 36, 37, 37, 37, 38, 38, 38, 39,
+	          39, 39, 39, 40, 40, 40, 41, 41, 41, 41, 42, 42, 42, 42, 43, 43,
+	          43, 44, 44, 44, 44, 45, 45, 45,
+	/* 120 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,
+	           8,  8,  9,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 14,
+	          15, 15, 16, 16, 17, 17, 18, 18, 18, 19, 19, 20, 20, 21, 21, 21,
+	          22, 22, 23, 23, 23, 24, 24, 25, 25, 25, 26, 26, 27, 27, 27, 28,
+	          28, 28, 29, 29, 30, 30, 30, 31, 31, 31, 32, 32, 32, 33, 33, 33,
+	          34, 34, 34, 35, 35, 35, 36, 36, 36, 37, 37, 37, 37, 38, 38, 38,
+	          39, 39, 39, 40, 40, 40, 40, 41, 41, 41, 41, 42, 42, 42, 43, 43,
+	          43, 43, 44, 44, 44, 44, 45, 45, 45,
+	/* 121 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,
+	           8,  8,  8,  9,  9, 10, 10, 11, 11, 12, 12, 13, 13, 13, 14, 14,
+	          15, 15, 16, 16, 17, 17, 17, 18, 18, 19, 19, 20, 20, 20, 21, 21,
+	          22, 22, 22, 23, 23, 24, 24, 24, 25, 25, 26, 26, 26, 27, 27, 28,
+	          28, 28, 29, 29, 29, 30, 30, 30, 31, 31, 31, 32, 32, 32, 33, 33,
+	          33, 34, 34, 34, 35, 35, 35, 36, 36, 36, 37, 37, 37, 38, 38, 38,
+	          38, 39, 39, 39, 40, 40, 40, 40, 41, 41, 41, 41, 42, 42, 42, 43,
+	          43, 43, 43, 44, 44, 44, 44, 45, 45, 45,
+	/* 122 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  7,  7,
+	           7,  8,  8,  9,  9, 10, 10, 11, 11, 12, 12, 12, 13, 13, 14, 14,
+	          15, 15, 16, 16, 16, 17, 17, 18, 18, 19, 19, 19, 20, 20, 21, 21,
+	          21, 22, 22, 23, 23, 23, 24, 24, 25, 25, 25, 26, 26, 27, 27, 27,
+	          28, 28, 28, 29, 29, 29, 30, 30, 31, 31, 31, 32, 32, 32, 33, 33,
+	          33, 34, 34, 34, 35, 35, 35, 35, 36, 36, 36, 37, 37, 37, 38, 38,
+	          38, 38, 39, 39, 39, 40, 40, 40, 40, 41, 41, 41, 42, 42, 42, 42,
+	          43, 43, 43, 43, 44, 44, 44, 44, 45, 45, 45,
+	/* 123 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  6,  7,
+	           7,  8,  8,  9,  9, 10, 10, 11, 11, 11, 12, 12, 13, 13, 14, 14,
+	          15, 15, 15, 16, 16, 17, 17, 18, 18, 18, 19, 19, 20, 20, 21, 21,
+	          21, 22, 22, 23, 23, 23, 24, 24, 24, 25, 25, 26, 26, 26, 27, 27,
+	          27, 28, 28, 29, 29, 29, 30, 30, 30, 31, 31, 31, 32, 32, 32, 33,
+	          33, 33, 34, 34, 34, 35, 35, 35, 36, 36, 36, 36, 37, 37, 37, 38,
+	          38, 38, 39, 39, 39, 39, 40, 40, 40, 40, 41, 41, 41, 42, 42, 42,
+	          42, 43, 43, 43, 43, 44, 44, 44, 44, 45, 45, 45,
+	/* 124 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  6,  6,  6,  7,
+	           7,  8,  8,  9,  9, 10, 10, 11, 11, 11, 12, 12, 13, 13, 14, 14,
+	          14, 15, 15, 16, 16, 17, 17, 17, 18, 18, 19, 19, 20, 20, 20, 21,
+	          21, 22, 22, 22, 23, 23, 24, 24, 24, 25, 25, 25, 26, 26, 27, 27,
+	          27, 28, 28, 28, 29, 29, 29, 30, 30, 30, 31, 31, 32, 32, 32, 33,
+	          33, 33, 33, 34, 34, 34, 35, 35, 35, 36, 36, 36, 37, 37, 37, 37,
+	          38, 38, 38, 39, 39, 39, 39, 40, 40, 40, 41, 41, 41, 41, 42, 42,
+	          42, 42, 43, 43, 43, 43, 44, 44, 44, 44, 45, 45, 45,
+	/* 125 */  0,  0,  1,  1,  2,  2,  3,  3,  4,  4,  5,  5,  5,  6,  6,  7,
+	           7,  8,  8,  9,  9, 10, 10, 10, 11, 11, 12, 12, 13, 13, 13, 14,
+	          14, 15, 15, 16, 16, 16, 17, 17, 18, 18, 19, 19, 19, 20, 20, 21,
+	          21, 21, 22, 22, 23, 23, 23, 24, 24, 25, 25, 25, 26, 26, 26, 27,
+	          27, 27, 28, 28, 29, 29, 29, 30, 30, 30, 31, 31, 31, 32, 32, 32,
+	          33, 33, 33, 34, 34, 34, 35, 35, 35, 35, 36, 36, 36, 37, 37, 37,
+	          38, 38, 38, 38, 39, 39, 39, 39, 40, 40, 40, 41, 41, 41, 41, 42,
+	          42, 42, 42, 43, 43, 43, 43, 44, 44, 44, 44, 45, 45, 45
+};
@@ -76,6 +76,15 @@ identified are necessarily the best available for the purpose.
 #cat:                        single probe fingerprint is to be matched
 #cat:                        to a single gallery fingerprint as in
 #cat:                        verificaiton mode
+#cat: bozorth_*_ctx -        variants of the above that work on a caller
+#cat:                        supplied match context instead of the shared
+#cat:                        default one, allowing concurrent matches
+#cat: bz_gallery_tmpl_new -  compiles the pairwise minutia comparison
+#cat:                        table of a gallery fingerprint once, so that it
+#cat:                        can be matched repeatedly without rebuilding it,
+#cat:                        along with its edge signature
+#cat: bozorth_to_gallery_tmpl_ctx - as bozorth_to_gallery_ctx, taking the
+#cat:                        gallery table from a compiled template
 
 ***********************************************************************/
 
@@ -86,7 +95,7 @@ identified are necessarily the best available for the purpose.
 
 /**************************************************************************/
 
-int bozorth_probe_init( struct xyt_struct * pstruct )
+int bozorth_probe_init_ctx( struct bz_ctx * ctx, struct xyt_packed * pstruct )
 {
 int sim;	/* number of pointwise comparisons for Subject's record*/
 int msim;	/* Pruned length of Subject's comparison pointer list */
@@ -97,18 +106,18 @@ int msim;	/* Pruned length of Subject's comparison pointer list */
 /* This builds a "Web" of relative edge statistics between points. */
 bz_comp(
 	pstruct->nrows,
-	pstruct->xcol,
-	pstruct->ycol,
-	pstruct->thetacol,
+	XYT_PACKED_X(pstruct),
+	XYT_PACKED_Y(pstruct),
+	XYT_PACKED_T(pstruct),
 	&sim,
-	scols,
-	scolpt );
+	ctx->scols,
+	ctx->scolpt );
 
 msim = sim;	/* Init search to end of Subject's pointwise comparison table (last edge in Web) */
 
 
 
-bz_find( &msim, scolpt );
+bz_find( &msim, ctx->scolpt );
 
 
 
@@ -124,7 +133,7 @@ return msim;
 
 /**************************************************************************/
 
-int bozorth_gallery_init( struct xyt_struct * gstruct )
+int bozorth_gallery_init_ctx( struct bz_ctx * ctx, struct xyt_packed * gstruct )
 {
 int fim;	/* number of pointwise comparisons for On-File record*/
 int mfim;	/* Pruned length of On-File Record's pointer list */
@@ -134,18 +143,18 @@ int mfim;	/* Pruned length of On-File Record's pointer list */
 /* This builds a "Web" of relative edge statistics between points. */
 bz_comp(
 	gstruct->nrows,
-	gstruct->xcol,
-	gstruct->ycol,
-	gstruct->thetacol,
+	XYT_PACKED_X(gstruct),
+	XYT_PACKED_Y(gstruct),
+	XYT_PACKED_T(gstruct),
 	&fim,
-	fcols,
-	fcolpt );
+	ctx->fcols,
+	ctx->fcolpt );
 
 mfim = fim;	/* Init search to end of On-File Record's pointwise comparison table (last edge in Web) */
 
 
 
-bz_find( &mfim, fcolpt );
+bz_find( &mfim, ctx->fcolpt );
 
 
 
@@ -161,25 +170,81 @@ return mfim;
 
 /**************************************************************************/
 
-int bozorth_to_gallery(
+int bozorth_to_gallery_ctx(
+		struct bz_ctx * ctx,
 		int probe_len,
-		struct xyt_struct * pstruct,
-		struct xyt_struct * gstruct
+		struct xyt_packed * pstruct,
+		struct xyt_packed * gstruct
 		)
 {
 int np;
 int gallery_len;
 
-gallery_len = bozorth_gallery_init( gstruct );
-np = bz_match( probe_len, gallery_len );
-return bz_match_score( np, pstruct, gstruct );
+gallery_len = bozorth_gallery_init_ctx( ctx, gstruct );
+np = bz_match_ctx( ctx, probe_len, gallery_len );
+return bz_match_score_ctx( ctx, np, pstruct, gstruct );
 }
 
 /**************************************************************************/
+/* returns BZ_GALLERY_TMPL_NULL on error */
+struct bz_gallery_tmpl * bz_gallery_tmpl_new(
+		struct bz_ctx * ctx,
+		struct xyt_packed * gstruct
+		)
+{
+struct bz_gallery_tmpl * tmpl;
+int mfim;	/* Pruned length of On-File Record's pointer list */
+int nrows;	/* Rows allocated for the template, at least one */
+int i, j;
 
-int bozorth_main(
-		struct xyt_struct * pstruct,
-		struct xyt_struct * gstruct
+
+/* Build the Web in the context's scratch tables, then keep only the */
+/* pruned, sorted rows that bz_match() will look at.                 */
+mfim = bozorth_gallery_init_ctx( ctx, gstruct );
+nrows = ( mfim > 0 ) ? mfim : 1;
+
+tmpl = (struct bz_gallery_tmpl *) malloc_or_return_error(
+			(int) ( sizeof(struct bz_gallery_tmpl)
+			+ nrows * sizeof(short [ COLS_SIZE_2 ]) ),
+			"gallery template" );
+if ( tmpl == BZ_GALLERY_TMPL_NULL )
+	return BZ_GALLERY_TMPL_NULL;
+
+tmpl->len  = mfim;
+tmpl->rows = (short (*)[ COLS_SIZE_2 ]) ( tmpl + 1 );
+
+for ( i = 0; i < mfim; i++ )
+	for ( j = 0; j < COLS_SIZE_2; j++ )
+		tmpl->rows[i][j] = (short) ctx->fcolpt[i][j];
+
+/* The signature is only needed by prefilters, which build it on demand */
+tmpl->sig = (unsigned char *) NULL;
+
+return tmpl;
+}
+
+/**************************************************************************/
+
+int bozorth_to_gallery_tmpl_ctx(
+		struct bz_ctx * ctx,
+		int probe_len,
+		struct xyt_packed * pstruct,
+		struct xyt_packed * gstruct,
+		struct bz_gallery_tmpl * tmpl
+		)
+{
+int np;
+
+np = bz_match_tmpl_ctx( ctx, probe_len, tmpl );
+return bz_match_score_ctx( ctx, np, pstruct, gstruct );
+}
+
+/**************************************************************************/
+
+int bozorth_main_ctx(
+		struct bz_ctx * ctx,
+		struct xyt_packed * pstruct,
+		struct xyt_packed * gstruct
 		)
 {
 int ms;
@@ -192,26 +257,26 @@ int gallery_len;
 #ifdef DEBUG
 	printf( "PROBE_INIT() called\n" );
 #endif
-probe_len   = bozorth_probe_init( pstruct );
+probe_len   = bozorth_probe_init_ctx( ctx, pstruct );
 
 
 #ifdef DEBUG
 	printf( "GALLERY_INIT() called\n" );
 #endif
-gallery_len = bozorth_gallery_init( gstruct );
+gallery_len = bozorth_gallery_init_ctx( ctx, gstruct );
 
 
 #ifdef DEBUG
 	printf( "BZ_MATCH() called\n" );
 #endif
-np = bz_match( probe_len, gallery_len );
+np = bz_match_ctx( ctx, probe_len, gallery_len );
 
 
 #ifdef DEBUG
 	printf( "BZ_MATCH() returned %d edge pairs\n", np );
 	printf( "COMPUTE() called\n" );
 #endif
-ms = bz_match_score( np, pstruct, gstruct );
+ms = bz_match_score_ctx( ctx, np, pstruct, gstruct );
 
 
 #ifdef DEBUG
@@ -221,3 +286,55 @@ ms = bz_match_score( np, pstruct, gstruct );
 
 return ms;
 }
+
+/**************************************************************************/
+/* Context-less entry points, operating on the shared default context */
+/* and taking fixed-size XYT structures                               */
+/**************************************************************************/
+
+int bozorth_probe_init( struct xyt_struct * pstruct )
+{
+struct xyt_packed p;
+
+xyt_to_packed( pstruct, &p );
+return bozorth_probe_init_ctx( &bz_default_ctx, &p );
+}
+
+/**************************************************************************/
+
+int bozorth_gallery_init( struct xyt_struct * gstruct )
+{
+struct xyt_packed g;
+
+xyt_to_packed( gstruct, &g );
+return bozorth_gallery_init_ctx( &bz_default_ctx, &g );
+}
+
+/**************************************************************************/
+
+int bozorth_to_gallery(
+		int probe_len,
+		struct xyt_struct * pstruct,
+		struct xyt_struct * gstruct
+		)
+{
+struct xyt_packed p, g;
+
+xyt_to_packed( pstruct, &p );
+xyt_to_packed( gstruct, &g );
+return bozorth_to_gallery_ctx( &bz_default_ctx, probe_len, &p, &g );
+}
+
+/**************************************************************************/
+
+int bozorth_main(
+		struct xyt_struct * pstruct,
+		struct xyt_struct * gstruct
+		)
+{
+struct xyt_packed p, g;
+
+xyt_to_packed( pstruct, &p );
+xyt_to_packed( gstruct, &g );
+return bozorth_main_ctx( &bz_default_ctx, &p, &g );
+}
@@ -87,6 +87,8 @@ identified are necessarily the best available for the purpose.
 #cat:            specified
 #cat: bz_load -  loads the contents of the specified XYT file into
 #cat:            structured memory
+#cat: xyt_to_packed - converts a fixed-size XYT structure into the
+#cat:            variable-length form taken by the matcher
 #cat: fd_readable - when multiple bozorth processes are being run
 #cat:            concurrently and one of the processes determines a
 #cat:            has been found, the other processes poll a file
@@ -600,6 +602,21 @@ if ( verbose_load )
 return s;
 }
 
+/***********************************************************************/
+/* The caller provides a full-size packed structure; only the first */
+/* XYT_PACKED_SIZE( xyt->nrows ) bytes of it are written.            */
+void xyt_to_packed( struct xyt_struct * xyt, struct xyt_packed * packed )
+{
+int i;
+
+packed->nrows = (short) xyt->nrows;
+for ( i = 0; i < xyt->nrows; i++ ) {
+	XYT_PACKED_X(packed)[i] = (short) xyt->xcol[i];
+	XYT_PACKED_Y(packed)[i] = (short) xyt->ycol[i];
+	XYT_PACKED_T(packed)[i] = (short) xyt->thetacol[i];
+}
+}
+
 /***********************************************************************/
 #ifdef PARALLEL_SEARCH
 int fd_readable( int fd )
@@ -0,0 +1,174 @@
+/*******************************************************************************
+
+License: 
+This software was developed at the National Institute of Standards and 
+Technology (NIST) by employees of the Federal Government in the course 
+of their official duties. Pursuant to title 17 Section 105 of the 
+United States Code, this software is not subject to copyright protection 
+and is in the public domain. NIST assumes no responsibility  whatsoever for 
+its use by other parties, and makes no guarantees, expressed or implied, 
+about its quality, reliability, or any other characteristic. 
+
+Disclaimer: 
+This software was developed to promote biometric standards and biometric
+technology testing for the Federal Government in accordance with the USA
+PATRIOT Act and the Enhanced Border Security and Visa Entry Reform Act.
+Specific hardware and software products identified in this software were used
+in order to perform the software development.  In no case does such
+identification imply recommendation or endorsement by the National Institute
+of Standards and Technology, nor does it imply that the products and equipment
+identified are necessarily the best available for the purpose.  
+
+*******************************************************************************/
+
+/***********************************************************************
+      LIBRARY: FING - NIST Fingerprint Systems Utilities
+
+      FILE:           BZ_SIG.C
+
+      Contains routines that let a gallery fingerprint be rejected
+      cheaply before it is matched with bz_match().
+
+      The signature of a gallery template has one bit for each cell of
+      a grid over the { distance, beta_1, beta_2 } values of the
+      pairwise comparison rows, set when a row falls into the cell.
+      Distance cells grow by a factor 1.25 in squared distance, and
+      beta cells are 11.25 degrees wide, so any two rows that
+      bz_match() finds compatible fall into the same or neighbouring
+      cells. A Subject edge whose own cell and neighbours are all clear
+      therefore has no compatible edge in the gallery, and the number
+      of Subject edges that do not is an upper bound on the Subject
+      edges that can take part in a match.
+
+***********************************************************************
+
+      ROUTINES:
+#cat: bz_sig_new - allocates and computes the edge signature of a
+#cat:                gallery template
+#cat: bz_sig_cells_near - lists the cell of a pairwise comparison row
+#cat:                and its neighbouring cells
+#cat: bz_sig_hits -  counts the Subject's edges that fall into or next to
+#cat:                cells set in the signature of a gallery template
+
+***********************************************************************/
+
+#include <string.h>
+#include <bozorth.h>
+
+/***********************************************************************/
+static int bz_sig_dist_bin( int distance )
+{
+int bin;
+
+if ( distance < 1 )
+	return 0;
+bin = (int) ( logf( (float) distance ) / logf( 1.25F ) );
+return ( bin < BZ_SIG_DIST_BINS - 1 ) ? bin : BZ_SIG_DIST_BINS - 1;
+}
+
+/***********************************************************************/
+static int bz_sig_beta_bin( int beta )
+{
+/* beta is in the range ( -180, 180 ]; 180 shares the cell of -180 */
+return ( ( beta + 180 ) * BZ_SIG_BETA_BINS / 360 ) % BZ_SIG_BETA_BINS;
+}
+
+/***********************************************************************/
+static int bz_sig_cell( int dbin, int b1bin, int b2bin )
+{
+return ( dbin * BZ_SIG_BETA_BINS + b1bin ) * BZ_SIG_BETA_BINS + b2bin;
+}
+
+/***********************************************************************/
+/* Return value is a signature of BZ_SIG_SIZE bytes, to be released   */
+/* with free(), or NULL if it could not be allocated. It is not stored */
+/* into the template, so that callers sharing the template between    */
+/* threads can publish it as they see fit.                             */
+/***********************************************************************/
+unsigned char * bz_sig_new(
+	struct bz_gallery_tmpl * tmpl	/* INPUT: template whose signature is computed */
+	)
+{
+int i;
+int cell;
+short * row;
+unsigned char * sig;
+
+sig = (unsigned char *) malloc_or_return_error( BZ_SIG_SIZE, "edge signature" );
+if ( sig == (unsigned char *) NULL )
+	return sig;
+memset( sig, 0, BZ_SIG_SIZE );
+
+for ( i = 0; i < tmpl->len; i++ ) {
+	row  = tmpl->rows[i];
+	cell = bz_sig_cell( bz_sig_dist_bin( row[0] ),
+			bz_sig_beta_bin( row[1] ),
+			bz_sig_beta_bin( row[2] ) );
+	sig[ cell >> 3 ] |= (unsigned char) ( 1 << ( cell & 7 ) );
+}
+return sig;
+}
+
+/***********************************************************************/
+/* Return value is the # of cells stored into cells[]: the cell of the */
+/* pairwise comparison row and its neighbours                          */
+/***********************************************************************/
+int bz_sig_cells_near(
+	int * row,			/* INPUT:  pairwise comparison row */
+	int cells[ BZ_SIG_NEAR ]	/* OUTPUT: cells near the row */
+	)
+{
+int dd, d1, d2;		/* Offsets to neighbouring cells */
+int dbin, b1bin, b2bin;
+int d, b1, b2;
+int n;
+
+dbin  = bz_sig_dist_bin( row[0] );
+b1bin = bz_sig_beta_bin( row[1] );
+b2bin = bz_sig_beta_bin( row[2] );
+
+n = 0;
+for ( dd = -1; dd <= 1; dd++ ) {
+	d = dbin + dd;
+	if ( d < 0 || d >= BZ_SIG_DIST_BINS )
+		continue;
+	for ( d1 = -1; d1 <= 1; d1++ ) {
+		b1 = ( b1bin + d1 + BZ_SIG_BETA_BINS ) % BZ_SIG_BETA_BINS;
+		for ( d2 = -1; d2 <= 1; d2++ ) {
+			b2 = ( b2bin + d2 + BZ_SIG_BETA_BINS ) % BZ_SIG_BETA_BINS;
+			cells[n++] = bz_sig_cell( d, b1, b2 );
+		}
+	}
+}
+return n;
+}
+
+/***********************************************************************/
+/* Return value is the # of the Subject's edges, among those bz_match() */
+/* would look at, that fall into a set cell of the gallery signature    */
+/***********************************************************************/
+int bz_sig_hits(
+	struct bz_ctx * ctx,		/* INPUT:  match context holding the Subject's Web */
+	int probe_ptrlist_len,		/* INPUT:  pruned length of Subject's pointer list */
+	const unsigned char * sig	/* INPUT:  signature of the On-File Record */
+	)
+{
+int k;
+int i;
+int n;
+int hits;
+int cells[ BZ_SIG_NEAR ];
+
+hits = 0;
+for ( k = 1; k < probe_ptrlist_len; k++ ) {
+	n = bz_sig_cells_near( ctx->scolpt[k-1], cells );
+	for ( i = 0; i < n; i++ ) {
+		if ( sig[ cells[i] >> 3 ] & ( 1 << ( cells[i] & 7 ) ) ) {
+			hits++;
+			break;
+		}
+	}
+}
+
+return hits;
+}
@@ -69,6 +69,9 @@ identified are necessarily the best available for the purpose.
 #cat: sort_x_y - comparison function passed to stdlib qsort() used
 #cat:            to sort minutia coordinates increasing first on x
 #cat:            then on y
+#cat: sort_colptrs - comparison function passed to stdlib qsort() used
+#cat:            to sort pointers to rows of a pairwise comparison table
+#cat:            on distance, then on the two beta angles
 #cat: sort_order_decreasing - calls a custom quicksort that sorts
 #cat:            a list of integers in decreasing order
 
@@ -118,6 +121,32 @@ if ( af->col[1] > bf->col[1] )
 return 0;
 }
 
+/***********************************************************************/
+/* Rows that compare equal keep their order in the table, so that the */
+/* result is the same as inserting the rows one by one in table order. */
+int sort_colptrs( const void * a, const void * b )
+{
+const int * ar;
+const int * br;
+int i;
+
+ar = *(int * const *) a;
+br = *(int * const *) b;
+
+for ( i = 0; i < 3; i++ ) {
+	if ( ar[i] < br[i] )
+		return -1;
+	if ( ar[i] > br[i] )
+		return 1;
+}
+
+if ( ar < br )
+	return -1;
+if ( ar > br )
+	return 1;
+return 0;
+}
+
 /********************************************************
 qsort_decreasing() - quicksort an array of integers in decreasing
                      order [based on multisort.c, by Michael Garris
@@ -31,6 +31,7 @@ identified are necessarily the best available for the purpose.
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h> /* Needed for offsetof() */
 #include <sys/types.h>
 #include <unistd.h> /* Needed for type pid_t */
 #include <errno.h>
@@ -118,6 +119,9 @@ extern float atanf( float );
 
 #define QQ_SIZE 4000
 
+/* Entries in bz_atan_table[]: the first octant for dx, dy = 0..DM */
+#define BZ_ATAN_TABLE_SIZE	( ( DM + 1 ) * ( DM + 2 ) / 2 )
+
 #define QQ_OVERFLOW_SCORE QQ_SIZE
 
 /**************************************************************************/
@@ -176,6 +180,94 @@ struct xyt_struct {
 
 #define XYT_NULL ( (struct xyt_struct *) NULL ) /* bz_load() */
 
+/* Variable-length form of xyt_struct used by the matcher and stored in  */
+/* libfprint prints: the row count followed by the x, y and theta        */
+/* columns, each nrows long.  Only XYT_PACKED_SIZE( nrows ) bytes need   */
+/* to be allocated.                                                      */
+struct xyt_packed {
+	short nrows;
+	short cols[ 3 * MAX_BOZORTH_MINUTIAE ];
+};
+
+#define XYT_PACKED_SIZE(n)	( offsetof( struct xyt_packed, cols ) \
+				+ 3 * (n) * sizeof(short) )
+#define XYT_PACKED_X(p)		( (p)->cols )
+#define XYT_PACKED_Y(p)		( (p)->cols + (p)->nrows )
+#define XYT_PACKED_T(p)		( (p)->cols + 2 * (p)->nrows )
+
+/**************************************************************************/
+/* In BZ_ALLOC.C : Per-match scratch space of the "core" algorithm */
+/**************************************************************************/
+/* All of the working tables used by one Probe vs. Gallery comparison. */
+/* Every routine that used to operate on the global arrays now takes a  */
+/* context, so separate threads may match concurrently as long as each  */
+/* uses its own context. A context is large (tens of MB, mostly touched */
+/* lazily), so allocate one per thread and reuse it across matches.     */
+struct bz_ctx {
+	/* Built by bz_comp()/bz_find(), consumed by bz_match() */
+	int scols[ SCOLS_SIZE_1 ][ COLS_SIZE_2 ];
+	int fcols[ FCOLS_SIZE_1 ][ COLS_SIZE_2 ];
+	int * scolpt[ SCOLPT_SIZE ];
+	int * fcolpt[ FCOLPT_SIZE ];
+
+	/* Built by bz_match(), consumed by bz_match_score() */
+	int colp[ COLP_SIZE_1 ][ COLP_SIZE_2 ];
+	int rot[ ROT_SIZE_1 ][ ROT_SIZE_2 ];
+	int * rtp[ ROT_SIZE_1 ];
+
+	/* Used by bz_match_score() and bz_sift() */
+	int sc[ SC_SIZE ];
+	int yl[ YL_SIZE_1 ][ YL_SIZE_2 ];
+	int rq[ RQ_SIZE ];
+	int tq[ TQ_SIZE ];
+	int zz[ ZZ_SIZE ];
+	int rx[ RX_SIZE ];
+	int mm[ MM_SIZE ];
+	int nn[ NN_SIZE ];
+	int qq[ QQ_SIZE ];
+	int rk[ RK_SIZE ];
+	int cp[ CP_SIZE ];
+	int rp[ RP_SIZE ];
+	int rf[ RF_SIZE_1 ][ RF_SIZE_2 ];
+	int cf[ CF_SIZE_1 ][ CF_SIZE_2 ];
+	int y[ Y_SIZE ];
+	int rr[ RR_SIZE ];
+	int avn[ AVN_SIZE ];
+	int avv[ AVV_SIZE_1 ][ AVV_SIZE_2 ];
+
+	/* Used by bz_match_score() and bz_final_loop() */
+	int ct[ CT_SIZE ];
+	int gct[ GCT_SIZE ];
+	int ctt[ CTT_SIZE ];
+	int ctp[ CTP_SIZE_1 ][ CTP_SIZE_2 ];
+	int yy[ YY_SIZE_1 ][ YY_SIZE_2 ][ YY_SIZE_3 ];
+	int sct[ SCT_SIZE_1 ][ SCT_SIZE_2 ];
+};
+
+#define BZ_CTX_NULL ( (struct bz_ctx *) NULL )
+
+/* Edge signature of a gallery template: one bit per cell of quantized */
+/* { distance, beta_1, beta_2 }, see bz_sig.c */
+#define BZ_SIG_DIST_BINS	64
+#define BZ_SIG_BETA_BINS	32
+#define BZ_SIG_CELLS	( BZ_SIG_DIST_BINS * BZ_SIG_BETA_BINS * BZ_SIG_BETA_BINS )
+#define BZ_SIG_SIZE	( BZ_SIG_CELLS / 8 )
+#define BZ_SIG_NEAR	27	/* A cell and its neighbours */
+
+/* An On-File Record's sorted pairwise comparison table, compiled once by */
+/* bz_gallery_tmpl_new() so that repeated matches against the same print  */
+/* can skip bz_comp() and bz_find(). Only the rows within the pruned      */
+/* length are kept, stored in sorted order, so that they are indexed     */
+/* directly. Every column fits a short: distances are at most DM * DM.   */
+struct bz_gallery_tmpl {
+	int len;			/* Pruned length of the Web */
+	short (* rows)[ COLS_SIZE_2 ];	/* Sorted pairwise comparison rows */
+	unsigned char * sig;		/* Cells holding any of the rows, NULL */
+					/* until set from bz_sig_new()        */
+};
+
+#define BZ_GALLERY_TMPL_NULL ( (struct bz_gallery_tmpl *) NULL )
+
 
 /**************************************************************************/
 /**************************************************************************/
@@ -191,29 +283,16 @@ extern int verbose_threshold;
 /**************************************************************************/
 /* In: BZ_GBLS.C */
 /**************************************************************************/
-/* Global arrays supporting "core" bozorth algorithm */
-extern int colp[ COLP_SIZE_1 ][ COLP_SIZE_2 ];
-extern int scols[ SCOLS_SIZE_1 ][ COLS_SIZE_2 ];
-extern int fcols[ FCOLS_SIZE_1 ][ COLS_SIZE_2 ];
-extern int * scolpt[ SCOLPT_SIZE ];
-extern int * fcolpt[ FCOLPT_SIZE ];
-extern int sc[ SC_SIZE ];
-extern int yl[ YL_SIZE_1 ][ YL_SIZE_2 ];
-/* Global arrays supporting "core" bozorth algorithm continued: */
-/*    Globals used significantly by sift() */
-extern int rq[ RQ_SIZE ];
-extern int tq[ TQ_SIZE ];
-extern int zz[ ZZ_SIZE ];
-extern int rx[ RX_SIZE ];
-extern int mm[ MM_SIZE ];
-extern int nn[ NN_SIZE ];
-extern int qq[ QQ_SIZE ];
-extern int rk[ RK_SIZE ];
-extern int cp[ CP_SIZE ];
-extern int rp[ RP_SIZE ];
-extern int rf[RF_SIZE_1][RF_SIZE_2];
-extern int cf[CF_SIZE_1][CF_SIZE_2];
-extern int y[20000];
+/* Context used by the routines that do not take one explicitly; these */
+/* keep the original single-threaded NBIS semantics. */
+extern struct bz_ctx bz_default_ctx;
+
+/**************************************************************************/
+/* In: BZ_ATAN.C */
+/**************************************************************************/
+/* Rounded angle in degrees of the line ( 0, 0 ) - ( dx, dy ), indexed by */
+/* dx * ( dx + 1 ) / 2 + dy for 0 <= dy <= dx <= DM */
+extern const unsigned char bz_atan_table[];
 
 /**************************************************************************/
 /**************************************************************************/
@@ -224,16 +303,39 @@ extern int bozorth_probe_init( struct xyt_struct *);
 extern int bozorth_gallery_init( struct xyt_struct *);
 extern int bozorth_to_gallery(int, struct xyt_struct *, struct xyt_struct *);
 extern int bozorth_main(struct xyt_struct *, struct xyt_struct *);
+extern int bozorth_probe_init_ctx(struct bz_ctx *, struct xyt_packed *);
+extern int bozorth_gallery_init_ctx(struct bz_ctx *, struct xyt_packed *);
+extern int bozorth_to_gallery_ctx(struct bz_ctx *, int, struct xyt_packed *,
+                    struct xyt_packed *);
+extern int bozorth_main_ctx(struct bz_ctx *, struct xyt_packed *,
+                    struct xyt_packed *);
+extern struct bz_gallery_tmpl *bz_gallery_tmpl_new(struct bz_ctx *,
+                    struct xyt_packed *);
+extern int bozorth_to_gallery_tmpl_ctx(struct bz_ctx *, int,
+                    struct xyt_packed *, struct xyt_packed *,
+                    struct bz_gallery_tmpl *);
 /* In: BOZORTH3.C */
-extern void bz_comp(int, int [], int [], int [], int *, int [][COLS_SIZE_2],
-                    int *[]);
+extern void bz_comp(int, short [], short [], short [], int *,
+                    int [][COLS_SIZE_2], int *[]);
 extern void bz_find(int *, int *[]);
 extern int bz_match(int, int);
 extern int bz_match_score(int, struct xyt_struct *, struct xyt_struct *);
-extern void bz_sift(int *, int, int *, int, int, int, int *, int *);
+extern int bz_match_ctx(struct bz_ctx *, int, int);
+extern int bz_match_tmpl_ctx(struct bz_ctx *, int, struct bz_gallery_tmpl *);
+extern int bz_match_score_ctx(struct bz_ctx *, int, struct xyt_packed *,
+                    struct xyt_packed *);
+extern void bz_sift(struct bz_ctx *, int *, int, int *, int, int, int, int *,
+                    int *);
 /* In: BZ_ALLOC.C */
 extern char *malloc_or_exit(int, const char *);
 extern char *malloc_or_return_error(int, const char *);
+extern struct bz_ctx *bz_ctx_new(void);
+extern void bz_ctx_free(struct bz_ctx *);
+extern void bz_gallery_tmpl_free(struct bz_gallery_tmpl *);
+/* In: BZ_SIG.C */
+extern unsigned char *bz_sig_new(struct bz_gallery_tmpl *);
+extern int bz_sig_hits(struct bz_ctx *, int, const unsigned char *);
+extern int bz_sig_cells_near(int *, int [BZ_SIG_NEAR]);
 /* In: BZ_IO.C */
 extern int parse_line_range(const char *, int *, int *);
 extern void set_progname(int, char *, pid_t);
@@ -247,10 +349,12 @@ extern char *get_next_file(char *, FILE *, FILE *, int *, int *, char *,
 extern char *get_score_filename(const char *, const char *);
 extern char *get_score_line(const char *, const char *, int, int, const char *);
 extern struct xyt_struct *bz_load(const char *);
+extern void xyt_to_packed(struct xyt_struct *, struct xyt_packed *);
 extern int fd_readable(int);
 /* In: BZ_SORT.C */
 extern int sort_quality_decreasing(const void *, const void *);
 extern int sort_x_y(const void *, const void *);
+extern int sort_colptrs(const void *, const void *);
 extern int sort_order_decreasing(int [], int, int []);
 
 #endif /* !_BOZORTH_H */
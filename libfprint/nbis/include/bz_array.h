@@ -56,6 +56,11 @@ identified are necessarily the best available for the purpose.
 
 
 
+#define ROT_SIZE_1 20000
+#define ROT_SIZE_2 5
+
+
+
 #define RR_SIZE     100
 #define AVN_SIZE      5
 #define AVV_SIZE_1 2000
@@ -104,8 +104,24 @@ typedef struct dftwaves{
    int nwaves;
    int wavelen;
    DFTWAVE **waves;
+   /* The same wave forms interleaved DFT_LANES at a time, for applying */
+   /* several of them at once: for each group of DFT_LANES waves and    */
+   /* each sample point, the cos values of the group followed by its    */
+   /* sin values.  Groups are padded with zero waves.                   */
+   double *lanes;
+   /* The same wave forms in fixed point with DFT_QBITS fraction bits,  */
+   /* for 8-bit maps: for each wave, its cos values followed by its sin */
+   /* values.                                                           */
+   int *qwaves;
 }DFTWAVES;
 
+#define DFT_LANES          4
+/* With 8-bit pixels, a row sum over a 24 pixel window times a wave   */
+/* sample with 12 fraction bits, summed over 24 rows, fits in 31 bits. */
+#define DFT_QBITS          12
+/* Largest DFT window the fixed point sums are guaranteed for. */
+#define MAX_DFT_WINDOW     24
+
 /* Rotated pixel offsets for a grid of specified dimensions */
 /* rotated at a specified number of different orientations  */
 /* (directions).  This structure used by the DFT analysis   */
@@ -121,6 +137,79 @@ typedef struct rotgrids{
    int **grids;
 } ROTGRIDS;
 
+/* Memory arena the LFS working memory can be allocated from; see */
+/* arena.c.  The data of each block follows its structure.         */
+typedef struct lfsarenablk{
+   struct lfsarenablk *next;  /* Next older block.                  */
+   size_t size;               /* Bytes of data in the block.        */
+   size_t top;                /* Offset of the first unused byte.   */
+   size_t last;               /* Offset of the newest allocation.   */
+} LFSARENABLK;
+
+typedef struct lfsarena{
+   LFSARENABLK *blocks;       /* Blocks, newest first.              */
+   size_t blksize;            /* Minimum size of a new block.       */
+} LFSARENA;
+
+/* Default block size of an arena. */
+#define LFS_ARENA_BLKSIZE  (1 << 20)
+
+/* Processes blocks [first, last) of a block map, or rows of an      */
+/* image, given the private data of the job being run.                */
+typedef int (*LFS_BLOCKS_FUNC)(void *, const int, const int);
+/* Runs an LFS_BLOCKS_FUNC over blocks [0, nblocks), possibly calling */
+/* it concurrently on disjoint ranges from several threads.  Returns  */
+/* zero, or the first non-zero return code of the LFS_BLOCKS_FUNC.    */
+typedef int (*LFS_PARALLEL_FUNC)(void *, LFS_BLOCKS_FUNC, void *,
+                                 const int);
+
+/* Lookup tables used by lfs_detect_minutiae_V2() that depend only on */
+/* the image dimensions and on a few of the LFS parameters.  They can */
+/* be built once in a context and reused for every image of the same  */
+/* size, rather than being rebuilt for each image.                    */
+typedef struct lfsctx{
+   int iw;
+   int ih;
+   int maxpad;
+   /* LFS parameters the tables were built for */
+   int num_directions;
+   double start_dir_angle;
+   int windowsize;
+   int windowoffset;
+   int num_dft_waves;
+   int dirbin_grid_w;
+   int dirbin_grid_h;
+   /* the tables */
+   DIR2RAD *dir2rad;
+   DFTWAVES *dftwaves;
+   ROTGRIDS *dftgrids;
+   ROTGRIDS *dirbingrids;
+   /* optional runner spreading map generation and binarization over */
+   /* threads                                                         */
+   LFS_PARALLEL_FUNC parallel;
+   void *parallel_data;
+   /* optional arena for the working memory, owned by the caller */
+   LFSARENA *arena;
+   /* minutiae count above which LFS_OUT_RELIABILITY_IF_OVER assigns */
+   /* reliability from the quality map                                */
+   int reliability_cap;
+} LFSCTX;
+
+/* Outputs of get_minutiae_flags() besides the minutiae themselves.   */
+/* Without LFS_OUT_RELIABILITY, the minutiae keep the reliability      */
+/* assigned at detection rather than the one from the quality map.    */
+/* LFS_OUT_RELIABILITY_IF_OVER asks for it only if more minutiae than */
+/* the reliability_cap of the LFS context are detected.               */
+#define LFS_OUT_QUALITY_MAP       0x01
+#define LFS_OUT_DIRECTION_MAP     0x02
+#define LFS_OUT_LOW_CONTRAST_MAP  0x04
+#define LFS_OUT_LOW_FLOW_MAP      0x08
+#define LFS_OUT_HIGH_CURVE_MAP    0x10
+#define LFS_OUT_BINARIZED         0x20
+#define LFS_OUT_RELIABILITY       0x40
+#define LFS_OUT_ALL               0x7f
+#define LFS_OUT_RELIABILITY_IF_OVER 0x80
+
 /*************************************************************************/
 /* 10, 2X3 pixel pair feature patterns used to define ridge endings      */
 /* and bifurcations.                                                     */
@@ -134,6 +223,22 @@ typedef struct rotgrids{
 typedef struct fp_minutia MINUTIA;
 typedef struct fp_minutiae MINUTIAE;
 
+/* Minutiae bucketed by location on a grid of square cells; see */
+/* mingrid.c.  The list indices of the minutiae in cell          */
+/* (cx, cy) are items[cells[c]] to items[cells[c+1]-1], with     */
+/* c = (cy * gw) + cx.                                           */
+typedef struct mingrid{
+   int cellsize;              /* Width and height (in pixels) of a cell. */
+   int gw;                    /* Width (in cells) of the grid.           */
+   int gh;                    /* Height (in cells) of the grid.          */
+   int *cells;                /* Start of each cell's bucket in items.   */
+   int *items;                /* Minutia list indices, bucket by bucket. */
+} MINGRID;
+
+/* Average number of minutiae per cell of a minutia grid. */
+#define MINGRID_OCCUPANCY       2
+#define MIN_MINGRID_CELLSIZE    8
+
 typedef struct feature_pattern{
    int type;
    int appearing;
@@ -240,6 +345,12 @@ typedef struct lfsparms{
    /* Ridge Counting Controls */
    int    max_nbrs;
    int    max_ridge_steps;
+
+   /* Precision Controls */
+   int    full_precision;  /* Generate maps and binarize from 8-bit pixels */
+                           /* with an integer DFT, rather than scaling the */
+                           /* image to 6 bits.  The intensity thresholds   */
+                           /* above are given for 6-bit pixels.            */
 } LFSPARMS;
 
 /*************************************************************************/
@@ -650,6 +761,8 @@ typedef struct lfsparms{
 
 /* Pixel value limit in 6-bit image. */
 #define IMG_6BIT_PIX_LIMIT      64
+/* Pixel value limit in 8-bit image. */
+#define IMG_8BIT_PIX_LIMIT      256
 
 /* Maximum number (or reallocated chunks) of minutia to be detected */
 /* in an image.                                                     */
@@ -687,22 +800,40 @@ typedef struct lfsparms{
 extern int binarize_V2(unsigned char **, int *, int *,
                      unsigned char *, const int, const int,
                      int *, const int, const int,
-                     const ROTGRIDS *, const LFSPARMS *);
+                     const ROTGRIDS *, const LFSPARMS *,
+                     LFS_PARALLEL_FUNC, void *);
 extern int binarize_image_V2(unsigned char **, int *, int *,
                      unsigned char *, const int, const int,
                      const int *, const int, const int,
-                     const int, const ROTGRIDS *);
+                     const int, const ROTGRIDS *,
+                     LFS_PARALLEL_FUNC, void *);
 extern int dirbinarize(const unsigned char *, const int, const ROTGRIDS *);
 
+/* arena.c */
+extern int init_lfsarena(LFSARENA **, const size_t);
+extern void reset_lfsarena(LFSARENA *);
+extern void free_lfsarena(LFSARENA *);
+extern LFSARENA *set_lfsarena(LFSARENA *);
+extern void *lfs_malloc(const size_t);
+extern void *lfs_calloc(const size_t, const size_t);
+extern void *lfs_realloc(void *, const size_t);
+extern void lfs_free(void *);
+
 /* block.c */
 extern int block_offsets(int **, int *, int *, const int, const int,
                      const int, const int);
 extern int low_contrast_block(const int, const int,
                      unsigned char *, const int, const int, const LFSPARMS *);
+extern int low_variance_block(const int, const int,
+                     const double *, const double *,
+                     const int, const int, const LFSPARMS *);
 extern int find_valid_block(int *, int *, int *, int *, int *,
                      const int, const int, const int, const int,
                      const int, const int);
 extern void set_margin_blocks(int *, const int, const int, const int);
+extern void valid_block_bounds(int *, int *, int *, int *,
+                     const int *, const int, const int,
+                     const int, const int, const int);
 
 /* contour.c */
 int allocate_contour(int **ocontour_x, int **ocontour_y,
@@ -734,11 +865,26 @@ extern int get_minutiae(MINUTIAE **, int **, int **, int **,
                  unsigned char **, int *, int *, int *,
                  unsigned char *, const int, const int,
                  const int, const double, const LFSPARMS *);
+extern int get_minutiae_ctx(MINUTIAE **, int **, int **, int **,
+                 int **, int **, int *, int *,
+                 unsigned char **, int *, int *, int *,
+                 unsigned char *, const int, const int,
+                 const int, const double, const LFSPARMS *,
+                 const LFSCTX *);
+extern int get_minutiae_flags(MINUTIAE **, int **, int **, int **,
+                 int **, int **, int *, int *,
+                 unsigned char **, int *, int *, int *,
+                 unsigned char *, const int, const int,
+                 const int, const double, const LFSPARMS *,
+                 const LFSCTX *, const int);
 
 /* dft.c */
 extern int dft_dir_powers(double **, unsigned char *, const int,
                      const int, const int, const DFTWAVES *,
                      const ROTGRIDS *);
+extern int dft_dir_powers_8bit(double **, unsigned char *, const int,
+                     const int, const int, const DFTWAVES *,
+                     const ROTGRIDS *);
 extern int dft_power_stats(int *, double *, int *, double *, double **,
                      const int, const int, const int);
 
@@ -746,6 +892,7 @@ extern int dft_power_stats(int *, double *, int *, double *, double **,
 extern void free_dir2rad(DIR2RAD *);
 extern void free_dftwaves(DFTWAVES *);
 extern void free_rotgrids(ROTGRIDS *);
+extern void free_lfsctx(LFSCTX *);
 extern void free_dir_powers(double **, const int);
 
 /* imgutil.c */
@@ -756,7 +903,11 @@ extern void gray2bin(const int, const int, const int,
 extern int pad_uchar_image(unsigned char **, int *, int *,
                      unsigned char *, const int, const int, const int,
                      const int);
+extern int summed_area_tables(double **, double **,
+                     const unsigned char *, const int, const int);
 extern void fill_holes(unsigned char *, const int, const int);
+extern void fill_holes_region(unsigned char *, const int, const int,
+                     const int, const int, const int, const int);
 extern int free_path(const int, const int, const int, const int,
                      unsigned char *, const int, const int, const LFSPARMS *);
 extern int search_in_direction(int *, int *, int *, int *, const int,
@@ -771,6 +922,9 @@ extern int init_rotgrids(ROTGRIDS **, const int, const int, const int,
                      const double, const int, const int, const int, const int);
 extern int alloc_dir_powers(double ***, const int, const int);
 extern int alloc_power_stats(int **, double **, int **, double **, const int);
+extern int init_lfsctx(LFSCTX **, const int, const int, const LFSPARMS *);
+extern int lfsctx_matches(const LFSCTX *, const int, const int,
+                     const LFSPARMS *);
 
 /* line.c */
 extern int line_points(int **, int **, int *,
@@ -801,11 +955,13 @@ extern int fill_loop(const int *, const int *, const int,
 extern int gen_image_maps(int **, int **, int **, int **, int *, int *,
                     unsigned char *, const int, const int,
                     const DIR2RAD *, const DFTWAVES *,
-                    const ROTGRIDS *, const LFSPARMS *);
+                    const ROTGRIDS *, const LFSPARMS *,
+                    LFS_PARALLEL_FUNC, void *);
 extern int gen_initial_maps(int **, int **, int **,
                     int *, const int, const int,
                     unsigned char *, const int, const int,
-                    const DFTWAVES *, const  ROTGRIDS *, const LFSPARMS *);
+                    const DFTWAVES *, const  ROTGRIDS *, const LFSPARMS *,
+                    LFS_PARALLEL_FUNC, void *);
 extern int interpolate_direction_map(int *, int *, const int, const int,
                     const LFSPARMS *);
 extern int morph_TF_map(int *, const int, const int, const LFSPARMS *);
@@ -860,6 +1016,10 @@ extern void skip_repeated_horizontal_pair(int *, const int,
 extern void skip_repeated_vertical_pair(int *, const int,
                      unsigned char **, unsigned char **, const int, const int);
 
+/* mingrid.c */
+extern int build_mingrid(MINGRID **, const MINUTIAE *, const int, const int);
+extern void free_mingrid(MINGRID *);
+
 /* minutia.c */
 extern int alloc_minutiae(MINUTIAE **, const int);
 extern int realloc_minutiae(MINUTIAE *, const int);
@@ -882,6 +1042,7 @@ extern void dump_reliable_minutiae_pts(FILE *, const MINUTIAE *, const double);
 extern int create_minutia(MINUTIA **, const int, const int,
                      const int, const int, const int, const double,
                      const int, const int, const int);
+extern int copy_minutiae(MINUTIAE **, const MINUTIAE *);
 extern void free_minutiae(MINUTIAE *);
 extern void free_minutia(MINUTIA *);
 extern int remove_minutia(const int, MINUTIAE *);
@@ -900,6 +1061,7 @@ extern int scan4minutiae_horizontally(MINUTIAE *, unsigned char *,
                      const LFSPARMS *);
 extern int scan4minutiae_horizontally_V2(MINUTIAE *,
                      unsigned char *, const int, const int,
+                     const int, const int, const int, const int,
                      int *, int *, int *,
                      const LFSPARMS *);
 extern int scan4minutiae_vertically(MINUTIAE *, unsigned char *,
@@ -913,6 +1075,7 @@ extern int rescan4minutiae_horizontally(MINUTIAE *, unsigned char *bdata,
                      const LFSPARMS *);
 extern int scan4minutiae_vertically_V2(MINUTIAE *,
                      unsigned char *, const int, const int,
+                     const int, const int, const int, const int,
                      int *, int *, int *, const LFSPARMS *);
 extern int rescan4minutiae_vertically(MINUTIAE *, unsigned char *,
                      const int, const int, const int *, const int *,
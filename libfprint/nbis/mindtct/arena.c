@@ -0,0 +1,352 @@
+/***********************************************************************
+      LIBRARY: LFS - NIST Latent Fingerprint System
+
+      FILE:    ARENA.C
+
+      Contains routines responsible for allocating the working memory
+      of the NIST Latent Fingerprint System (LFS) from a memory arena.
+      While an arena is installed for the calling thread, lfs_malloc()
+      and friends carve memory out of large blocks owned by the arena,
+      and lfs_free() only reclaims the space at the top of the newest
+      block.  Everything left is released in one step when the arena
+      is reset.  Without an arena they fall back to the C library.
+
+***********************************************************************
+               ROUTINES:
+                        init_lfsarena()
+                        reset_lfsarena()
+                        free_lfsarena()
+                        set_lfsarena()
+                        lfs_malloc()
+                        lfs_calloc()
+                        lfs_realloc()
+                        lfs_free()
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <lfs.h>
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define LFS_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define LFS_THREAD_LOCAL __thread
+#else
+#error "thread-local storage required"
+#endif
+
+/* Every allocation from an arena is preceded by this header. */
+typedef struct lfsarenahdr{
+   size_t size;      /* Rounded size of the allocation, low bit set once */
+                     /* the allocation has been freed.                   */
+   size_t prev;      /* Offset of the previous allocation's header in    */
+                     /* the block, or LFS_ARENA_NONE.                    */
+} LFSARENAHDR;
+
+#define LFS_ARENA_ALIGN    16
+#define LFS_ARENA_NONE     ((size_t)-1)
+#define LFS_ARENA_ROUND(n) (((n) + LFS_ARENA_ALIGN - 1) & \
+                            ~(size_t)(LFS_ARENA_ALIGN - 1))
+#define LFS_ARENA_HDRSIZE  LFS_ARENA_ROUND(sizeof(LFSARENAHDR))
+#define LFS_ARENA_BLKDATA(blk) ((unsigned char *)(blk) + \
+                            LFS_ARENA_ROUND(sizeof(LFSARENABLK)))
+#define LFS_ARENA_HDR(blk, off) ((LFSARENAHDR *)(LFS_ARENA_BLKDATA(blk) + (off)))
+
+/* The arena installed for the calling thread, if any. */
+static LFS_THREAD_LOCAL LFSARENA *cur_lfsarena = (LFSARENA *)NULL;
+
+/*************************************************************************
+**************************************************************************
+#cat: init_lfsarena - Allocates an empty memory arena.  Its first block
+#cat:             is allocated on first use.
+
+   Input:
+      blksize  - minimum size (in bytes) of the blocks of the arena
+   Output:
+      optr     - points to the allocated LFSARENA structure
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+int init_lfsarena(LFSARENA **optr, const size_t blksize)
+{
+   LFSARENA *arena;
+
+   arena = (LFSARENA *)malloc(sizeof(LFSARENA));
+   if(arena == (LFSARENA *)NULL){
+      fprintf(stderr, "ERROR : init_lfsarena : malloc : arena\n");
+      return(-710);
+   }
+   arena->blocks = (LFSARENABLK *)NULL;
+   arena->blksize = blksize;
+
+   *optr = arena;
+   return(0);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: reset_lfsarena - Releases at once all the memory allocated from an
+#cat:             arena.  If the arena had grown past its first block,
+#cat:             its block size is raised to the total so that the next
+#cat:             use fits in a single block.
+
+   Input:
+      arena    - the arena to be reset
+**************************************************************************/
+void reset_lfsarena(LFSARENA *arena)
+{
+   LFSARENABLK *blk, *next;
+   size_t total;
+
+   blk = arena->blocks;
+   if(blk == (LFSARENABLK *)NULL)
+      return;
+
+   /* If a single block was used, keep it for the next use. */
+   if(blk->next == (LFSARENABLK *)NULL){
+      blk->top = 0;
+      blk->last = LFS_ARENA_NONE;
+      return;
+   }
+
+   /* Otherwise, release all the blocks. */
+   total = 0;
+   while(blk != (LFSARENABLK *)NULL){
+      next = blk->next;
+      total += blk->size;
+      free(blk);
+      blk = next;
+   }
+   arena->blocks = (LFSARENABLK *)NULL;
+   if(total > arena->blksize)
+      arena->blksize = total;
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: free_lfsarena - Deallocates a memory arena and all the memory that
+#cat:             was allocated from it.
+
+   Input:
+      arena    - the arena to be deallocated
+**************************************************************************/
+void free_lfsarena(LFSARENA *arena)
+{
+   LFSARENABLK *blk, *next;
+
+   blk = arena->blocks;
+   while(blk != (LFSARENABLK *)NULL){
+      next = blk->next;
+      free(blk);
+      blk = next;
+   }
+   free(arena);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: set_lfsarena - Installs the arena that the LFS allocation routines
+#cat:             use in the calling thread.  An arena must only be
+#cat:             installed in one thread at a time.
+
+   Input:
+      arena    - the arena to be used, or NULL to use the C library
+   Return Code:
+      The arena previously installed in the calling thread, or NULL
+**************************************************************************/
+LFSARENA *set_lfsarena(LFSARENA *arena)
+{
+   LFSARENA *prev;
+
+   prev = cur_lfsarena;
+   cur_lfsarena = arena;
+   return(prev);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: find_lfsarena_block - Finds the block of the current arena holding
+#cat:             a given allocation.
+
+   Input:
+      ptr      - address returned by lfs_malloc() or related routines
+   Return Code:
+      The block holding ptr, or NULL if ptr was not allocated from the
+      current arena
+**************************************************************************/
+static LFSARENABLK *find_lfsarena_block(const void *ptr)
+{
+   LFSARENABLK *blk;
+   const unsigned char *p = (const unsigned char *)ptr;
+
+   if(cur_lfsarena == (LFSARENA *)NULL)
+      return((LFSARENABLK *)NULL);
+
+   for(blk = cur_lfsarena->blocks; blk != (LFSARENABLK *)NULL;
+       blk = blk->next){
+      if(p >= LFS_ARENA_BLKDATA(blk) && p < LFS_ARENA_BLKDATA(blk) + blk->size)
+         return(blk);
+   }
+   return((LFSARENABLK *)NULL);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: lfs_malloc - Allocates memory from the arena installed in the
+#cat:             calling thread, or with malloc() if there is none.
+
+   Input:
+      size     - number of bytes to allocate
+   Return Code:
+      Address of the allocated memory, or NULL on a system error
+**************************************************************************/
+void *lfs_malloc(const size_t size)
+{
+   LFSARENA *arena = cur_lfsarena;
+   LFSARENABLK *blk;
+   LFSARENAHDR *hdr;
+   size_t rsize, need, blksize;
+
+   if(arena == (LFSARENA *)NULL)
+      return(malloc(size));
+
+   rsize = LFS_ARENA_ROUND(size ? size : 1);
+   if(rsize < size)
+      return(NULL);
+   need = LFS_ARENA_HDRSIZE + rsize;
+
+   blk = arena->blocks;
+   /* If the newest block is full, start a new one. */
+   if(blk == (LFSARENABLK *)NULL || blk->size - blk->top < need){
+      blksize = (need > arena->blksize) ? need : arena->blksize;
+      blk = (LFSARENABLK *)malloc(LFS_ARENA_ROUND(sizeof(LFSARENABLK)) +
+                                  blksize);
+      if(blk == (LFSARENABLK *)NULL)
+         return(NULL);
+      blk->next = arena->blocks;
+      blk->size = blksize;
+      blk->top = 0;
+      blk->last = LFS_ARENA_NONE;
+      arena->blocks = blk;
+   }
+
+   hdr = LFS_ARENA_HDR(blk, blk->top);
+   hdr->size = rsize;
+   hdr->prev = blk->last;
+   blk->last = blk->top;
+   blk->top += need;
+
+   return((unsigned char *)hdr + LFS_ARENA_HDRSIZE);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: lfs_calloc - Allocates zeroed memory for an array, as calloc() does,
+#cat:             using lfs_malloc().
+
+   Input:
+      nmemb    - number of array elements
+      size     - size (in bytes) of each element
+   Return Code:
+      Address of the allocated memory, or NULL on a system error
+**************************************************************************/
+void *lfs_calloc(const size_t nmemb, const size_t size)
+{
+   void *ptr;
+
+   if(cur_lfsarena == (LFSARENA *)NULL)
+      return(calloc(nmemb, size));
+
+   if(size && nmemb > ((size_t)-1) / size)
+      return(NULL);
+   ptr = lfs_malloc(nmemb * size);
+   if(ptr != NULL)
+      memset(ptr, 0, nmemb * size);
+   return(ptr);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: lfs_realloc - Resizes memory allocated by lfs_malloc() or related
+#cat:             routines.  The newest allocation of an arena is
+#cat:             resized in place when its block has room.
+
+   Input:
+      ptr      - address of the memory to resize, or NULL
+      size     - new size (in bytes)
+   Return Code:
+      Address of the resized memory, or NULL on a system error, in which
+      case ptr is left untouched
+**************************************************************************/
+void *lfs_realloc(void *ptr, const size_t size)
+{
+   LFSARENABLK *blk;
+   LFSARENAHDR *hdr;
+   size_t rsize;
+   void *nptr;
+
+   if(ptr == NULL)
+      return(lfs_malloc(size));
+
+   blk = find_lfsarena_block(ptr);
+   if(blk == (LFSARENABLK *)NULL)
+      return(realloc(ptr, size));
+
+   hdr = (LFSARENAHDR *)((unsigned char *)ptr - LFS_ARENA_HDRSIZE);
+   rsize = LFS_ARENA_ROUND(size ? size : 1);
+
+   /* If this is the newest allocation of the newest block ... */
+   if(blk == cur_lfsarena->blocks && rsize >= size &&
+      hdr == LFS_ARENA_HDR(blk, blk->last) &&
+      blk->size - blk->last - LFS_ARENA_HDRSIZE >= rsize){
+      /* Resize it in place. */
+      hdr->size = rsize;
+      blk->top = blk->last + LFS_ARENA_HDRSIZE + rsize;
+      return(ptr);
+   }
+
+   nptr = lfs_malloc(size);
+   if(nptr == NULL)
+      return(NULL);
+   memcpy(nptr, ptr, (hdr->size < size) ? hdr->size : size);
+   lfs_free(ptr);
+   return(nptr);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: lfs_free - Deallocates memory allocated by lfs_malloc() or related
+#cat:             routines.  Memory from an arena is marked free, and the
+#cat:             top of its block is lowered past all the allocations at
+#cat:             the top that are free.
+
+   Input:
+      ptr      - address of the memory to deallocate, or NULL
+**************************************************************************/
+void lfs_free(void *ptr)
+{
+   LFSARENABLK *blk;
+   LFSARENAHDR *hdr;
+
+   if(ptr == NULL)
+      return;
+
+   blk = find_lfsarena_block(ptr);
+   if(blk == (LFSARENABLK *)NULL){
+      free(ptr);
+      return;
+   }
+
+   hdr = (LFSARENAHDR *)((unsigned char *)ptr - LFS_ARENA_HDRSIZE);
+   hdr->size |= 1;
+
+   while(blk->last != LFS_ARENA_NONE){
+      hdr = LFS_ARENA_HDR(blk, blk->last);
+      if(!(hdr->size & 1))
+         break;
+      blk->top = blk->last;
+      blk->last = hdr->prev;
+   }
+}
@@ -37,6 +37,8 @@ identified are necessarily the best available for the purpose.
 ***********************************************************************
                ROUTINES:
                         binarize_V2()
+                        dirbin_slides()
+                        binarize_rows()
 			binarize_image_V2()
                         dirbinarize()
 
@@ -44,6 +46,7 @@ identified are necessarily the best available for the purpose.
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <lfs.h>
 
 /*************************************************************************
@@ -66,6 +69,8 @@ identified are necessarily the best available for the purpose.
       dirbingrids - set of rotated grid offsets used for directional
                     binarization
       lfsparms    - parameters and thresholds for controlling LFS
+      parallel    - optional runner for binarizing the image
+      parallel_data - private data passed to the runner
    Output:
       odata - points to created (unpadded) binary image
       ow    - width of binary image
@@ -77,22 +82,29 @@ identified are necessarily the best available for the purpose.
 int binarize_V2(unsigned char **odata, int *ow, int *oh,
           unsigned char *pdata, const int pw, const int ph,
           int *direction_map, const int mw, const int mh,
-          const ROTGRIDS *dirbingrids, const LFSPARMS *lfsparms)
+          const ROTGRIDS *dirbingrids, const LFSPARMS *lfsparms,
+          LFS_PARALLEL_FUNC parallel, void *parallel_data)
 {
    unsigned char *bdata;
    int i, bw, bh, ret; /* return code */
+   int sx, sy, ex, ey;
 
    /* 1. Binarize the padded input image using directional block info. */
    if((ret = binarize_image_V2(&bdata, &bw, &bh, pdata, pw, ph,
                             direction_map, mw, mh,
-                            lfsparms->blocksize, dirbingrids))){
+                            lfsparms->blocksize, dirbingrids,
+                            parallel, parallel_data))){
       return(ret);
    }
 
    /* 2. Fill black and white holes in binary image. */
+   /* Blocks with INVALID direction are all white, so only the */
+   /* box around the VALID blocks can have holes.               */
+   valid_block_bounds(&sx, &sy, &ex, &ey, direction_map, mw, mh,
+                      lfsparms->blocksize, bw, bh);
    /* LFS scans the binary image, filling holes, 3 times. */
    for(i = 0; i < lfsparms->num_fill_holes; i++)
-      fill_holes(bdata, bw, bh);
+      fill_holes_region(bdata, bw, bh, sx, sy, ex, ey);
 
    /* Return binarized input image. */
    *odata = bdata;
@@ -101,12 +113,202 @@ int binarize_V2(unsigned char **odata, int *ow, int *oh,
    return(0);
 }
 
+/* Inputs and outputs of binarize_image_V2() shared by the calls to */
+/* binarize_rows() that binarize its bands of rows.                 */
+typedef struct binarizejob{
+   unsigned char *bdata;
+   int bw;
+   unsigned char *spdata;     /* first unpadded pixel of the padded image */
+   int pw;
+   const int *direction_map;
+   int mw;
+   int blocksize;
+   const ROTGRIDS *dirbingrids;
+   int cy;                    /* center row of the rotated grids          */
+   int *slides;               /* per direction, (offset, weight) pairs    */
+   int *nslides;              /* number of pairs for each direction       */
+} BINARIZEJOB;
+
+/*************************************************************************
+**************************************************************************
+#cat: dirbin_slides - Computes, for each rotated grid used for directional
+#cat:              binarization, the pixel offsets and weights that update
+#cat:              the grid's pixel sum when the grid moves one pixel to
+#cat:              the right.  Offsets entering the grid have positive
+#cat:              weight, offsets leaving it negative weight.  Offsets
+#cat:              repeated in a grid are counted as many times.
+
+   Input:
+      dirbingrids - set of rotated grid offsets used for directional
+                    binarization
+   Output:
+      oslides  - for each grid, up to 2 * grid size (offset, weight) pairs
+      onslides - number of pairs for each grid
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+static int dirbin_slides(int **oslides, int **onslides,
+                         const ROTGRIDS *dirbingrids)
+{
+   int *slides, *nslides, *sorted, *sptr;
+   int npts, d, i, j, k, off, weight;
+
+   npts = dirbingrids->grid_w * dirbingrids->grid_h;
+
+   slides = (int *)lfs_malloc(dirbingrids->ngrids * npts * 4 * sizeof(int));
+   if(slides == (int *)NULL){
+      fprintf(stderr, "ERROR : dirbin_slides : malloc : slides\n");
+      return(-601);
+   }
+   nslides = (int *)lfs_malloc(dirbingrids->ngrids * sizeof(int));
+   if(nslides == (int *)NULL){
+      lfs_free(slides);
+      fprintf(stderr, "ERROR : dirbin_slides : malloc : nslides\n");
+      return(-602);
+   }
+   sorted = (int *)lfs_malloc(npts * sizeof(int));
+   if(sorted == (int *)NULL){
+      lfs_free(slides);
+      lfs_free(nslides);
+      fprintf(stderr, "ERROR : dirbin_slides : malloc : sorted\n");
+      return(-603);
+   }
+
+   for(d = 0; d < dirbingrids->ngrids; d++){
+      /* Sort the grid's offsets in increasing order. */
+      memcpy(sorted, dirbingrids->grids[d], npts * sizeof(int));
+      for(i = 1; i < npts; i++){
+         off = sorted[i];
+         for(j = i; j > 0 && sorted[j-1] > off; j--)
+            sorted[j] = sorted[j-1];
+         sorted[j] = off;
+      }
+
+      /* Merge the offsets moved right by one (entering, +1) with the */
+      /* original offsets (leaving, -1), dropping those that cancel.  */
+      sptr = slides + (d * npts * 4);
+      nslides[d] = 0;
+      i = 0;
+      j = 0;
+      while(i < npts || j < npts){
+         if(j >= npts || (i < npts && sorted[i] + 1 <= sorted[j]))
+            off = sorted[i] + 1;
+         else
+            off = sorted[j];
+         weight = 0;
+         while(i < npts && sorted[i] + 1 == off){
+            weight++;
+            i++;
+         }
+         while(j < npts && sorted[j] == off){
+            weight--;
+            j++;
+         }
+         if(weight != 0){
+            k = nslides[d]++;
+            sptr[2*k] = off;
+            sptr[2*k+1] = weight;
+         }
+      }
+   }
+
+   lfs_free(sorted);
+   *oslides = slides;
+   *onslides = nslides;
+   return(0);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: binarize_rows - Binarizes a band of rows of the image for
+#cat:              binarize_image_V2().  Along a row, as long as the
+#cat:              direction does not change, the pixel sum of the rotated
+#cat:              grid is updated from the previous pixel's sum rather
+#cat:              than recomputed, which gives the same result as
+#cat:              dirbinarize().  Disjoint bands may be binarized
+#cat:              concurrently.
+
+   Input:
+      arg   - the BINARIZEJOB of the image being binarized
+      first - first row of the band
+      last  - row one past the band
+   Output:
+      arg   - rows [first, last) of the binary image are set
+   Return Code:
+      Zero  - successful completion
+**************************************************************************/
+static int binarize_rows(void *arg, const int first, const int last)
+{
+   BINARIZEJOB *job = (BINARIZEJOB *)arg;
+   const ROTGRIDS *dirbingrids = job->dirbingrids;
+   const int npts = dirbingrids->grid_w * dirbingrids->grid_h;
+   const int *grid, *crow, *slide;
+   const int *maprow;
+   unsigned char *bptr, *pptr;
+   int ix, iy, i, mapval, lastdir, nslide;
+   int csum, gsum;
+
+   for(iy = first; iy < last; iy++){
+      pptr = job->spdata + (iy * job->pw);
+      bptr = job->bdata + (iy * job->bw);
+      maprow = job->direction_map + ((iy / job->blocksize) * job->mw);
+      lastdir = INVALID_DIR;
+      gsum = 0;
+
+      for(ix = 0; ix < job->bw; ix++, pptr++, bptr++){
+         /* Get the direction of the block the pixel is in. */
+         mapval = maprow[ix / job->blocksize];
+         /* If current block has has INVALID direction ... */
+         if(mapval == INVALID_DIR){
+            /* Set binary pixel to white (255). */
+            *bptr = WHITE_PIXEL;
+            lastdir = INVALID_DIR;
+            continue;
+         }
+
+         grid = dirbingrids->grids[mapval];
+         /* If the previous pixel used the same grid ... */
+         if(mapval == lastdir){
+            /* Slide its pixel sum one pixel to the right. */
+            slide = job->slides + (mapval * npts * 4);
+            nslide = job->nslides[mapval];
+            for(i = 0; i < nslide; i++)
+               gsum += slide[2*i+1] * *(pptr - 1 + slide[2*i]);
+         }
+         else{
+            /* Otherwise, sum the whole grid. */
+            gsum = 0;
+            for(i = 0; i < npts; i++)
+               gsum += *(pptr + grid[i]);
+            lastdir = mapval;
+         }
+
+         /* Sum the center row of the grid. */
+         crow = grid + (job->cy * dirbingrids->grid_w);
+         csum = 0;
+         for(i = 0; i < dirbingrids->grid_w; i++)
+            csum += *(pptr + crow[i]);
+
+         /* If the center row sum treated as an average is less than */
+         /* the total pixel sum in the rotated grid ...               */
+         if((csum * dirbingrids->grid_h) < gsum)
+            *bptr = BLACK_PIXEL;
+         else
+            *bptr = WHITE_PIXEL;
+      }
+   }
+
+   return(0);
+}
+
 /*************************************************************************
 **************************************************************************
 #cat: binarize_image_V2 - Takes a grayscale input image and its associated
 #cat:              Direction Map and generates a binarized version of the
 #cat:              image.  Note that there is no "Isotropic" binarization
-#cat:              used in this version.
+#cat:              used in this version.  The image is binarized in bands
+#cat:              of rows, which are handed to a runner if one is given.
 
    Input:
       pdata       - padded input grayscale image
@@ -118,6 +320,9 @@ int binarize_V2(unsigned char **odata, int *ow, int *oh,
       blocksize   - dimension (in pixels) of each NMAP block
       dirbingrids - set of rotated grid offsets used for directional
                     binarization
+      parallel    - optional runner the rows are handed to, or NULL to
+                    binarize them all in this thread
+      parallel_data - private data passed to the runner
    Output:
       odata  - points to binary image results
       ow     - points to binary image width
@@ -129,49 +334,53 @@ int binarize_V2(unsigned char **odata, int *ow, int *oh,
 int binarize_image_V2(unsigned char **odata, int *ow, int *oh,
                    unsigned char *pdata, const int pw, const int ph,
                    const int *direction_map, const int mw, const int mh,
-                   const int blocksize, const ROTGRIDS *dirbingrids)
+                   const int blocksize, const ROTGRIDS *dirbingrids,
+                   LFS_PARALLEL_FUNC parallel, void *parallel_data)
 {
-   int ix, iy, bw, bh, bx, by, mapval;
-   unsigned char *bdata, *bptr;
-   unsigned char *pptr, *spptr;
+   BINARIZEJOB job;
+   int bw, bh, ret;
+   unsigned char *bdata;
+   double dcy;
 
    /* Compute dimensions of "unpadded" binary image results. */
    bw = pw - (dirbingrids->pad<<1);
    bh = ph - (dirbingrids->pad<<1);
 
-   bdata = (unsigned char *)malloc(bw*bh*sizeof(unsigned char));
+   bdata = (unsigned char *)lfs_malloc(bw*bh*sizeof(unsigned char));
    if(bdata == (unsigned char *)NULL){
       fprintf(stderr, "ERROR : binarize_image_V2 : malloc : bdata\n");
       return(-600);
    }
 
-   bptr = bdata;
-   spptr = pdata + (dirbingrids->pad * pw) + dirbingrids->pad;
-   for(iy = 0; iy < bh; iy++){
-      /* Set pixel pointer to start of next row in grid. */
-      pptr = spptr;
-      for(ix = 0; ix < bw; ix++){
-
-         /* Compute which block the current pixel is in. */
-         bx = (int)(ix/blocksize);
-         by = (int)(iy/blocksize);
-         /* Get corresponding value in Direction Map. */
-         mapval = *(direction_map + (by*mw) + bx);
-         /* If current block has has INVALID direction ... */
-         if(mapval == INVALID_DIR)
-            /* Set binary pixel to white (255). */
-            *bptr = WHITE_PIXEL;
-         /* Otherwise, if block has a valid direction ... */
-         else /*if(mapval >= 0)*/
-            /* Use directional binarization based on block's direction. */
-            *bptr = dirbinarize(pptr, mapval, dirbingrids);
-
-         /* Bump input and output pixel pointers. */
-         pptr++;
-         bptr++;
-      }
-      /* Bump pointer to the next row in padded input image. */
-      spptr += pw;
+   job.bdata = bdata;
+   job.bw = bw;
+   job.spdata = pdata + (dirbingrids->pad * pw) + dirbingrids->pad;
+   job.pw = pw;
+   job.direction_map = direction_map;
+   job.mw = mw;
+   job.blocksize = blocksize;
+   job.dirbingrids = dirbingrids;
+   /* Calculate center (0-oriented) row in grid, as dirbinarize() does. */
+   dcy = (dirbingrids->grid_h-1)/(double)2.0;
+   dcy = trunc_dbl_precision(dcy, TRUNC_SCALE);
+   job.cy = sround(dcy);
+
+   if((ret = dirbin_slides(&job.slides, &job.nslides, dirbingrids))){
+      lfs_free(bdata);
+      return(ret);
+   }
+
+   /* Binarize all rows, handing them to the runner if one is given. */
+   if(parallel != (LFS_PARALLEL_FUNC)NULL)
+      ret = parallel(parallel_data, binarize_rows, &job, bh);
+   else
+      ret = binarize_rows(&job, 0, bh);
+
+   lfs_free(job.slides);
+   lfs_free(job.nslides);
+   if(ret){
+      lfs_free(bdata);
+      return(ret);
    }
 
    *odata = bdata;
@@ -38,8 +38,10 @@ identified are necessarily the best available for the purpose.
                ROUTINES:
                         block_offsets()
                         low_contrast_block()
+                        low_variance_block()
                         find_valid_block()
                         set_margin_blocks()
+                        valid_block_bounds()
 
 ***********************************************************************/
 
@@ -115,7 +117,7 @@ int block_offsets(int **optr, int *ow, int *oh,
    lastbh = bh - 1;
 
    /* Allocate list of block offsets */
-   blkoffs = (int *)malloc(bsize * sizeof(int));
+   blkoffs = (int *)lfs_malloc(bsize * sizeof(int));
    if(blkoffs == (int *)NULL){
       fprintf(stderr, "ERROR : block_offsets : malloc : blkoffs\n");
       return(-81);
@@ -205,7 +207,7 @@ int low_contrast_block(const int blkoffset, const int blocksize,
                        unsigned char *pdata, const int pw, const int ph,
                        const LFSPARMS *lfsparms)
 {
-   int pixtable[IMG_6BIT_PIX_LIMIT], numpix;
+   int pixtable[IMG_8BIT_PIX_LIMIT], numpix, pixlimit;
    int px, py, pi;
    unsigned char *sptr, *pptr;
    int delta;
@@ -214,7 +216,8 @@ int low_contrast_block(const int blkoffset, const int blocksize,
    int pixsum, found;
 
    numpix = blocksize*blocksize;
-   memset(pixtable, 0, IMG_6BIT_PIX_LIMIT*sizeof(int));
+   pixlimit = lfsparms->full_precision ? IMG_8BIT_PIX_LIMIT : IMG_6BIT_PIX_LIMIT;
+   memset(pixtable, 0, pixlimit*sizeof(int));
 
    tdbl = (lfsparms->percentile_min_max/100.0) * (double)(numpix-1);
    tdbl = trunc_dbl_precision(tdbl, TRUNC_SCALE);
@@ -233,7 +236,7 @@ int low_contrast_block(const int blkoffset, const int blocksize,
    pi = 0;
    pixsum = 0;
    found = FALSE;
-   while(pi < IMG_6BIT_PIX_LIMIT){
+   while(pi < pixlimit){
       pixsum += pixtable[pi];
       if(pixsum >= prctthresh){
          prctmin = pi;
@@ -248,7 +251,7 @@ int low_contrast_block(const int blkoffset, const int blocksize,
       return(-510);
    }
 
-   pi = IMG_6BIT_PIX_LIMIT-1;
+   pi = pixlimit-1;
    pixsum = 0;
    found = FALSE;
    while(pi >= 0){
@@ -274,6 +277,75 @@ int low_contrast_block(const int blkoffset, const int blocksize,
       return(FALSE);
 }
 
+/*************************************************************************
+**************************************************************************
+#cat: low_variance_block - Takes the offset to an image block of specified
+#cat:             dimension, and determines from the summed-area tables of
+#cat:             the image if the variance of its pixel intensities is too
+#cat:             small for low_contrast_block() to find sufficient
+#cat:             contrast.  If so, the block is low contrast without
+#cat:             having to be analyzed.  If not, nothing is known.
+
+   A block has sufficient contrast if, among its N pixels, at least T are
+   at most some intensity A and at least T are at least A+D, where T is
+   the percentile count and D the minimum contrast delta.  Its variance
+   is then at least T*D*D/(2*N), reached with T pixels at A, T at A+D and
+   the others at A+D/2.
+
+   Input:
+      blkoffset - byte offset into the padded input image to the origin of
+                  the block to be analyzed
+      blocksize - dimension (in pixels) of the width and height of the block
+      isums     - summed-area table of the pixel intensities of the padded
+                  input image, (pw+1) by (ph+1) entries
+      isqrs     - summed-area table of the squared pixel intensities
+      pw        - width (in pixels) of the padded input image
+      ph        - height (in pixels) of the padded input image
+      lfsparms  - parameters and thresholds for controlling LFS
+   Return Code:
+      TRUE     - block is known to have low contrast
+      FALSE    - block needs to be analyzed by low_contrast_block()
+**************************************************************************/
+int low_variance_block(const int blkoffset, const int blocksize,
+                       const double *isums, const double *isqrs,
+                       const int pw, const int ph, const LFSPARMS *lfsparms)
+{
+   int bx, by, tw, i00, i01, i10, i11;
+   int numpix, prctthresh;
+   double tdbl, sum, sqr, delta2;
+
+   bx = blkoffset % pw;
+   by = blkoffset / pw;
+   /* If the block is not entirely inside the image, nothing is known. */
+   if((bx + blocksize > pw) || (by + blocksize > ph))
+      return(FALSE);
+
+   /* Compute the percentile pixel count as low_contrast_block() does. */
+   numpix = blocksize*blocksize;
+   tdbl = (lfsparms->percentile_min_max/100.0) * (double)(numpix-1);
+   tdbl = trunc_dbl_precision(tdbl, TRUNC_SCALE);
+   prctthresh = sround(tdbl);
+
+   /* Sum the intensities and squared intensities of the block. */
+   tw = pw + 1;
+   i00 = (by * tw) + bx;
+   i01 = i00 + blocksize;
+   i10 = i00 + (blocksize * tw);
+   i11 = i10 + blocksize;
+   sum = isums[i11] - isums[i01] - isums[i10] + isums[i00];
+   sqr = isqrs[i11] - isqrs[i01] - isqrs[i10] + isqrs[i00];
+
+   /* The sums are integers well within the precision of doubles, so */
+   /* the test is exact: 2*N*N*variance < N*T*D*D.                   */
+   delta2 = (double)lfsparms->min_contrast_delta *
+            (double)lfsparms->min_contrast_delta;
+   if(2.0 * ((numpix * sqr) - (sum * sum)) <
+      (double)numpix * (double)prctthresh * delta2)
+      return(TRUE);
+
+   return(FALSE);
+}
+
 /*************************************************************************
 **************************************************************************
 #cat: find_valid_block - Take a Direction Map, Low Contrast Map,
@@ -374,3 +446,61 @@ void set_margin_blocks(int *map, const int mw, const int mh,
 
 }
 
+/*************************************************************************
+**************************************************************************
+#cat: valid_block_bounds - Takes a Direction Map and determines the
+#cat:             bounding box (in pixels) of its blocks with VALID
+#cat:             direction.  All the pixels outside the box belong to
+#cat:             blocks with INVALID direction.
+
+   Input:
+      direction_map - map of blocks to be analyzed
+      mw        - number of blocks horizontally in the map
+      mh        - number of blocks vertically in the map
+      blocksize - dimension (in pixels) of each block
+      iw        - width (in pixels) of the image
+      ih        - height (in pixels) of the image
+   Output:
+      osx       - left column of the box
+      osy       - top row of the box
+      oex       - column one past the right of the box
+      oey       - row one past the bottom of the box
+                  (the box is empty if there are no VALID blocks)
+**************************************************************************/
+void valid_block_bounds(int *osx, int *osy, int *oex, int *oey,
+                        const int *direction_map, const int mw, const int mh,
+                        const int blocksize, const int iw, const int ih)
+{
+   int bx, by, minbx, minby, maxbx, maxby;
+   const int *mptr;
+
+   minbx = mw;
+   minby = mh;
+   maxbx = -1;
+   maxby = -1;
+   mptr = direction_map;
+   for(by = 0; by < mh; by++){
+      for(bx = 0; bx < mw; bx++){
+         if(*mptr++ != INVALID_DIR){
+            minbx = min(minbx, bx);
+            maxbx = max(maxbx, bx);
+            minby = min(minby, by);
+            maxby = by;
+         }
+      }
+   }
+
+   /* If no block has VALID direction, return an empty box. */
+   if(maxby < 0){
+      *osx = 0;
+      *osy = 0;
+      *oex = 0;
+      *oey = 0;
+      return;
+   }
+
+   *osx = minbx * blocksize;
+   *osy = minby * blocksize;
+   *oex = min((maxbx + 1) * blocksize, iw);
+   *oey = min((maxby + 1) * blocksize, ih);
+}
@@ -88,7 +88,7 @@ int allocate_contour(int **ocontour_x, int **ocontour_y,
    int *contour_x, *contour_y, *contour_ex, *contour_ey;
 
    /* Allocate contour's x-coord list. */
-   contour_x = (int *)malloc(ncontour*sizeof(int));
+   contour_x = (int *)lfs_malloc(ncontour*sizeof(int));
    /* If allocation error... */
    if(contour_x == (int *)NULL){
       fprintf(stderr, "ERROR : allocate_contour : malloc : contour_x\n");
@@ -96,34 +96,34 @@ int allocate_contour(int **ocontour_x, int **ocontour_y,
    }
 
    /* Allocate contour's y-coord list. */
-   contour_y = (int *)malloc(ncontour*sizeof(int));
+   contour_y = (int *)lfs_malloc(ncontour*sizeof(int));
    /* If allocation error... */
    if(contour_y == (int *)NULL){
       /* Deallocate memory allocated to this point in this routine. */
-      free(contour_x);
+      lfs_free(contour_x);
       fprintf(stderr, "ERROR : allocate_contour : malloc : contour_y\n");
       return(-181);
    }
 
    /* Allocate contour's edge x-coord list. */
-   contour_ex = (int *)malloc(ncontour*sizeof(int));
+   contour_ex = (int *)lfs_malloc(ncontour*sizeof(int));
    /* If allocation error... */
    if(contour_ex == (int *)NULL){
       /* Deallocate memory allocated to this point in this routine. */
-      free(contour_x);
-      free(contour_y);
+      lfs_free(contour_x);
+      lfs_free(contour_y);
       fprintf(stderr, "ERROR : allocate_contour : malloc : contour_ex\n");
       return(-182);
    }
 
    /* Allocate contour's edge y-coord list. */
-   contour_ey = (int *)malloc(ncontour*sizeof(int));
+   contour_ey = (int *)lfs_malloc(ncontour*sizeof(int));
    /* If allocation error... */
    if(contour_ey == (int *)NULL){
       /* Deallocate memory allocated to this point in this routine. */
-      free(contour_x);
-      free(contour_y);
-      free(contour_ex);
+      lfs_free(contour_x);
+      lfs_free(contour_y);
+      lfs_free(contour_ex);
       fprintf(stderr, "ERROR : allocate_contour : malloc : contour_ey\n");
       return(-183);
    }
@@ -159,10 +159,10 @@ int allocate_contour(int **ocontour_x, int **ocontour_y,
 void free_contour(int *contour_x, int *contour_y,
                   int *contour_ex, int *contour_ey)
 {
-   free(contour_x);
-   free(contour_y);
-   free(contour_ex);
-   free(contour_ey);
+   lfs_free(contour_x);
+   lfs_free(contour_y);
+   lfs_free(contour_ex);
+   lfs_free(contour_ey);
 }
 
 /*************************************************************************
@@ -36,6 +36,9 @@ identified are necessarily the best available for the purpose.
 ***********************************************************************
                ROUTINES:
                         lfs_detect_minutiae_V2()
+                        get_arena_minutiae()
+                        get_minutiae_flags()
+                        get_minutiae_ctx()
                         get_minutiae()
 
 ***********************************************************************/
@@ -60,6 +63,7 @@ identified are necessarily the best available for the purpose.
       iw        - width (in pixels) of the image
       ih        - height (in pixels) of the image
       lfsparms  - parameters and thresholds for controlling LFS
+      lfsctx    - lookup tables built for the image size and lfsparms
 
    Output:
       ominutiae - resulting list of minutiae
@@ -86,18 +90,15 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
                         int *omw, int *omh,
                         unsigned char **obdata, int *obw, int *obh,
                         unsigned char *idata, const int iw, const int ih,
-                        const LFSPARMS *lfsparms)
+                        const LFSPARMS *lfsparms, const LFSCTX *lfsctx)
 {
    unsigned char *pdata, *bdata;
    int pw, ph, bw, bh;
-   DIR2RAD *dir2rad;
-   DFTWAVES *dftwaves;
-   ROTGRIDS *dftgrids;
-   ROTGRIDS *dirbingrids;
    int *direction_map, *low_contrast_map, *low_flow_map, *high_curve_map;
    int mw, mh;
    int ret, maxpad;
    MINUTIAE *minutiae;
+   LFSPARMS mapparms;
 
    /******************/
    /* INITIALIZATION */
@@ -108,58 +109,21 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
       /* If system error, exit with error code. */
       return(ret);
 
-   /* Determine the maximum amount of image padding required to support */
-   /* LFS processes.                                                    */
-   maxpad = get_max_padding_V2(lfsparms->windowsize, lfsparms->windowoffset,
-                          lfsparms->dirbin_grid_w, lfsparms->dirbin_grid_h);
-
-   /* Initialize lookup table for converting integer directions */
-   /* to angles in radians.                                     */
-   if((ret = init_dir2rad(&dir2rad, lfsparms->num_directions))){
-      /* Free memory allocated to this point. */
-      return(ret);
-   }
-
-   /* Initialize wave form lookup tables for DFT analyses. */
-   /* used for direction binarization.                             */
-   if((ret = init_dftwaves(&dftwaves, g_dft_coefs, lfsparms->num_dft_waves,
-                        lfsparms->windowsize))){
-      /* Free memory allocated to this point. */
-      free_dir2rad(dir2rad);
-      return(ret);
-   }
-
-   /* Initialize lookup table for pixel offsets to rotated grids */
-   /* used for DFT analyses.                                     */
-   if((ret = init_rotgrids(&dftgrids, iw, ih, maxpad,
-                        lfsparms->start_dir_angle, lfsparms->num_directions,
-                        lfsparms->windowsize, lfsparms->windowsize,
-                        RELATIVE2ORIGIN))){
-      /* Free memory allocated to this point. */
-      free_dir2rad(dir2rad);
-      free_dftwaves(dftwaves);
-      return(ret);
-   }
+   /* The lookup tables come from the context, built for images of */
+   /* this size.                                                   */
+   maxpad = lfsctx->maxpad;
 
    /* Pad input image based on max padding. */
    if(maxpad > 0){   /* May not need to pad at all */
       if((ret = pad_uchar_image(&pdata, &pw, &ph, idata, iw, ih,
                              maxpad, lfsparms->pad_value))){
-         /* Free memory allocated to this point. */
-         free_dir2rad(dir2rad);
-         free_dftwaves(dftwaves);
-         free_rotgrids(dftgrids);
          return(ret);
       }
    }
    else{
       /* If padding is unnecessary, then copy the input image. */
-      pdata = (unsigned char *)malloc(iw*ih);
+      pdata = (unsigned char *)lfs_malloc(iw*ih);
       if(pdata == (unsigned char *)NULL){
-         /* Free memory allocated to this point. */
-         free_dir2rad(dir2rad);
-         free_dftwaves(dftwaves);
-         free_rotgrids(dftgrids);
          fprintf(stderr, "ERROR : lfs_detect_minutiae_V2 : malloc : pdata\n");
          return(-580);
       }
@@ -168,13 +132,24 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
       ph = ih;
    }
 
-   /* Scale input image to 6 bits [0..63] */
-   /* !!! Would like to remove this dependency eventualy !!!     */
-   /* But, the DFT computations will need to be changed, and     */
-   /* could not get this work upon first attempt. Also, if not   */
-   /* careful, I think accumulated power magnitudes may overflow */
-   /* doubles.                                                   */
-   bits_8to6(pdata, pw, ph);
+   /* If maps are generated at full precision ... */
+   mapparms = *lfsparms;
+   if(lfsparms->full_precision){
+      /* Keep the 8-bit pixels, and scale the intensity thresholds  */
+      /* given for 6-bit pixels: contrast by 4, DFT powers by 16.   */
+      mapparms.min_contrast_delta *= 4;
+      mapparms.powmax_min *= 16.0;
+      mapparms.powmax_max *= 16.0;
+   }
+   else{
+      /* Scale input image to 6 bits [0..63] */
+      /* !!! Would like to remove this dependency eventualy !!!     */
+      /* But, the DFT computations will need to be changed, and     */
+      /* could not get this work upon first attempt. Also, if not   */
+      /* careful, I think accumulated power magnitudes may overflow */
+      /* doubles.                                                   */
+      bits_8to6(pdata, pw, ph);
+   }
 
    print2log("\nINITIALIZATION AND PADDING DONE\n");
 
@@ -185,18 +160,13 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
    /* Generate block maps from the input image. */
    if((ret = gen_image_maps(&direction_map, &low_contrast_map,
                     &low_flow_map, &high_curve_map, &mw, &mh,
-                    pdata, pw, ph, dir2rad, dftwaves, dftgrids, lfsparms))){
+                    pdata, pw, ph, lfsctx->dir2rad, lfsctx->dftwaves,
+                    lfsctx->dftgrids, &mapparms,
+                    lfsctx->parallel, lfsctx->parallel_data))){
       /* Free memory allocated to this point. */
-      free_dir2rad(dir2rad);
-      free_dftwaves(dftwaves);
-      free_rotgrids(dftgrids);
-      free(pdata);
+      lfs_free(pdata);
       return(ret);
    }
-   /* Deallocate working memories. */
-   free_dir2rad(dir2rad);
-   free_dftwaves(dftwaves);
-   free_rotgrids(dftgrids);
 
    print2log("\nMAPS DONE\n");
 
@@ -204,48 +174,30 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
    /* BINARIZARION   */
    /******************/
 
-   /* Initialize lookup table for pixel offsets to rotated grids */
-   /* used for directional binarization.                         */
-   if((ret = init_rotgrids(&dirbingrids, iw, ih, maxpad,
-                        lfsparms->start_dir_angle, lfsparms->num_directions,
-                        lfsparms->dirbin_grid_w, lfsparms->dirbin_grid_h,
-                        RELATIVE2CENTER))){
-      /* Free memory allocated to this point. */
-      free(pdata);
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
-      free(high_curve_map);
-      return(ret);
-   }
-
    /* Binarize input image based on NMAP information. */
    if((ret = binarize_V2(&bdata, &bw, &bh,
                       pdata, pw, ph, direction_map, mw, mh,
-                      dirbingrids, lfsparms))){
+                      lfsctx->dirbingrids, &mapparms,
+                      lfsctx->parallel, lfsctx->parallel_data))){
       /* Free memory allocated to this point. */
-      free(pdata);
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
-      free(high_curve_map);
-      free_rotgrids(dirbingrids);
+      lfs_free(pdata);
+      lfs_free(direction_map);
+      lfs_free(low_contrast_map);
+      lfs_free(low_flow_map);
+      lfs_free(high_curve_map);
       return(ret);
    }
 
-   /* Deallocate working memory. */
-   free_rotgrids(dirbingrids);
-
    /* Check dimension of binary image.  If they are different from */
    /* the input image, then ERROR.                                 */
    if((iw != bw) || (ih != bh)){
       /* Free memory allocated to this point. */
-      free(pdata);
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
-      free(high_curve_map);
-      free(bdata);
+      lfs_free(pdata);
+      lfs_free(direction_map);
+      lfs_free(low_contrast_map);
+      lfs_free(low_flow_map);
+      lfs_free(high_curve_map);
+      lfs_free(bdata);
       fprintf(stderr, "ERROR : lfs_detect_minutiae_V2 :");
       fprintf(stderr,"binary image has bad dimensions : %d, %d\n",
               bw, bh);
@@ -272,12 +224,12 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
                              direction_map, low_flow_map, high_curve_map,
                              mw, mh, lfsparms))){
       /* Free memory allocated to this point. */
-      free(pdata);
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
-      free(high_curve_map);
-      free(bdata);
+      lfs_free(pdata);
+      lfs_free(direction_map);
+      lfs_free(low_contrast_map);
+      lfs_free(low_flow_map);
+      lfs_free(high_curve_map);
+      lfs_free(bdata);
       return(ret);
    }
 
@@ -285,12 +237,12 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
                        direction_map, low_flow_map, high_curve_map, mw, mh,
                        lfsparms))){
       /* Free memory allocated to this point. */
-      free(pdata);
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
-      free(high_curve_map);
-      free(bdata);
+      lfs_free(pdata);
+      lfs_free(direction_map);
+      lfs_free(low_contrast_map);
+      lfs_free(low_flow_map);
+      lfs_free(high_curve_map);
+      lfs_free(bdata);
       free_minutiae(minutiae);
       return(ret);
    }
@@ -302,11 +254,11 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
    /******************/
    if((ret = count_minutiae_ridges(minutiae, bdata, iw, ih, lfsparms))){
       /* Free memory allocated to this point. */
-      free(pdata);
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
-      free(high_curve_map);
+      lfs_free(pdata);
+      lfs_free(direction_map);
+      lfs_free(low_contrast_map);
+      lfs_free(low_flow_map);
+      lfs_free(high_curve_map);
       free_minutiae(minutiae);
       return(ret);
    }
@@ -323,7 +275,7 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
    gray2bin(1, 255, 0, bdata, iw, ih);
 
    /* Deallocate working memory. */
-   free(pdata);
+   lfs_free(pdata);
 
    /* Assign results to output pointers. */
    *odmap = direction_map;
@@ -346,10 +298,86 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
 
 /*************************************************************************
 **************************************************************************
-#cat:   get_minutiae - Takes a grayscale fingerprint image, binarizes the input
-#cat:                image, and detects minutiae points using LFS Version 2.
-#cat:                The routine passes back the detected minutiae, the
-#cat:                binarized image, and a set of image quality maps.
+#cat: get_arena_minutiae - Detects minutiae and builds the image quality
+#cat:                maps for get_minutiae_flags(), while the working memory
+#cat:                is allocated from an arena.  Nothing needs to be
+#cat:                deallocated on error, since the arena is reset.  The
+#cat:                integrated quality map is only built if it or the
+#cat:                reliability of the minutiae is requested, which
+#cat:                LFS_OUT_RELIABILITY_IF_OVER does once the minutiae
+#cat:                are counted, while the other maps are still at hand.
+
+   Input and Output as for get_minutiae_flags(), less obd.
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+static int get_arena_minutiae(MINUTIAE **ominutiae, int **oquality_map,
+                 int **odirection_map, int **olow_contrast_map,
+                 int **olow_flow_map, int **ohigh_curve_map,
+                 int *omap_w, int *omap_h,
+                 unsigned char **obdata, int *obw, int *obh,
+                 unsigned char *idata, const int iw, const int ih,
+                 const int id, const double ppmm, const LFSPARMS *lfsparms,
+                 const LFSCTX *lfsctx, const int outputs)
+{
+   int ret, wanted;
+
+   /* Detect minutiae in grayscale fingerpeint image. */
+   if((ret = lfs_detect_minutiae_V2(ominutiae,
+                                   odirection_map, olow_contrast_map,
+                                   olow_flow_map, ohigh_curve_map,
+                                   omap_w, omap_h,
+                                   obdata, obw, obh,
+                                   idata, iw, ih, lfsparms, lfsctx))){
+      return(ret);
+   }
+
+   /* Assign reliability from the quality map if there are more */
+   /* minutiae than the cap.                                     */
+   wanted = outputs;
+   if((outputs & LFS_OUT_RELIABILITY_IF_OVER) &&
+      (*ominutiae)->num > lfsctx->reliability_cap)
+      wanted |= LFS_OUT_RELIABILITY;
+
+   *oquality_map = (int *)NULL;
+   if(!(wanted & (LFS_OUT_QUALITY_MAP | LFS_OUT_RELIABILITY)))
+      return(0);
+
+   /* Build integrated quality map. */
+   if((ret = gen_quality_map(oquality_map,
+                            *odirection_map, *olow_contrast_map,
+                            *olow_flow_map, *ohigh_curve_map,
+                            *omap_w, *omap_h))){
+      return(ret);
+   }
+
+   if(!(wanted & LFS_OUT_RELIABILITY))
+      return(0);
+
+   /* Assign reliability from quality map. */
+   if((ret = combined_minutia_quality(*ominutiae, *oquality_map,
+                                     *omap_w, *omap_h, lfsparms->blocksize,
+                                     idata, iw, ih, id, ppmm))){
+      return(ret);
+   }
+
+   /* Return normally. */
+   return(0);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: get_minutiae_flags - Takes a grayscale fingerprint image, binarizes
+#cat:                the input image, and detects minutiae points using LFS
+#cat:                Version 2, with lookup tables from an LFS context.
+#cat:                The routine passes back the detected minutiae, and
+#cat:                those of the binarized image and the image quality
+#cat:                maps that are requested by a mask of LFS_OUT_* flags.
+#cat:                The working memory is allocated from the arena of
+#cat:                the LFS context, or from one set up for this image,
+#cat:                and the arena is reset before returning.  Only the
+#cat:                requested results are copied out of the arena.
 
    Input:
       idata    - grayscale fingerprint image data
@@ -358,6 +386,8 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
       id       - pixel depth (in bits) of the grayscale image
       ppmm     - the scan resolution (in pixels/mm) of the grayscale image
       lfsparms - parameters and thresholds for controlling LFS
+      lfsctx   - lookup tables from init_lfsctx() for iw, ih and lfsparms
+      outputs  - LFS_OUT_* flags of the outputs to pass back
    Output:
       ominutiae         - points to a structure containing the
                           detected minutiae
@@ -372,24 +402,36 @@ static int lfs_detect_minutiae_V2(MINUTIAE **ominutiae,
       obw      - width (in pixels) of binarized image
       obh      - height (in pixels) of binarized image
       obd      - pixel depth (in bits) of binarized image
+      Maps that are not requested are set to NULL, as is obdata if the
+      binarized image is not requested.  The output pointers for them,
+      and for their dimensions, may be NULL.
    Return Code:
       Zero     - successful completion
       Negative - system error
 **************************************************************************/
-int get_minutiae(MINUTIAE **ominutiae, int **oquality_map,
+int get_minutiae_flags(MINUTIAE **ominutiae, int **oquality_map,
                  int **odirection_map, int **olow_contrast_map,
                  int **olow_flow_map, int **ohigh_curve_map,
                  int *omap_w, int *omap_h,
                  unsigned char **obdata, int *obw, int *obh, int *obd,
                  unsigned char *idata, const int iw, const int ih,
-                 const int id, const double ppmm, const LFSPARMS *lfsparms)
+                 const int id, const double ppmm, const LFSPARMS *lfsparms,
+                 const LFSCTX *lfsctx, const int outputs)
 {
-   int ret;
-   MINUTIAE *minutiae = NULL;
-   int *direction_map = NULL, *low_contrast_map = NULL, *low_flow_map = NULL;
-   int *high_curve_map = NULL, *quality_map = NULL;
+   int ret, i;
+   LFSARENA *arena, *prev_arena;
+   MINUTIAE *minutiae = NULL, *ominutiae_copy = NULL;
+   int *maps[5] = { NULL, NULL, NULL, NULL, NULL };
+   int *omaps[5] = { NULL, NULL, NULL, NULL, NULL };
+   int **omap_ptrs[5];
+   /* LFS_OUT_* flag of each of the maps. */
+   static const int map_flags[5] = { LFS_OUT_QUALITY_MAP,
+                                     LFS_OUT_DIRECTION_MAP,
+                                     LFS_OUT_LOW_CONTRAST_MAP,
+                                     LFS_OUT_LOW_FLOW_MAP,
+                                     LFS_OUT_HIGH_CURVE_MAP };
    int map_w = 0, map_h = 0;
-   unsigned char *bdata = NULL;
+   unsigned char *bdata = NULL, *obdata_copy = NULL;
    int bw = 0, bh = 0;
 
    /* If input image is not 8-bit grayscale ... */
@@ -399,57 +441,159 @@ int get_minutiae(MINUTIAE **ominutiae, int **oquality_map,
       return(-2);
    }
 
-   /* Detect minutiae in grayscale fingerpeint image. */
-   if((ret = lfs_detect_minutiae_V2(&minutiae,
-                                   &direction_map, &low_contrast_map,
-                                   &low_flow_map, &high_curve_map,
-                                   &map_w, &map_h,
-                                   &bdata, &bw, &bh,
-                                   idata, iw, ih, lfsparms))){
-      return(ret);
+   /* If the lookup tables were built for other images ... */
+   if(!lfsctx_matches(lfsctx, iw, ih, lfsparms)){
+      fprintf(stderr, "ERROR : get_minutiae_flags : LFS context built for ");
+      fprintf(stderr, "%d x %d image does not apply.\n",
+              lfsctx->iw, lfsctx->ih);
+      return(-3);
    }
 
-   /* Build integrated quality map. */
-   if((ret = gen_quality_map(&quality_map,
-                            direction_map, low_contrast_map,
-                            low_flow_map, high_curve_map, map_w, map_h))){
-      free_minutiae(minutiae);
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
-      free(high_curve_map);
-      free(bdata);
-      return(ret);
+   /* Use the arena of the context, or set one up for this image. */
+   arena = lfsctx->arena;
+   if(arena == (LFSARENA *)NULL){
+      if((ret = init_lfsarena(&arena, LFS_ARENA_BLKSIZE)))
+         return(ret);
    }
 
-   /* Assign reliability from quality map. */
-   if((ret = combined_minutia_quality(minutiae, quality_map, map_w, map_h,
-                                     lfsparms->blocksize,
-                                     idata, iw, ih, id, ppmm))){
-      free_minutiae(minutiae);
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
-      free(high_curve_map);
-      free(quality_map);
-      free(bdata);
+   prev_arena = set_lfsarena(arena);
+   ret = get_arena_minutiae(&minutiae, &maps[0], &maps[1], &maps[2],
+                            &maps[3], &maps[4], &map_w, &map_h,
+                            &bdata, &bw, &bh, idata, iw, ih, id, ppmm,
+                            lfsparms, lfsctx, outputs);
+   set_lfsarena(prev_arena);
+
+   /* Copy the requested results out of the arena. */
+   if(ret == 0)
+      ret = copy_minutiae(&ominutiae_copy, minutiae);
+   if(ret == 0){
+      for(i = 0; i < 5; i++){
+         if(!(outputs & map_flags[i]))
+            continue;
+         omaps[i] = (int *)lfs_malloc(map_w * map_h * sizeof(int));
+         if(omaps[i] == (int *)NULL){
+            fprintf(stderr, "ERROR : get_minutiae_flags : malloc : map\n");
+            ret = -720;
+            break;
+         }
+         memcpy(omaps[i], maps[i], map_w * map_h * sizeof(int));
+      }
+   }
+   if(ret == 0 && (outputs & LFS_OUT_BINARIZED)){
+      obdata_copy = (unsigned char *)lfs_malloc(bw * bh);
+      if(obdata_copy == (unsigned char *)NULL){
+         fprintf(stderr, "ERROR : get_minutiae_flags : malloc : bdata\n");
+         ret = -721;
+      }
+      else
+         memcpy(obdata_copy, bdata, bw * bh);
+   }
+
+   /* Release all the working memory at once. */
+   if(arena == lfsctx->arena)
+      reset_lfsarena(arena);
+   else
+      free_lfsarena(arena);
+
+   if(ret){
+      /* Free the results copied to this point. */
+      if(ominutiae_copy != (MINUTIAE *)NULL)
+         free_minutiae(ominutiae_copy);
+      for(i = 0; i < 5; i++)
+         lfs_free(omaps[i]);
       return(ret);
    }
 
    /* Set output pointers. */
-   *ominutiae = minutiae;
-   *oquality_map = quality_map;
-   *odirection_map = direction_map;
-   *olow_contrast_map = low_contrast_map;
-   *olow_flow_map = low_flow_map;
-   *ohigh_curve_map = high_curve_map;
-   *omap_w = map_w;
-   *omap_h = map_h;
-   *obdata = bdata;
-   *obw = bw;
-   *obh = bh;
-   *obd = id;
+   *ominutiae = ominutiae_copy;
+   omap_ptrs[0] = oquality_map;
+   omap_ptrs[1] = odirection_map;
+   omap_ptrs[2] = olow_contrast_map;
+   omap_ptrs[3] = olow_flow_map;
+   omap_ptrs[4] = ohigh_curve_map;
+   for(i = 0; i < 5; i++){
+      if(omap_ptrs[i] != (int **)NULL)
+         *omap_ptrs[i] = omaps[i];
+   }
+   if(omap_w != (int *)NULL)
+      *omap_w = map_w;
+   if(omap_h != (int *)NULL)
+      *omap_h = map_h;
+   if(obdata != (unsigned char **)NULL)
+      *obdata = obdata_copy;
+   if(obw != (int *)NULL)
+      *obw = bw;
+   if(obh != (int *)NULL)
+      *obh = bh;
+   if(obd != (int *)NULL)
+      *obd = id;
 
    /* Return normally. */
    return(0);
 }
+
+/*************************************************************************
+**************************************************************************
+#cat:   get_minutiae_ctx - Takes a grayscale fingerprint image, binarizes the
+#cat:                input image, and detects minutiae points using LFS
+#cat:                Version 2, with lookup tables from an LFS context.
+#cat:                The routine passes back the detected minutiae, the
+#cat:                binarized image, and a set of image quality maps.
+
+   Input and Output as for get_minutiae_flags(), less outputs.
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+int get_minutiae_ctx(MINUTIAE **ominutiae, int **oquality_map,
+                 int **odirection_map, int **olow_contrast_map,
+                 int **olow_flow_map, int **ohigh_curve_map,
+                 int *omap_w, int *omap_h,
+                 unsigned char **obdata, int *obw, int *obh, int *obd,
+                 unsigned char *idata, const int iw, const int ih,
+                 const int id, const double ppmm, const LFSPARMS *lfsparms,
+                 const LFSCTX *lfsctx)
+{
+   return(get_minutiae_flags(ominutiae, oquality_map, odirection_map,
+                             olow_contrast_map, olow_flow_map,
+                             ohigh_curve_map, omap_w, omap_h,
+                             obdata, obw, obh, obd, idata, iw, ih, id, ppmm,
+                             lfsparms, lfsctx, LFS_OUT_ALL));
+}
+
+/*************************************************************************
+**************************************************************************
+#cat:   get_minutiae - Takes a grayscale fingerprint image, binarizes the input
+#cat:                image, and detects minutiae points using LFS Version 2.
+#cat:                The routine passes back the detected minutiae, the
+#cat:                binarized image, and a set of image quality maps.
+#cat:                The lookup tables are built for this image alone; use
+#cat:                get_minutiae_ctx() to reuse them across images.
+
+   Input and Output as for get_minutiae_ctx(), less lfsctx.
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+int get_minutiae(MINUTIAE **ominutiae, int **oquality_map,
+                 int **odirection_map, int **olow_contrast_map,
+                 int **olow_flow_map, int **ohigh_curve_map,
+                 int *omap_w, int *omap_h,
+                 unsigned char **obdata, int *obw, int *obh, int *obd,
+                 unsigned char *idata, const int iw, const int ih,
+                 const int id, const double ppmm, const LFSPARMS *lfsparms)
+{
+   int ret;
+   LFSCTX *lfsctx;
+
+   if((ret = init_lfsctx(&lfsctx, iw, ih, lfsparms)))
+      return(ret);
+
+   ret = get_minutiae_ctx(ominutiae, oquality_map, odirection_map,
+                          olow_contrast_map, olow_flow_map, ohigh_curve_map,
+                          omap_w, omap_h, obdata, obw, obh, obd,
+                          idata, iw, ih, id, ppmm, lfsparms, lfsctx);
+
+   free_lfsctx(lfsctx);
+   return(ret);
+}
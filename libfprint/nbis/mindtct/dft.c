@@ -38,6 +38,9 @@ identified are necessarily the best available for the purpose.
                         dft_dir_powers()
                         sum_rot_block_rows()
                         dft_power()
+                        dft_power_lanes()
+                        dft_power_8bit()
+                        dft_dir_powers_8bit()
                         dft_power_stats()
                         get_max_norm()
                         sort_dft_waves()
@@ -47,6 +50,25 @@ identified are necessarily the best available for the purpose.
 #include <stdlib.h>
 #include <lfs.h>
 
+/* With GCC, the DFT wave forms are applied DFT_LANES at a time using   */
+/* vector extensions; on x86-64 an AVX2 clone of that routine is also   */
+/* built and selected at load time when the CPU supports it.  Each lane */
+/* does the same double precision operations in the same order as      */
+/* dft_power(), so the resulting powers are bit-identical.  Defining    */
+/* DFT_NO_VECTOR builds the scalar routines only, which the map test    */
+/* compares against.                                                    */
+#if defined(__GNUC__) && !defined(DFT_NO_VECTOR)
+#define DFT_VECTOR
+typedef double dft_vec __attribute__((vector_size(DFT_LANES * sizeof(double)),
+                                      aligned(sizeof(double))));
+#endif
+#if defined(DFT_VECTOR) && defined(__x86_64__) && defined(__linux__) && \
+    !defined(__clang__)
+#define DFT_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define DFT_CLONES
+#endif
+
 /*************************************************************************
 **************************************************************************
 #cat: sum_rot_block_rows - Computes a vector or pixel row sums by sampling
@@ -103,6 +125,7 @@ static void sum_rot_block_rows(int *rowsums, const unsigned char *blkptr,
       power   - the computed DFT power for the given wave form at the
                 given orientation within the image block
 **************************************************************************/
+#ifndef DFT_VECTOR
 static void dft_power(double *power, const int *rowsums,
                const DFTWAVE *wave, const int wavelen)
 {
@@ -124,6 +147,51 @@ static void dft_power(double *power, const int *rowsums,
    /* Power is the sum of the squared cos and sin components */
    *power = (cospart * cospart) + (sinpart * sinpart);
 }
+#endif
+
+#ifdef DFT_VECTOR
+/*************************************************************************
+**************************************************************************
+#cat: dft_power_lanes - Computes the DFT powers of a vector of pixel row
+#cat:             sums for all wave forms, applying DFT_LANES of them at
+#cat:             a time from their interleaved copy.
+
+   Input:
+      rowsums  - accumulated rows of pixels from within a rotated grid
+                 overlaying an input image block
+      dftwaves - structure containing the DFT wave forms
+      dir      - the orientation the row sums were computed at
+   Output:
+      powers   - the computed DFT power for each wave form is stored in
+                 powers[wave][dir]
+**************************************************************************/
+DFT_CLONES
+static void dft_power_lanes(double **powers, const int *rowsums,
+               const DFTWAVES *dftwaves, const int dir)
+{
+   int g, i, l;
+   const double *lptr;
+   dft_vec cospart, sinpart, rowsum, power;
+   const dft_vec zero = {0.0};
+
+   lptr = dftwaves->lanes;
+   /* Foreach group of DFT_LANES wave forms ... */
+   for(g = 0; g < dftwaves->nwaves; g += DFT_LANES){
+      cospart = zero;
+      sinpart = zero;
+      /* Accumulate cos and sin components of DFT for each lane. */
+      for(i = 0; i < dftwaves->wavelen; i++){
+         rowsum = zero + (double)rowsums[i];
+         cospart += rowsum * *(const dft_vec *)lptr;
+         sinpart += rowsum * *(const dft_vec *)(lptr + DFT_LANES);
+         lptr += 2 * DFT_LANES;
+      }
+      power = (cospart * cospart) + (sinpart * sinpart);
+      for(l = 0; l < DFT_LANES && g + l < dftwaves->nwaves; l++)
+         powers[g+l][dir] = power[l];
+   }
+}
+#endif
 
 /*************************************************************************
 **************************************************************************
@@ -161,7 +229,10 @@ int dft_dir_powers(double **powers, unsigned char *pdata,
                const int blkoffset, const int pw, const int ph,
                const DFTWAVES *dftwaves, const ROTGRIDS *dftgrids)
 {
-   int w, dir;
+   int dir;
+#ifndef DFT_VECTOR
+   int w;
+#endif
    int *rowsums;
    unsigned char *blkptr;
 
@@ -171,7 +242,7 @@ int dft_dir_powers(double **powers, unsigned char *pdata,
       fprintf(stderr, "ERROR : dft_dir_powers : DFT grids must be square\n");
       return(-90);
    }
-   rowsums = (int *)malloc(dftgrids->grid_w * sizeof(int));
+   rowsums = (int *)lfs_malloc(dftgrids->grid_w * sizeof(int));
    if(rowsums == (int *)NULL){
       fprintf(stderr, "ERROR : dft_dir_powers : malloc : rowsums\n");
       return(-91);
@@ -184,15 +255,104 @@ int dft_dir_powers(double **powers, unsigned char *pdata,
       sum_rot_block_rows(rowsums, blkptr,
                          dftgrids->grids[dir], dftgrids->grid_w);
 
+#ifdef DFT_VECTOR
+      /* Apply all DFT waves, several at a time. */
+      dft_power_lanes(powers, rowsums, dftwaves, dir);
+#else
       /* Foreach DFT wave ... */
       for(w = 0; w < dftwaves->nwaves; w++){
          dft_power(&(powers[w][dir]), rowsums,
                    dftwaves->waves[w], dftwaves->wavelen);
       }
+#endif
    }
 
    /* Deallocate working memory. */
-   free(rowsums);
+   lfs_free(rowsums);
+
+   return(0);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: dft_power_8bit - Computes the DFT power by applying a specific wave
+#cat:             form frequency, in fixed point, to a vector of 8-bit
+#cat:             pixel row sums.  The cos and sin components are summed
+#cat:             exactly in integers, so the sums may be vectorized in any
+#cat:             order.
+
+   Input:
+      rowsums - accumulated rows of 8-bit pixels from within a rotated grid
+                overlaying an input image block
+      qcos    - cos points of the wave form with DFT_QBITS fraction bits,
+                followed by its sin points
+      wavelen - the length of the wave form (must match the height of the
+                image block which is the length of the rowsum vector)
+   Return Code:
+      The computed DFT power, scaled back from fixed point
+**************************************************************************/
+DFT_CLONES
+static double dft_power_8bit(const int *rowsums, const int *qcos,
+               const int wavelen)
+{
+   int i;
+   int cospart, sinpart;
+   const int *qsin = qcos + wavelen;
+
+   /* Accumulate cos and sin components of DFT. */
+   cospart = 0;
+   sinpart = 0;
+   for(i = 0; i < wavelen; i++){
+      cospart += rowsums[i] * qcos[i];
+      sinpart += rowsums[i] * qsin[i];
+   }
+
+   /* Power is the sum of the squared cos and sin components */
+   return(((double)cospart * cospart + (double)sinpart * sinpart) /
+          (double)(1 << (2 * DFT_QBITS)));
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: dft_dir_powers_8bit - Conducts the DFT analysis of dft_dir_powers()
+#cat:         on a block of 8-bit image data, applying the wave forms in
+#cat:         fixed point.
+
+   Input and Output as for dft_dir_powers(), for an 8-bit padded image.
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+int dft_dir_powers_8bit(double **powers, unsigned char *pdata,
+               const int blkoffset, const int pw, const int ph,
+               const DFTWAVES *dftwaves, const ROTGRIDS *dftgrids)
+{
+   int w, dir;
+   int rowsums[MAX_DFT_WINDOW];
+
+   /* This routine requires square block (grid) no larger than the */
+   /* row sum vector, so ERROR otherwise.                          */
+   if(dftgrids->grid_w != dftgrids->grid_h ||
+      dftgrids->grid_w > MAX_DFT_WINDOW){
+      fprintf(stderr,
+              "ERROR : dft_dir_powers_8bit : DFT grids must be square ");
+      fprintf(stderr, "and at most %d pixels\n", MAX_DFT_WINDOW);
+      return(-92);
+   }
+
+   /* Foreach direction ... */
+   for(dir = 0; dir < dftgrids->ngrids; dir++){
+      /* Compute vector of line sums from rotated grid */
+      sum_rot_block_rows(rowsums, pdata + blkoffset,
+                         dftgrids->grids[dir], dftgrids->grid_w);
+
+      /* Foreach DFT wave ... */
+      for(w = 0; w < dftwaves->nwaves; w++){
+         powers[w][dir] = dft_power_8bit(rowsums,
+                             dftwaves->qwaves + (w * 2 * dftwaves->wavelen),
+                             dftwaves->wavelen);
+      }
+   }
 
    return(0);
 }
@@ -278,7 +438,7 @@ static int sort_dft_waves(int *wis, const double *powmaxs, const double *pownorm
    double *pownorms2;
 
    /* Allocate normalized power^2 array */
-   pownorms2 = (double *)malloc(nstats * sizeof(double));
+   pownorms2 = (double *)lfs_malloc(nstats * sizeof(double));
    if(pownorms2 == (double *)NULL){
       fprintf(stderr, "ERROR : sort_dft_waves : malloc : pownorms2\n");
       return(-100);
@@ -295,7 +455,7 @@ static int sort_dft_waves(int *wis, const double *powmaxs, const double *pownorm
    bubble_sort_double_dec_2(pownorms2, wis, nstats);
 
    /* Deallocate the working memory. */
-   free(pownorms2);
+   lfs_free(pownorms2);
 
    return(0);
 }
@@ -36,6 +36,7 @@ identified are necessarily the best available for the purpose.
                         free_dir2rad()
                         free_dftwaves()
                         free_rotgrids()
+                        free_lfsctx()
                         free_dir_powers()
 ***********************************************************************/
 
@@ -75,6 +76,8 @@ void free_dftwaves(DFTWAVES *dftwaves)
        free(dftwaves->waves[i]);
    }
    free(dftwaves->waves);
+   free(dftwaves->lanes);
+   free(dftwaves->qwaves);
    free(dftwaves);
 }
 
@@ -96,6 +99,23 @@ void free_rotgrids(ROTGRIDS *rotgrids)
    free(rotgrids);
 }
 
+/*************************************************************************
+**************************************************************************
+#cat: free_lfsctx - Deallocates the memory associated with an LFSCTX
+#cat:                 structure, including its lookup tables
+
+   Input:
+      lfsctx - pointer to memory to be freed
+**************************************************************************/
+void free_lfsctx(LFSCTX *lfsctx)
+{
+   free_dir2rad(lfsctx->dir2rad);
+   free_dftwaves(lfsctx->dftwaves);
+   free_rotgrids(lfsctx->dftgrids);
+   free_rotgrids(lfsctx->dirbingrids);
+   free(lfsctx);
+}
+
 /*************************************************************************
 **************************************************************************
 #cat: free_dir_powers - Deallocate memory associated with DFT power vectors
@@ -109,8 +129,8 @@ void free_dir_powers(double **powers, const int nwaves)
    int w;
 
    for(w = 0; w < nwaves; w++)
-      free(powers[w]);
+      lfs_free(powers[w]);
 
-   free(powers);
+   lfs_free(powers);
 }
 
@@ -216,7 +216,10 @@ LFSPARMS g_lfsparms_V2 = {
 
    /* Ridge Counting Controls */
    MAX_NBRS,
-   MAX_RIDGE_STEPS
+   MAX_RIDGE_STEPS,
+
+   /* Precision Controls */
+   FALSE                /* full_precision */
 };
 
 /* Variables for conducting 8-connected neighbor analyses. */
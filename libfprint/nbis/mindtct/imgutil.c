@@ -38,7 +38,9 @@ identified are necessarily the best available for the purpose.
                         bits_8to6()
                         gray2bin()
                         pad_uchar_image()
+                        summed_area_tables()
                         fill_holes()
+                        fill_holes_region()
                         free_path()
                         search_in_direction()
 
@@ -183,7 +185,7 @@ int pad_uchar_image(unsigned char **optr, int *ow, int *oh,
    psize = pw * ph;
 
    /* Allocate padded image */
-   pdata = (unsigned char *)malloc(psize * sizeof(unsigned char));
+   pdata = (unsigned char *)lfs_malloc(psize * sizeof(unsigned char));
    if(pdata == (unsigned char *)NULL){
       fprintf(stderr, "ERROR : pad_uchar_image : malloc : pdata\n");
       return(-160);
@@ -207,6 +209,70 @@ int pad_uchar_image(unsigned char **optr, int *ow, int *oh,
    return(0);
 }
 
+/*************************************************************************
+**************************************************************************
+#cat: summed_area_tables - Takes an image and computes the summed-area
+#cat:              tables (integral images) of its pixel intensities and of
+#cat:              their squares.  Entry (x, y) of a table holds the sum
+#cat:              over the pixels above and to the left of pixel (x, y),
+#cat:              so the sum over any rectangle is found from the 4
+#cat:              entries at its corners.
+
+   Input:
+      idata - image data to be summed
+      iw    - width (in pixels) of the image
+      ih    - height (in pixels) of the image
+   Output:
+      osums - points to the (iw+1) by (ih+1) table of intensity sums
+      osqrs - points to the (iw+1) by (ih+1) table of squared intensity
+              sums
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+int summed_area_tables(double **osums, double **osqrs,
+                       const unsigned char *idata, const int iw, const int ih)
+{
+   double *sums, *sqrs;
+   double rsum, rsqr;
+   int ix, iy, tw, pix;
+
+   tw = iw + 1;
+   sums = (double *)lfs_malloc(tw * (ih+1) * sizeof(double));
+   if(sums == (double *)NULL){
+      fprintf(stderr, "ERROR : summed_area_tables : malloc : sums\n");
+      return(-740);
+   }
+   sqrs = (double *)lfs_malloc(tw * (ih+1) * sizeof(double));
+   if(sqrs == (double *)NULL){
+      lfs_free(sums);
+      fprintf(stderr, "ERROR : summed_area_tables : malloc : sqrs\n");
+      return(-741);
+   }
+
+   /* The first row and column of the tables are zero. */
+   memset(sums, 0, tw * sizeof(double));
+   memset(sqrs, 0, tw * sizeof(double));
+   for(iy = 0; iy < ih; iy++){
+      sums[(iy+1) * tw] = 0.0;
+      sqrs[(iy+1) * tw] = 0.0;
+      /* Add the running sums of the row to the entries above. */
+      rsum = 0.0;
+      rsqr = 0.0;
+      for(ix = 0; ix < iw; ix++){
+         pix = idata[(iy * iw) + ix];
+         rsum += pix;
+         rsqr += pix * pix;
+         sums[((iy+1) * tw) + ix + 1] = sums[(iy * tw) + ix + 1] + rsum;
+         sqrs[((iy+1) * tw) + ix + 1] = sqrs[(iy * tw) + ix + 1] + rsqr;
+      }
+   }
+
+   *osums = sums;
+   *osqrs = sqrs;
+   return(0);
+}
+
 /*************************************************************************
 **************************************************************************
 #cat: fill_holes - Takes an input image and analyzes triplets of horizontal
@@ -225,19 +291,50 @@ int pad_uchar_image(unsigned char **optr, int *ow, int *oh,
 **************************************************************************/
 void fill_holes(unsigned char *bdata, const int iw, const int ih)
 {
-   int ix, iy, iw2;
+   fill_holes_region(bdata, iw, ih, 0, 0, iw, ih);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: fill_holes_region - Fills holes of width 1 as fill_holes() does, but
+#cat:              only in a rectangular region of the image.  If all the
+#cat:              pixels outside the region have the same value, the
+#cat:              result is the same as filling the whole image, as none
+#cat:              of them can be a hole.
+
+   Input:
+      bdata - binary image data to be processed
+      iw    - width (in pixels) of the binary input image
+      ih    - height (in pixels) of the binary input image
+      sx    - left column of the region
+      sy    - top row of the region
+      ex    - column one past the right of the region
+      ey    - row one past the bottom of the region
+   Output:
+      bdata - points to the results
+**************************************************************************/
+void fill_holes_region(unsigned char *bdata, const int iw, const int ih,
+                       const int sx, const int sy, const int ex, const int ey)
+{
+   int ix, iy, iw2, fx, fy, lx, ly;
    unsigned char *lptr, *mptr, *rptr, *tptr, *bptr, *sptr;
 
+   /* Middle pixels are never on the border of the image. */
+   fx = max(sx, 1);
+   lx = min(ex, iw-1);
+   fy = max(sy, 1);
+   ly = min(ey, ih-1);
+
    /* 1. Fill 1-pixel wide holes in horizontal runs first ... */
-   sptr = bdata + 1;
-   /* Foreach row in image ... */
-   for(iy = 0; iy < ih; iy++){
+   sptr = bdata + (sy*iw) + fx;
+   /* Foreach row in region ... */
+   for(iy = sy; iy < ey; iy++){
       /* Initialize pointers to start of next line ... */
       lptr = sptr-1;   /* Left pixel   */
       mptr = sptr;     /* Middle pixel */
       rptr = sptr+1;   /* Right pixel  */
-      /* Foreach column in image (less far left and right pixels) ... */
-      for(ix = 1; ix < iw-1; ix++){
+      /* Foreach column in region (less far left and right pixels) ... */
+      for(ix = fx; ix < lx; ix++){
          /* Do we have a horizontal hole of length 1? */
          if((*lptr != *mptr) && (*lptr == *rptr)){
             /* If so, then fill it. */
@@ -263,16 +360,16 @@ void fill_holes(unsigned char *bdata, const int iw, const int ih)
 
    /* 2. Now, fill 1-pixel wide holes in vertical runs ... */
    iw2 = iw<<1;
-   /* Start processing column one row down from the top of the image. */
-   sptr = bdata + iw;
-   /* Foreach column in image ... */
-   for(ix = 0; ix < iw; ix++){
+   /* Start processing column one row down from the top of the region. */
+   sptr = bdata + (fy*iw) + sx;
+   /* Foreach column in region ... */
+   for(ix = sx; ix < ex; ix++){
       /* Initialize pointers to start of next column ... */
       tptr = sptr-iw;   /* Top pixel     */
       mptr = sptr;      /* Middle pixel  */
       bptr = sptr+iw;   /* Bottom pixel  */
-      /* Foreach row in image (less top and bottom row) ... */
-      for(iy = 1; iy < ih-1; iy++){
+      /* Foreach row in region (less top and bottom row) ... */
+      for(iy = fy; iy < ly; iy++){
          /* Do we have a vertical hole of length 1? */
          if((*tptr != *mptr) && (*tptr == *bptr)){
             /* If so, then fill it. */
@@ -347,8 +444,8 @@ int free_path(const int x1, const int y1, const int x2, const int y2,
          /* If number of transitions seen > than threshold (ex. 2) ... */
          if(trans > lfsparms->maxtrans){
             /* Deallocate the line segment's coordinate lists. */
-            free(x_list);
-            free(y_list);
+            lfs_free(x_list);
+            lfs_free(y_list);
             /* Return free path to be FALSE. */
             return(FALSE);
          }
@@ -362,8 +459,8 @@ int free_path(const int x1, const int y1, const int x2, const int y2,
 
    /* If we get here we did not exceed the maximum allowable number        */
    /* of transitions.  So, deallocate the line segment's coordinate lists. */
-   free(x_list);
-   free(y_list);
+   lfs_free(x_list);
+   lfs_free(y_list);
 
    /* Return free path to be TRUE. */
    return(TRUE);
@@ -41,6 +41,8 @@ identified are necessarily the best available for the purpose.
                         init_rotgrids()
                         alloc_dir_powers()
                         alloc_power_stats()
+                        init_lfsctx()
+                        lfsctx_matches()
 ***********************************************************************/
 
 #include <stdio.h>
@@ -140,7 +142,7 @@ int init_dftwaves(DFTWAVES **optr, const double *dft_coefs,
                   const int nwaves, const int blocksize)
 {
    DFTWAVES *dftwaves;
-   int i, j;
+   int i, j, ngroups;
    double pi_factor, freq, x;
    double *cptr, *sptr;
 
@@ -238,6 +240,43 @@ int init_dftwaves(DFTWAVES **optr, const double *dft_coefs,
       }
    }
 
+   /* Allocate and fill the interleaved copy of the wave forms. */
+   dftwaves->qwaves = (int *)NULL;
+   ngroups = (nwaves + DFT_LANES - 1) / DFT_LANES;
+   dftwaves->lanes = (double *)calloc(ngroups * blocksize * 2 * DFT_LANES,
+                                      sizeof(double));
+   if(dftwaves->lanes == (double *)NULL){
+      /* Free memory allocated to this point. */
+      free_dftwaves(dftwaves);
+      fprintf(stderr, "ERROR : init_dftwaves : calloc : dftwaves->lanes\n");
+      return(-25);
+   }
+   for (i = 0; i < nwaves; ++i) {
+      cptr = dftwaves->lanes + (i / DFT_LANES) * blocksize * 2 * DFT_LANES
+             + (i % DFT_LANES);
+      for (j = 0; j < blocksize; ++j) {
+         cptr[j * 2 * DFT_LANES] = dftwaves->waves[i]->cos[j];
+         cptr[j * 2 * DFT_LANES + DFT_LANES] = dftwaves->waves[i]->sin[j];
+      }
+   }
+
+   /* Allocate and fill the fixed point copy of the wave forms. */
+   dftwaves->qwaves = (int *)malloc(nwaves * blocksize * 2 * sizeof(int));
+   if(dftwaves->qwaves == (int *)NULL){
+      /* Free memory allocated to this point. */
+      free_dftwaves(dftwaves);
+      fprintf(stderr, "ERROR : init_dftwaves : malloc : dftwaves->qwaves\n");
+      return(-26);
+   }
+   for (i = 0; i < nwaves; ++i) {
+      for (j = 0; j < blocksize; ++j) {
+         dftwaves->qwaves[(i * 2 * blocksize) + j] =
+                sround(dftwaves->waves[i]->cos[j] * (1 << DFT_QBITS));
+         dftwaves->qwaves[(i * 2 * blocksize) + blocksize + j] =
+                sround(dftwaves->waves[i]->sin[j] * (1 << DFT_QBITS));
+      }
+   }
+
    *optr = dftwaves;
    return(0);
 }
@@ -587,7 +626,7 @@ int alloc_dir_powers(double ***opowers, const int nwaves, const int ndirs)
    double **powers;
 
    /* Allocate list of double pointers to hold power vectors */
-   powers = (double **)malloc(nwaves * sizeof(double*));
+   powers = (double **)lfs_malloc(nwaves * sizeof(double*));
    if(powers == (double **)NULL){
       fprintf(stderr, "ERROR : alloc_dir_powers : malloc : powers\n");
       return(-40);
@@ -595,13 +634,13 @@ int alloc_dir_powers(double ***opowers, const int nwaves, const int ndirs)
    /* Foreach DFT wave ... */
    for(w = 0; w < nwaves; w++){
       /* Allocate power vector for all directions */
-      powers[w] = (double *)malloc(ndirs * sizeof(double));
+      powers[w] = (double *)lfs_malloc(ndirs * sizeof(double));
       if(powers[w] == (double *)NULL){
          /* Free memory allocated to this point. */
          { int _j; for(_j = 0; _j < w; _j++){
-            free(powers[_j]);
+            lfs_free(powers[_j]);
          }}
-         free(powers);
+         lfs_free(powers);
          fprintf(stderr, "ERROR : alloc_dir_powers : malloc : powers[w]\n");
          return(-41);
       }
@@ -646,38 +685,38 @@ int alloc_power_stats(int **owis, double **opowmaxs, int **opowmax_dirs,
    double *powmaxs, *pownorms;
 
    /* Allocate DFT wave index vector */
-   wis = (int *)malloc(nstats * sizeof(int));
+   wis = (int *)lfs_malloc(nstats * sizeof(int));
    if(wis == (int *)NULL){
       fprintf(stderr, "ERROR : alloc_power_stats : malloc : wis\n");
       return(-50);
    }
 
    /* Allocate max power vector */
-   powmaxs = (double *)malloc(nstats * sizeof(double));
+   powmaxs = (double *)lfs_malloc(nstats * sizeof(double));
    if(powmaxs == (double *)NULL){
       /* Free memory allocated to this point. */
-      free(wis);
+      lfs_free(wis);
       fprintf(stderr, "ERROR : alloc_power_stats : malloc : powmaxs\n");
       return(-51);
    }
 
    /* Allocate max power direction vector */
-   powmax_dirs = (int *)malloc(nstats * sizeof(int));
+   powmax_dirs = (int *)lfs_malloc(nstats * sizeof(int));
    if(powmax_dirs == (int *)NULL){
       /* Free memory allocated to this point. */
-      free(wis);
-      free(powmaxs);
+      lfs_free(wis);
+      lfs_free(powmaxs);
       fprintf(stderr, "ERROR : alloc_power_stats : malloc : powmax_dirs\n");
       return(-52);
    }
 
    /* Allocate normalized power vector */
-   pownorms = (double *)malloc(nstats * sizeof(double));
+   pownorms = (double *)lfs_malloc(nstats * sizeof(double));
    if(pownorms == (double *)NULL){
       /* Free memory allocated to this point. */
-      free(wis);
-      free(powmaxs);
-      free(pownorms);
+      lfs_free(wis);
+      lfs_free(powmaxs);
+      lfs_free(pownorms);
       fprintf(stderr, "ERROR : alloc_power_stats : malloc : pownorms\n");
       return(-53);
    }
@@ -689,5 +728,132 @@ int alloc_power_stats(int **owis, double **opowmaxs, int **opowmax_dirs,
    return(0);
 }
 
+/*************************************************************************
+**************************************************************************
+#cat: init_lfsctx - Allocates and initializes the lookup tables needed by
+#cat:               LFS to process images of a given size, so that they
+#cat:               can be shared by all the images of that size.
+
+   Input:
+      iw       - width (in pixels) of the images to be processed
+      ih       - height (in pixels) of the images to be processed
+      lfsparms - parameters and thresholds for controlling LFS
+   Output:
+      optr     - points to the allocated/initialized LFSCTX structure
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+int init_lfsctx(LFSCTX **optr, const int iw, const int ih,
+                const LFSPARMS *lfsparms)
+{
+   LFSCTX *lfsctx;
+   int ret;
+
+   lfsctx = (LFSCTX *)malloc(sizeof(LFSCTX));
+   if(lfsctx == (LFSCTX *)NULL){
+      fprintf(stderr, "ERROR : init_lfsctx : malloc : lfsctx\n");
+      return(-700);
+   }
+
+   lfsctx->iw = iw;
+   lfsctx->ih = ih;
+   lfsctx->num_directions = lfsparms->num_directions;
+   lfsctx->start_dir_angle = lfsparms->start_dir_angle;
+   lfsctx->windowsize = lfsparms->windowsize;
+   lfsctx->windowoffset = lfsparms->windowoffset;
+   lfsctx->num_dft_waves = lfsparms->num_dft_waves;
+   lfsctx->dirbin_grid_w = lfsparms->dirbin_grid_w;
+   lfsctx->dirbin_grid_h = lfsparms->dirbin_grid_h;
+   /* Process all blocks in the calling thread unless the caller */
+   /* installs a runner.                                         */
+   lfsctx->parallel = (LFS_PARALLEL_FUNC)NULL;
+   lfsctx->parallel_data = NULL;
+   /* Set up an arena for each image unless the caller supplies one. */
+   lfsctx->arena = (LFSARENA *)NULL;
+   /* Only LFS_OUT_RELIABILITY assigns reliability unless the caller */
+   /* sets a cap.                                                    */
+   lfsctx->reliability_cap = MAX_MINUTIAE;
+
+   /* Determine the maximum amount of image padding required to support */
+   /* LFS processes.                                                    */
+   lfsctx->maxpad = get_max_padding_V2(lfsparms->windowsize,
+                          lfsparms->windowoffset,
+                          lfsparms->dirbin_grid_w, lfsparms->dirbin_grid_h);
+
+   /* Initialize lookup table for converting integer directions */
+   /* to angles in radians.                                     */
+   if((ret = init_dir2rad(&(lfsctx->dir2rad), lfsparms->num_directions))){
+      /* Free memory allocated to this point. */
+      free(lfsctx);
+      return(ret);
+   }
+
+   /* Initialize wave form lookup tables for DFT analyses. */
+   /* used for direction binarization.                             */
+   if((ret = init_dftwaves(&(lfsctx->dftwaves), g_dft_coefs,
+                        lfsparms->num_dft_waves, lfsparms->windowsize))){
+      /* Free memory allocated to this point. */
+      free_dir2rad(lfsctx->dir2rad);
+      free(lfsctx);
+      return(ret);
+   }
+
+   /* Initialize lookup table for pixel offsets to rotated grids */
+   /* used for DFT analyses.                                     */
+   if((ret = init_rotgrids(&(lfsctx->dftgrids), iw, ih, lfsctx->maxpad,
+                        lfsparms->start_dir_angle, lfsparms->num_directions,
+                        lfsparms->windowsize, lfsparms->windowsize,
+                        RELATIVE2ORIGIN))){
+      /* Free memory allocated to this point. */
+      free_dir2rad(lfsctx->dir2rad);
+      free_dftwaves(lfsctx->dftwaves);
+      free(lfsctx);
+      return(ret);
+   }
+
+   /* Initialize lookup table for pixel offsets to rotated grids */
+   /* used for directional binarization.                         */
+   if((ret = init_rotgrids(&(lfsctx->dirbingrids), iw, ih, lfsctx->maxpad,
+                        lfsparms->start_dir_angle, lfsparms->num_directions,
+                        lfsparms->dirbin_grid_w, lfsparms->dirbin_grid_h,
+                        RELATIVE2CENTER))){
+      /* Free memory allocated to this point. */
+      free_dir2rad(lfsctx->dir2rad);
+      free_dftwaves(lfsctx->dftwaves);
+      free_rotgrids(lfsctx->dftgrids);
+      free(lfsctx);
+      return(ret);
+   }
+
+   *optr = lfsctx;
+   return(0);
+}
 
+/*************************************************************************
+**************************************************************************
+#cat: lfsctx_matches - Determines whether the lookup tables of an LFS
+#cat:               context apply to images of the given size processed
+#cat:               with the given parameters.
 
+   Input:
+      lfsctx   - the LFS context
+      iw       - width (in pixels) of the image
+      ih       - height (in pixels) of the image
+      lfsparms - parameters and thresholds for controlling LFS
+   Return Code:
+      TRUE     - the context can be used
+      FALSE    - a new context must be built
+**************************************************************************/
+int lfsctx_matches(const LFSCTX *lfsctx, const int iw, const int ih,
+                   const LFSPARMS *lfsparms)
+{
+   return((lfsctx->iw == iw) && (lfsctx->ih == ih) &&
+          (lfsctx->num_directions == lfsparms->num_directions) &&
+          (lfsctx->start_dir_angle == lfsparms->start_dir_angle) &&
+          (lfsctx->windowsize == lfsparms->windowsize) &&
+          (lfsctx->windowoffset == lfsparms->windowoffset) &&
+          (lfsctx->num_dft_waves == lfsparms->num_dft_waves) &&
+          (lfsctx->dirbin_grid_w == lfsparms->dirbin_grid_w) &&
+          (lfsctx->dirbin_grid_h == lfsparms->dirbin_grid_h));
+}
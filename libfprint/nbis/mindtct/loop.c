@@ -93,7 +93,7 @@ static int chain_code_loop(int **ochain, int *onchain,
    /* number of points in the contour.  There will be one chain code */
    /* between each point on the contour including a code between the */
    /* last to the first point on the contour (completing the loop).  */
-   chain = (int *)malloc(ncontour * sizeof(int));
+   chain = (int *)lfs_malloc(ncontour * sizeof(int));
    /* If the allocation fails ... */
    if(chain == (int *)NULL){
       fprintf(stderr, "ERROR : chain_code_loop : malloc : chain\n");
@@ -236,7 +236,7 @@ int get_loop_list(int **oonloop, MINUTIAE *minutiae, const int loop_len,
    MINUTIA *minutia;
 
    /* Allocate a list of onloop flags (one for each minutia in list). */
-   onloop = (int *)malloc(minutiae->num * sizeof(int));
+   onloop = (int *)lfs_malloc(minutiae->num * sizeof(int));
    if(onloop == (int *)NULL){
       fprintf(stderr, "ERROR : get_loop_list : malloc : onloop\n");
       return(-320);
@@ -263,7 +263,7 @@ int get_loop_list(int **oonloop, MINUTIAE *minutiae, const int loop_len,
             /* Remove the current minutia from the list. */
             if((ret = remove_minutia(i, minutiae))){
                /* Deallocate working memory. */
-               free(onloop);
+               lfs_free(onloop);
                /* Return error code. */
                return(ret);
             }
@@ -280,7 +280,7 @@ int get_loop_list(int **oonloop, MINUTIAE *minutiae, const int loop_len,
          /* Otherwise, an ERROR occurred while looking for loop. */
          else{
             /* Deallocate working memory. */
-            free(onloop);
+            lfs_free(onloop);
             /* Return error code. */
             return(ret);
          }
@@ -644,7 +644,7 @@ int is_loop_clockwise(const int *contour_x, const int *contour_y,
    ret = is_chain_clockwise(chain, nchain, default_ret);
 
    /* Free the chain code and return result. */
-   free(chain);
+   lfs_free(chain);
    return(ret);
 }
 
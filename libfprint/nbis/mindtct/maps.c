@@ -40,6 +40,7 @@ identified are necessarily the best available for the purpose.
 ***********************************************************************
                ROUTINES:
                         gen_image_maps()
+                        gen_initial_maps_blocks()
                         gen_initial_maps()
                         interpolate_direction_map()
                         morph_TF_map()
@@ -91,6 +92,8 @@ identified are necessarily the best available for the purpose.
       dftwaves  - structure containing the DFT wave forms
       dftgrids  - structure containing the rotated pixel grid offsets
       lfsparms  - parameters and thresholds for controlling LFS
+      parallel  - optional runner for generating the initial maps
+      parallel_data - private data passed to the runner
    Output:
       odmap     - points to the created Direction Map
       olcmap    - points to the created Low Contrast Map
@@ -106,7 +109,8 @@ int gen_image_maps(int **odmap, int **olcmap, int **olfmap, int **ohcmap,
               int *omw, int *omh,
               unsigned char *pdata, const int pw, const int ph,
               const DIR2RAD *dir2rad, const DFTWAVES *dftwaves,
-              const ROTGRIDS *dftgrids, const LFSPARMS *lfsparms)
+              const ROTGRIDS *dftgrids, const LFSPARMS *lfsparms,
+              LFS_PARALLEL_FUNC parallel, void *parallel_data)
 {
    int *direction_map, *low_contrast_map, *low_flow_map, *high_curve_map;
    int mw, mh, iw, ih;
@@ -131,9 +135,10 @@ int gen_image_maps(int **odmap, int **olcmap, int **olfmap, int **ohcmap,
    /* 2. Generate initial Direction Map and Low Contrast Map*/
    if((ret = gen_initial_maps(&direction_map, &low_contrast_map,
                               &low_flow_map, blkoffs, mw, mh,
-                              pdata, pw, ph, dftwaves, dftgrids, lfsparms))){
+                              pdata, pw, ph, dftwaves, dftgrids, lfsparms,
+                              parallel, parallel_data))){
       /* Free memory allocated to this point. */
-      free(blkoffs);
+      lfs_free(blkoffs);
       return(ret);
    }
 
@@ -175,7 +180,7 @@ int gen_image_maps(int **odmap, int **olcmap, int **olfmap, int **ohcmap,
    }
 
    /* Deallocate working memory. */
-   free(blkoffs);
+   lfs_free(blkoffs);
 
    *odmap = direction_map;
    *olcmap = low_contrast_map;
@@ -186,51 +191,51 @@ int gen_image_maps(int **odmap, int **olcmap, int **olfmap, int **ohcmap,
    return(0);
 }
 
+/* Inputs and outputs of gen_initial_maps() shared by the calls to */
+/* gen_initial_maps_blocks() that analyze its blocks.               */
+typedef struct initmapsjob{
+   int *direction_map;
+   int *low_contrast_map;
+   int *low_flow_map;
+   int *blkoffs;
+   int mw;
+   unsigned char *pdata;
+   int pw;
+   int ph;
+   double *isums;             /* summed-area tables of pdata */
+   double *isqrs;
+   const DFTWAVES *dftwaves;
+   const ROTGRIDS *dftgrids;
+   const LFSPARMS *lfsparms;
+} INITMAPSJOB;
+
 /*************************************************************************
 **************************************************************************
-#cat: gen_initial_maps - Creates an initial Direction Map from the given
-#cat:             input image.  It very important that the image be properly
-#cat:             padded so that rotated grids along the boundary of the image
-#cat:             do not access unkown memory.  The rotated grids are used by a
-#cat:             DFT-based analysis to determine the integer directions
-#cat:             in the map. Typically this initial vector of directions will
-#cat:             subsequently have weak or inconsistent directions removed
-#cat:             followed by a smoothing process.  The resulting Direction
-#cat:             Map contains valid directions >= 0 and INVALID values = -1.
-#cat:             This routine also computes and returns 2 other image maps.
-#cat:             The Low Contrast Map flags blocks in the image with
-#cat:             insufficient contrast.  Blocks with low contrast have a
-#cat:             corresponding direction of INVALID in the Direction Map.
-#cat:             The Low Flow Map flags blocks in which the DFT analyses
-#cat:             could not determine a significant ridge flow.  Blocks with
-#cat:             low ridge flow also have a corresponding direction of
-#cat:             INVALID in the Direction Map.
+#cat: gen_initial_maps_blocks - Analyzes a range of image blocks for
+#cat:             gen_initial_maps(), setting their entries in the
+#cat:             Direction, Low Contrast and Low Flow Maps.  It uses its
+#cat:             own working memory, so disjoint ranges may be analyzed
+#cat:             concurrently.
 
    Input:
-      blkoffs   - offsets to the pixel origin of each block in the padded image
-      mw        - number of blocks horizontally in the padded input image
-      mh        - number of blocks vertically in the padded input image
-      pdata     - padded input image data (8 bits [0..256) grayscale)
-      pw        - width (in pixels) of the padded input image
-      ph        - height (in pixels) of the padded input image
-      dftwaves  - structure containing the DFT wave forms
-      dftgrids  - structure containing the rotated pixel grid offsets
-      lfsparms  - parameters and thresholds for controlling LFS
+      arg       - the INITMAPSJOB of the maps being generated
+      first     - index of the first block to analyze
+      last      - index one past the last block to analyze
    Output:
-      odmap     - points to the newly created Direction Map
-      olcmap    - points to the newly created Low Contrast Map
+      arg       - the maps in the INITMAPSJOB are set for blocks
+                  [first, last)
    Return Code:
       Zero     - successful completion
       Negative - system error
 **************************************************************************/
-int gen_initial_maps(int **odmap, int **olcmap, int **olfmap,
-                int *blkoffs, const int mw, const int mh,
-                unsigned char *pdata, const int pw, const int ph,
-                const DFTWAVES *dftwaves, const  ROTGRIDS *dftgrids,
-                const LFSPARMS *lfsparms)
+static int gen_initial_maps_blocks(void *arg, const int first, const int last)
 {
-   int *direction_map, *low_contrast_map, *low_flow_map;
-   int bi, bsize, blkdir;
+   INITMAPSJOB *job = (INITMAPSJOB *)arg;
+   unsigned char *pdata = job->pdata;
+   const int pw = job->pw;
+   const int ph = job->ph;
+   const LFSPARMS *lfsparms = job->lfsparms;
+   int bi, blkdir;
    int *wis, *powmax_dirs;
    double **powers, *powmaxs, *pownorms;
    int nstats;
@@ -239,83 +244,39 @@ int gen_initial_maps(int **odmap, int **olcmap, int **olfmap,
    int xminlimit, xmaxlimit, yminlimit, ymaxlimit;
    int win_x, win_y, low_contrast_offset;
 
-   print2log("INITIAL MAP\n");
-
-   /* Compute total number of blocks in map */
-   bsize = mw * mh;
-
-   /* Allocate Direction Map memory */
-   direction_map = (int *)malloc(bsize * sizeof(int));
-   if(direction_map == (int *)NULL){
-      fprintf(stderr,
-              "ERROR : gen_initial_maps : malloc : direction_map\n");
-      return(-550);
-   }
-   /* Initialize the Direction Map to INVALID (-1). */
-   memset(direction_map, INVALID_DIR, bsize * sizeof(int));
-
-   /* Allocate Low Contrast Map memory */
-   low_contrast_map = (int *)malloc(bsize * sizeof(int));
-   if(low_contrast_map == (int *)NULL){
-      free(direction_map);
-      fprintf(stderr,
-              "ERROR : gen_initial_maps : malloc : low_contrast_map\n");
-      return(-551);
-   }
-   /* Initialize the Low Contrast Map to FALSE (0). */
-   memset(low_contrast_map, 0, bsize * sizeof(int));
-
-   /* Allocate Low Ridge Flow Map memory */
-   low_flow_map = (int *)malloc(bsize * sizeof(int));
-   if(low_flow_map == (int *)NULL){
-      free(direction_map);
-      free(low_contrast_map);
-      fprintf(stderr,
-              "ERROR : gen_initial_maps : malloc : low_flow_map\n");
-      return(-552);
-   }
-   /* Initialize the Low Flow Map to FALSE (0). */
-   memset(low_flow_map, 0, bsize * sizeof(int));
-
    /* Allocate DFT directional power vectors */
-   if((ret = alloc_dir_powers(&powers, dftwaves->nwaves, dftgrids->ngrids))){
-      /* Free memory allocated to this point. */
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
+   if((ret = alloc_dir_powers(&powers, job->dftwaves->nwaves,
+                              job->dftgrids->ngrids))){
       return(ret);
    }
 
    /* Allocate DFT power statistic arrays */
    /* Compute length of statistics arrays.  Statistics not needed   */
    /* for the first DFT wave, so the length is number of waves - 1. */
-   nstats = dftwaves->nwaves - 1;
+   nstats = job->dftwaves->nwaves - 1;
    if((ret = alloc_power_stats(&wis, &powmaxs, &powmax_dirs,
                             &pownorms, nstats))){
       /* Free memory allocated to this point. */
-      free(direction_map);
-      free(low_contrast_map);
-      free(low_flow_map);
-      free_dir_powers(powers, dftwaves->nwaves);
+      free_dir_powers(powers, job->dftwaves->nwaves);
       return(ret);
    }
 
    /* Compute special window origin limits for determining low contrast.  */
    /* These pixel limits avoid analyzing the padded borders of the image. */
-   xminlimit = dftgrids->pad;
-   yminlimit = dftgrids->pad;
-   xmaxlimit = pw - dftgrids->pad - lfsparms->windowsize - 1;
-   ymaxlimit = ph - dftgrids->pad - lfsparms->windowsize - 1;
+   xminlimit = job->dftgrids->pad;
+   yminlimit = job->dftgrids->pad;
+   xmaxlimit = pw - job->dftgrids->pad - lfsparms->windowsize - 1;
+   ymaxlimit = ph - job->dftgrids->pad - lfsparms->windowsize - 1;
 
    /* max limits should not be negative */
    xmaxlimit = MAX(xmaxlimit, 0);
    ymaxlimit = MAX(ymaxlimit, 0);
 
-   /* Foreach block in image ... */
-   for(bi = 0; bi < bsize; bi++){
+   /* Foreach block in the range ... */
+   for(bi = first; bi < last; bi++){
       /* Adjust block offset from pointing to block origin to pointing */
       /* to surrounding window origin.                                 */
-      dft_offset = blkoffs[bi] - (lfsparms->windowoffset * pw) -
+      dft_offset = job->blkoffs[bi] - (lfsparms->windowoffset * pw) -
                       lfsparms->windowoffset;
 
       /* Compute pixel coords of window origin. */
@@ -330,27 +291,30 @@ int gen_initial_maps(int **odmap, int **olcmap, int **olfmap,
       win_y = min(ymaxlimit, win_y);
       low_contrast_offset = (win_y * pw) + win_x;
 
-      print2log("   BLOCK %2d (%2d, %2d) ", bi, bi%mw, bi/mw);
+      print2log("   BLOCK %2d (%2d, %2d) ", bi, bi%job->mw, bi/job->mw);
 
-      /* If block is low contrast ... */
-      if((ret = low_contrast_block(low_contrast_offset, lfsparms->windowsize,
-                                  pdata, pw, ph, lfsparms))){
+      /* If block is low contrast ... (background blocks are caught */
+      /* by their variance without building a histogram)             */
+      if(low_variance_block(low_contrast_offset, lfsparms->windowsize,
+                            job->isums, job->isqrs, pw, ph, lfsparms))
+         ret = TRUE;
+      else
+         ret = low_contrast_block(low_contrast_offset, lfsparms->windowsize,
+                                  pdata, pw, ph, lfsparms);
+      if(ret){
          /* If system error ... */
          if(ret < 0){
-            free(direction_map);
-            free(low_contrast_map);
-            free(low_flow_map);
-            free_dir_powers(powers, dftwaves->nwaves);
-            free(wis);
-            free(powmaxs);
-            free(powmax_dirs);
-            free(pownorms);
+            free_dir_powers(powers, job->dftwaves->nwaves);
+            lfs_free(wis);
+            lfs_free(powmaxs);
+            lfs_free(powmax_dirs);
+            lfs_free(pownorms);
             return(ret);
          }
 
          /* Otherwise, block is low contrast ... */
          print2log("LOW CONTRAST\n");
-         low_contrast_map[bi] = TRUE;
+         job->low_contrast_map[bi] = TRUE;
          /* Direction Map's block is already set to INVALID. */
       }
       /* Otherwise, sufficient contrast for DFT processing ... */
@@ -358,17 +322,19 @@ int gen_initial_maps(int **odmap, int **olcmap, int **olfmap,
          print2log("\n");
 
          /* Compute DFT powers */
-         if((ret = dft_dir_powers(powers, pdata, low_contrast_offset, pw, ph,
-                               dftwaves, dftgrids))){
+         if(lfsparms->full_precision)
+            ret = dft_dir_powers_8bit(powers, pdata, low_contrast_offset,
+                                      pw, ph, job->dftwaves, job->dftgrids);
+         else
+            ret = dft_dir_powers(powers, pdata, low_contrast_offset, pw, ph,
+                                 job->dftwaves, job->dftgrids);
+         if(ret){
             /* Free memory allocated to this point. */
-            free(direction_map);
-            free(low_contrast_map);
-            free(low_flow_map);
-            free_dir_powers(powers, dftwaves->nwaves);
-            free(wis);
-            free(powmaxs);
-            free(powmax_dirs);
-            free(pownorms);
+            free_dir_powers(powers, job->dftwaves->nwaves);
+            lfs_free(wis);
+            lfs_free(powmaxs);
+            lfs_free(powmax_dirs);
+            lfs_free(pownorms);
             return(ret);
          }
 
@@ -376,16 +342,14 @@ int gen_initial_maps(int **odmap, int **olcmap, int **olfmap,
          /* wave.  This is dependent on how the primary and secondary */
          /* direction tests work below.                               */
          if((ret = dft_power_stats(wis, powmaxs, powmax_dirs, pownorms, powers,
-                                1, dftwaves->nwaves, dftgrids->ngrids))){
+                                1, job->dftwaves->nwaves,
+                                job->dftgrids->ngrids))){
             /* Free memory allocated to this point. */
-            free(direction_map);
-            free(low_contrast_map);
-            free(low_flow_map);
-            free_dir_powers(powers, dftwaves->nwaves);
-            free(wis);
-            free(powmaxs);
-            free(powmax_dirs);
-            free(pownorms);
+            free_dir_powers(powers, job->dftwaves->nwaves);
+            lfs_free(wis);
+            lfs_free(powmaxs);
+            lfs_free(powmax_dirs);
+            lfs_free(pownorms);
             return(ret);
          }
 
@@ -407,28 +371,159 @@ int gen_initial_maps(int **odmap, int **olcmap, int **olfmap,
                                   pownorms, nstats, lfsparms);
 
          if(blkdir != INVALID_DIR)
-            direction_map[bi] = blkdir;
+            job->direction_map[bi] = blkdir;
          else{
             /* Conduct secondary (fork) direction test */
             blkdir = secondary_fork_test(powers, wis, powmaxs, powmax_dirs,
                                   pownorms, nstats, lfsparms);
             if(blkdir != INVALID_DIR)
-               direction_map[bi] = blkdir;
+               job->direction_map[bi] = blkdir;
             /* Otherwise current direction in Direction Map remains INVALID */
             else
                /* Flag the block as having LOW RIDGE FLOW. */
-               low_flow_map[bi] = TRUE;
+               job->low_flow_map[bi] = TRUE;
          }
 
       } /* End DFT */
    } /* bi */
 
    /* Deallocate working memory */
-   free_dir_powers(powers, dftwaves->nwaves);
-   free(wis);
-   free(powmaxs);
-   free(powmax_dirs);
-   free(pownorms);
+   free_dir_powers(powers, job->dftwaves->nwaves);
+   lfs_free(wis);
+   lfs_free(powmaxs);
+   lfs_free(powmax_dirs);
+   lfs_free(pownorms);
+
+   return(0);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: gen_initial_maps - Creates an initial Direction Map from the given
+#cat:             input image.  It very important that the image be properly
+#cat:             padded so that rotated grids along the boundary of the image
+#cat:             do not access unkown memory.  The rotated grids are used by a
+#cat:             DFT-based analysis to determine the integer directions
+#cat:             in the map. Typically this initial vector of directions will
+#cat:             subsequently have weak or inconsistent directions removed
+#cat:             followed by a smoothing process.  The resulting Direction
+#cat:             Map contains valid directions >= 0 and INVALID values = -1.
+#cat:             This routine also computes and returns 2 other image maps.
+#cat:             The Low Contrast Map flags blocks in the image with
+#cat:             insufficient contrast.  Blocks with low contrast have a
+#cat:             corresponding direction of INVALID in the Direction Map.
+#cat:             The Low Flow Map flags blocks in which the DFT analyses
+#cat:             could not determine a significant ridge flow.  Blocks with
+#cat:             low ridge flow also have a corresponding direction of
+#cat:             INVALID in the Direction Map.
+
+   Input:
+      blkoffs   - offsets to the pixel origin of each block in the padded image
+      mw        - number of blocks horizontally in the padded input image
+      mh        - number of blocks vertically in the padded input image
+      pdata     - padded input image data (8 bits [0..256) grayscale)
+      pw        - width (in pixels) of the padded input image
+      ph        - height (in pixels) of the padded input image
+      dftwaves  - structure containing the DFT wave forms
+      dftgrids  - structure containing the rotated pixel grid offsets
+      lfsparms  - parameters and thresholds for controlling LFS
+      parallel  - optional runner the blocks are handed to, or NULL to
+                  analyze them all in this thread
+      parallel_data - private data passed to the runner
+   Output:
+      odmap     - points to the newly created Direction Map
+      olcmap    - points to the newly created Low Contrast Map
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+int gen_initial_maps(int **odmap, int **olcmap, int **olfmap,
+                int *blkoffs, const int mw, const int mh,
+                unsigned char *pdata, const int pw, const int ph,
+                const DFTWAVES *dftwaves, const  ROTGRIDS *dftgrids,
+                const LFSPARMS *lfsparms,
+                LFS_PARALLEL_FUNC parallel, void *parallel_data)
+{
+   INITMAPSJOB job;
+   int *direction_map, *low_contrast_map, *low_flow_map;
+   int bsize;
+   int ret; /* return code */
+
+   print2log("INITIAL MAP\n");
+
+   /* Compute total number of blocks in map */
+   bsize = mw * mh;
+
+   /* Allocate Direction Map memory */
+   direction_map = (int *)lfs_malloc(bsize * sizeof(int));
+   if(direction_map == (int *)NULL){
+      fprintf(stderr,
+              "ERROR : gen_initial_maps : malloc : direction_map\n");
+      return(-550);
+   }
+   /* Initialize the Direction Map to INVALID (-1). */
+   memset(direction_map, INVALID_DIR, bsize * sizeof(int));
+
+   /* Allocate Low Contrast Map memory */
+   low_contrast_map = (int *)lfs_malloc(bsize * sizeof(int));
+   if(low_contrast_map == (int *)NULL){
+      lfs_free(direction_map);
+      fprintf(stderr,
+              "ERROR : gen_initial_maps : malloc : low_contrast_map\n");
+      return(-551);
+   }
+   /* Initialize the Low Contrast Map to FALSE (0). */
+   memset(low_contrast_map, 0, bsize * sizeof(int));
+
+   /* Allocate Low Ridge Flow Map memory */
+   low_flow_map = (int *)lfs_malloc(bsize * sizeof(int));
+   if(low_flow_map == (int *)NULL){
+      lfs_free(direction_map);
+      lfs_free(low_contrast_map);
+      fprintf(stderr,
+              "ERROR : gen_initial_maps : malloc : low_flow_map\n");
+      return(-552);
+   }
+   /* Initialize the Low Flow Map to FALSE (0). */
+   memset(low_flow_map, 0, bsize * sizeof(int));
+
+   /* Sum the image once so that background blocks can be told */
+   /* apart in constant time.                                   */
+   if((ret = summed_area_tables(&job.isums, &job.isqrs, pdata, pw, ph))){
+      lfs_free(direction_map);
+      lfs_free(low_contrast_map);
+      lfs_free(low_flow_map);
+      return(ret);
+   }
+
+   job.direction_map = direction_map;
+   job.low_contrast_map = low_contrast_map;
+   job.low_flow_map = low_flow_map;
+   job.blkoffs = blkoffs;
+   job.mw = mw;
+   job.pdata = pdata;
+   job.pw = pw;
+   job.ph = ph;
+   job.dftwaves = dftwaves;
+   job.dftgrids = dftgrids;
+   job.lfsparms = lfsparms;
+
+   /* Analyze all blocks, handing them to the runner if one is given. */
+   /* Each block only sets its own map entries, so the maps come out  */
+   /* the same whichever way the blocks are split.                    */
+   if(parallel != (LFS_PARALLEL_FUNC)NULL)
+      ret = parallel(parallel_data, gen_initial_maps_blocks, &job, bsize);
+   else
+      ret = gen_initial_maps_blocks(&job, 0, bsize);
+   lfs_free(job.isums);
+   lfs_free(job.isqrs);
+   if(ret){
+      /* Free memory allocated to this point. */
+      lfs_free(direction_map);
+      lfs_free(low_contrast_map);
+      lfs_free(low_flow_map);
+      return(ret);
+   }
 
    *odmap = direction_map;
    *olcmap = low_contrast_map;
@@ -476,7 +571,7 @@ int interpolate_direction_map(int *direction_map, int *low_contrast_map,
    print2log("INTERPOLATE DIRECTION MAP\n");
 
    /* Allocate output (interpolated) Direction Map. */
-   omap = (int *)malloc(mw*mh*sizeof(int));
+   omap = (int *)lfs_malloc(mw*mh*sizeof(int));
    if(omap == (int *)NULL){
       fprintf(stderr,
               "ERROR : interpolate_direction_map : malloc : omap\n");
@@ -621,7 +716,7 @@ int interpolate_direction_map(int *direction_map, int *low_contrast_map,
    /* Copy the interpolated directions into the input map. */
    memcpy(direction_map, omap, mw*mh*sizeof(int));
    /* Deallocate the working memory. */
-   free(omap);
+   lfs_free(omap);
 
    /* Return normally. */
    return(0);
@@ -650,13 +745,13 @@ int morph_TF_map(int *tfmap, const int mw, const int mh,
    
 
    /* Convert TRUE/FALSE map into a binary byte image. */
-   cimage = (unsigned char *)malloc(mw*mh);
+   cimage = (unsigned char *)lfs_malloc(mw*mh);
    if(cimage == (unsigned char *)NULL){
       fprintf(stderr, "ERROR : morph_TF_map : malloc : cimage\n");
       return(-660);
    }
 
-   mimage = (unsigned char *)malloc(mw*mh);
+   mimage = (unsigned char *)lfs_malloc(mw*mh);
    if(mimage == (unsigned char *)NULL){
       fprintf(stderr, "ERROR : morph_TF_map : malloc : mimage\n");
       return(-661);
@@ -679,8 +774,8 @@ int morph_TF_map(int *tfmap, const int mw, const int mh,
       *mptr++ = *cptr++;
    }
 
-   free(cimage);
-   free(mimage);
+   lfs_free(cimage);
+   lfs_free(mimage);
 
    return(0);
 }
@@ -712,7 +807,7 @@ int pixelize_map(int **omap, const int iw, const int ih,
    int *blkoffs, bw, bh, bi;
    int *spptr, *pptr;
 
-   pmap = (int *)malloc(iw*ih*sizeof(int));
+   pmap = (int *)lfs_malloc(iw*ih*sizeof(int));
    if(pmap == (int *)NULL){
       fprintf(stderr, "ERROR : pixelize_map : malloc : pmap\n");
       return(-590);
@@ -723,7 +818,7 @@ int pixelize_map(int **omap, const int iw, const int ih,
    }
 
    if((bw != mw) || (bh != mh)){
-      free(blkoffs);
+      lfs_free(blkoffs);
       fprintf(stderr,
          "ERROR : pixelize_map : block dimensions do not match\n");
       return(-591);
@@ -741,7 +836,7 @@ int pixelize_map(int **omap, const int iw, const int ih,
    }
 
    /* Deallocate working memory. */
-   free(blkoffs);
+   lfs_free(blkoffs);
    /* Assign pixelized map to output pointer. */
    *omap = pmap;
 
@@ -872,7 +967,7 @@ int gen_high_curve_map(int **ohcmap, int *direction_map,
    mapsize = mw*mh;
 
    /* Allocate High Curvature Map. */
-   high_curve_map = (int *)malloc(mapsize * sizeof(int));
+   high_curve_map = (int *)lfs_malloc(mapsize * sizeof(int));
    if(high_curve_map == (int *)NULL){
       fprintf(stderr,
               "ERROR: gen_high_curve_map : malloc : high_curve_map\n");
@@ -977,7 +1072,7 @@ int gen_initial_imap(int **optr, int *blkoffs, const int mw, const int mh,
    bsize = mw * mh;
 
    /* Allocate IMAP memory */
-   imap = (int *)malloc(bsize * sizeof(int));
+   imap = (int *)lfs_malloc(bsize * sizeof(int));
    if(imap == (int *)NULL){
       fprintf(stderr, "ERROR : gen_initial_imap : malloc : imap\n");
       return(-70);
@@ -986,7 +1081,7 @@ int gen_initial_imap(int **optr, int *blkoffs, const int mw, const int mh,
    /* Allocate DFT directional power vectors */
    if((ret = alloc_dir_powers(&powers, dftwaves->nwaves, dftgrids->ngrids))){
       /* Free memory allocated to this point. */
-      free(imap);
+      lfs_free(imap);
       return(ret);
    }
 
@@ -997,7 +1092,7 @@ int gen_initial_imap(int **optr, int *blkoffs, const int mw, const int mh,
    if((ret = alloc_power_stats(&wis, &powmaxs, &powmax_dirs,
                             &pownorms, nstats))){
       /* Free memory allocated to this point. */
-      free(imap);
+      lfs_free(imap);
       free_dir_powers(powers, dftwaves->nwaves);
       return(ret);
    }
@@ -1014,12 +1109,12 @@ int gen_initial_imap(int **optr, int *blkoffs, const int mw, const int mh,
       if((ret = dft_dir_powers(powers, pdata, blkoffs[bi], pw, ph,
                             dftwaves, dftgrids))){
          /* Free memory allocated to this point. */
-         free(imap);
+         lfs_free(imap);
          free_dir_powers(powers, dftwaves->nwaves);
-         free(wis);
-         free(powmaxs);
-         free(powmax_dirs);
-         free(pownorms);
+         lfs_free(wis);
+         lfs_free(powmaxs);
+         lfs_free(powmax_dirs);
+         lfs_free(pownorms);
          return(ret);
       }
 
@@ -1029,12 +1124,12 @@ int gen_initial_imap(int **optr, int *blkoffs, const int mw, const int mh,
       if((ret = dft_power_stats(wis, powmaxs, powmax_dirs, pownorms, powers,
                       1, dftwaves->nwaves, dftgrids->ngrids))){
          /* Free memory allocated to this point. */
-         free(imap);
+         lfs_free(imap);
          free_dir_powers(powers, dftwaves->nwaves);
-         free(wis);
-         free(powmaxs);
-         free(powmax_dirs);
-         free(pownorms);
+         lfs_free(wis);
+         lfs_free(powmaxs);
+         lfs_free(powmax_dirs);
+         lfs_free(pownorms);
          return(ret);
       }
 
@@ -1071,10 +1166,10 @@ int gen_initial_imap(int **optr, int *blkoffs, const int mw, const int mh,
 
    /* Deallocate working memory */
    free_dir_powers(powers, dftwaves->nwaves);
-   free(wis);
-   free(powmaxs);
-   free(powmax_dirs);
-   free(pownorms);
+   lfs_free(wis);
+   lfs_free(powmaxs);
+   lfs_free(powmax_dirs);
+   lfs_free(pownorms);
 
    *optr = imap;
    return(0);
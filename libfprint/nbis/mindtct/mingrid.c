@@ -0,0 +1,118 @@
+/***********************************************************************
+      LIBRARY: LFS - NIST Latent Fingerprint System
+
+      FILE:    MINGRID.C
+
+      Contains routines responsible for indexing a list of minutiae
+      by location as part of the NIST Latent Fingerprint System (LFS).
+      The image is divided into square cells and the list index of
+      each minutia is stored in the bucket of the cell it lies in, so
+      that the minutiae near a point can be found without scanning
+      the whole list.
+
+***********************************************************************
+               ROUTINES:
+                        build_mingrid()
+                        free_mingrid()
+***********************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+#include <lfs.h>
+
+/*************************************************************************
+**************************************************************************
+#cat: build_mingrid - Takes a list of minutiae and buckets their list
+#cat:             indices on a grid of square cells covering the image.
+#cat:             The cells are sized so that they hold MINGRID_OCCUPANCY
+#cat:             minutiae on average.  Within a bucket, the indices are
+#cat:             in increasing order.  The grid must be rebuilt whenever
+#cat:             the list is sorted or minutiae are added or removed.
+
+   Input:
+      minutiae - list of minutiae
+      iw       - width (in pixels) of image
+      ih       - height (in pixels) of image
+   Output:
+      ogrid    - points to the created grid
+   Return Code:
+      Zero     - successful completion
+      Negative - system error
+**************************************************************************/
+int build_mingrid(MINGRID **ogrid, const MINUTIAE *minutiae,
+                  const int iw, const int ih)
+{
+   MINGRID *grid;
+   int i, c, ncells, cellsize;
+   MINUTIA *minutia;
+
+   /* Compute the cell size giving the desired average occupancy. */
+   if(minutiae->num > 0)
+      cellsize = sround(sqrt(MINGRID_OCCUPANCY * (double)iw * ih /
+                             minutiae->num));
+   else
+      cellsize = max(iw, ih);
+   cellsize = max(cellsize, MIN_MINGRID_CELLSIZE);
+
+   grid = (MINGRID *)lfs_malloc(sizeof(MINGRID));
+   if(grid == (MINGRID *)NULL){
+      fprintf(stderr, "ERROR : build_mingrid : malloc : grid\n");
+      return(-730);
+   }
+   grid->cellsize = cellsize;
+   grid->gw = (iw + cellsize - 1) / cellsize;
+   grid->gh = (ih + cellsize - 1) / cellsize;
+   ncells = grid->gw * grid->gh;
+
+   /* One extra entry marks the end of the last bucket. */
+   grid->cells = (int *)lfs_calloc(ncells + 1, sizeof(int));
+   if(grid->cells == (int *)NULL){
+      lfs_free(grid);
+      fprintf(stderr, "ERROR : build_mingrid : calloc : cells\n");
+      return(-731);
+   }
+   grid->items = (int *)lfs_malloc(max(minutiae->num, 1) * sizeof(int));
+   if(grid->items == (int *)NULL){
+      lfs_free(grid->cells);
+      lfs_free(grid);
+      fprintf(stderr, "ERROR : build_mingrid : malloc : items\n");
+      return(-732);
+   }
+
+   /* Count the minutiae in each cell ... */
+   for(i = 0; i < minutiae->num; i++){
+      minutia = minutiae->list[i];
+      c = ((minutia->y / cellsize) * grid->gw) + (minutia->x / cellsize);
+      grid->cells[c+1]++;
+   }
+   /* ... turn the counts into the start of each bucket ... */
+   for(c = 0; c < ncells; c++)
+      grid->cells[c+1] += grid->cells[c];
+   /* ... and fill the buckets, using each start as the bucket's next */
+   /* free slot.  The starts are shifted back one bucket once done.   */
+   for(i = 0; i < minutiae->num; i++){
+      minutia = minutiae->list[i];
+      c = ((minutia->y / cellsize) * grid->gw) + (minutia->x / cellsize);
+      grid->items[grid->cells[c]++] = i;
+   }
+   for(c = ncells; c > 0; c--)
+      grid->cells[c] = grid->cells[c-1];
+   grid->cells[0] = 0;
+
+   *ogrid = grid;
+   return(0);
+}
+
+/*************************************************************************
+**************************************************************************
+#cat: free_mingrid - Deallocates a grid created by build_mingrid().
+
+   Input:
+      grid     - grid to be deallocated
+**************************************************************************/
+void free_mingrid(MINGRID *grid)
+{
+   lfs_free(grid->items);
+   lfs_free(grid->cells);
+   lfs_free(grid);
+}
@@ -47,6 +47,7 @@ identified are necessarily the best available for the purpose.
                         dump_minutiae_pts()
                         dump_reliable_minutiae_pts()
                         create_minutia()
+                        copy_minutiae()
                         free_minutiae()
                         free_minutia()
                         remove_minutia()
@@ -79,6 +80,7 @@ identified are necessarily the best available for the purpose.
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <lfs.h>
 
 
@@ -100,12 +102,12 @@ int alloc_minutiae(MINUTIAE **ominutiae, const int max_minutiae)
 {
    MINUTIAE *minutiae;
 
-   minutiae = (MINUTIAE *)malloc(sizeof(MINUTIAE));
+   minutiae = (MINUTIAE *)lfs_malloc(sizeof(MINUTIAE));
    if(minutiae == (MINUTIAE *)NULL){
       fprintf(stderr, "ERROR : alloc_minutiae : malloc : minutiae\n");
       exit(-430);
    }
-   minutiae->list = (MINUTIA **)malloc(max_minutiae * sizeof(MINUTIA *));
+   minutiae->list = (MINUTIA **)lfs_malloc(max_minutiae * sizeof(MINUTIA *));
    if(minutiae->list == (MINUTIA **)NULL){
       fprintf(stderr, "ERROR : alloc_minutiae : malloc : minutiae->list\n");
       exit(-431);
@@ -136,7 +138,7 @@ int alloc_minutiae(MINUTIAE **ominutiae, const int max_minutiae)
 int realloc_minutiae(MINUTIAE *minutiae, const int incr_minutiae)
 {
    minutiae->alloc += incr_minutiae;
-   minutiae->list = (MINUTIA **)realloc(minutiae->list,
+   minutiae->list = (MINUTIA **)lfs_realloc(minutiae->list,
                                      minutiae->alloc * sizeof(MINUTIA *));
    if(minutiae->list == (MINUTIA **)NULL){
       fprintf(stderr, "ERROR : realloc_minutiae : realloc : minutiae->list\n");
@@ -177,6 +179,7 @@ int detect_minutiae_V2(MINUTIAE *minutiae,
 {
    int ret;
    int *pdirection_map, *plow_flow_map, *phigh_curve_map;
+   int sx, sy, ex, ey;
 
    /* Pixelize the maps by assigning block values to individual pixels. */
    if((ret = pixelize_map(&pdirection_map, iw, ih, direction_map, mw, mh,
@@ -186,37 +189,43 @@ int detect_minutiae_V2(MINUTIAE *minutiae,
 
    if((ret = pixelize_map(&plow_flow_map, iw, ih, low_flow_map, mw, mh,
                          lfsparms->blocksize))){
-      free(pdirection_map);
+      lfs_free(pdirection_map);
       return(ret);
    }
 
    if((ret = pixelize_map(&phigh_curve_map, iw, ih, high_curve_map, mw, mh,
                          lfsparms->blocksize))){
-      free(pdirection_map);
-      free(plow_flow_map);
+      lfs_free(pdirection_map);
+      lfs_free(plow_flow_map);
       return(ret);
    }
 
+   /* Only the box around the blocks with VALID direction is scanned. */
+   valid_block_bounds(&sx, &sy, &ex, &ey, direction_map, mw, mh,
+                      lfsparms->blocksize, iw, ih);
+
    if((ret = scan4minutiae_horizontally_V2(minutiae, bdata, iw, ih,
+                 sx, sy, ex, ey,
                  pdirection_map, plow_flow_map, phigh_curve_map, lfsparms))){
-      free(pdirection_map);
-      free(plow_flow_map);
-      free(phigh_curve_map);
+      lfs_free(pdirection_map);
+      lfs_free(plow_flow_map);
+      lfs_free(phigh_curve_map);
       return(ret);
    }
 
    if((ret = scan4minutiae_vertically_V2(minutiae, bdata, iw, ih,
+                 sx, sy, ex, ey,
                  pdirection_map, plow_flow_map, phigh_curve_map, lfsparms))){
-      free(pdirection_map);
-      free(plow_flow_map);
-      free(phigh_curve_map);
+      lfs_free(pdirection_map);
+      lfs_free(plow_flow_map);
+      lfs_free(phigh_curve_map);
       return(ret);
    }
 
    /* Deallocate working memories. */
-   free(pdirection_map);
-   free(plow_flow_map);
-   free(phigh_curve_map);
+   lfs_free(pdirection_map);
+   lfs_free(plow_flow_map);
+   lfs_free(phigh_curve_map);
 
    /* Return normally. */
    return(0);
@@ -509,7 +518,7 @@ int sort_minutiae_y_x(MINUTIAE *minutiae, const int iw, const int ih)
 
    /* Allocate a list of integers to hold 1-D image pixel offsets */
    /* for each of the 2-D minutia coordinate points.               */
-   ranks = (int *)malloc(minutiae->num * sizeof(int));
+   ranks = (int *)lfs_malloc(minutiae->num * sizeof(int));
    if(ranks == (int *)NULL){
       fprintf(stderr, "ERROR : sort_minutiae_y_x : malloc : ranks\n");
       return(-310);
@@ -521,15 +530,15 @@ int sort_minutiae_y_x(MINUTIAE *minutiae, const int iw, const int ih)
 
    /* Get sorted order of minutiae. */
    if((ret = sort_indices_int_inc(&order, ranks, minutiae->num))){
-      free(ranks);
+      lfs_free(ranks);
       return(ret);
    }
 
    /* Allocate new MINUTIA list to hold sorted minutiae. */
-   newlist = (MINUTIA **)malloc(minutiae->num * sizeof(MINUTIA *));
+   newlist = (MINUTIA **)lfs_malloc(minutiae->num * sizeof(MINUTIA *));
    if(newlist == (MINUTIA **)NULL){
-      free(ranks);
-      free(order);
+      lfs_free(ranks);
+      lfs_free(order);
       fprintf(stderr, "ERROR : sort_minutiae_y_x : malloc : newlist\n");
       return(-311);
    }
@@ -539,13 +548,13 @@ int sort_minutiae_y_x(MINUTIAE *minutiae, const int iw, const int ih)
       newlist[i] = minutiae->list[order[i]];
 
    /* Deallocate non-sorted list of minutia pointers. */
-   free(minutiae->list);
+   lfs_free(minutiae->list);
    /* Assign new sorted list of minutia to minutiae list. */
    minutiae->list = newlist;
 
    /* Free the working memories supporting the sort. */
-   free(order);
-   free(ranks);
+   lfs_free(order);
+   lfs_free(ranks);
 
    /* Return normally. */
    return(0);
@@ -574,7 +583,7 @@ int sort_minutiae_x_y(MINUTIAE *minutiae, const int iw, const int ih)
 
    /* Allocate a list of integers to hold 1-D image pixel offsets */
    /* for each of the 2-D minutia coordinate points.               */
-   ranks = (int *)malloc(minutiae->num * sizeof(int));
+   ranks = (int *)lfs_malloc(minutiae->num * sizeof(int));
    if(ranks == (int *)NULL){
       fprintf(stderr, "ERROR : sort_minutiae_x_y : malloc : ranks\n");
       return(-440);
@@ -586,15 +595,15 @@ int sort_minutiae_x_y(MINUTIAE *minutiae, const int iw, const int ih)
 
    /* Get sorted order of minutiae. */
    if((ret = sort_indices_int_inc(&order, ranks, minutiae->num))){
-      free(ranks);
+      lfs_free(ranks);
       return(ret);
    }
 
    /* Allocate new MINUTIA list to hold sorted minutiae. */
-   newlist = (MINUTIA **)malloc(minutiae->num * sizeof(MINUTIA *));
+   newlist = (MINUTIA **)lfs_malloc(minutiae->num * sizeof(MINUTIA *));
    if(newlist == (MINUTIA **)NULL){
-      free(ranks);
-      free(order);
+      lfs_free(ranks);
+      lfs_free(order);
       fprintf(stderr, "ERROR : sort_minutiae_x_y : malloc : newlist\n");
       return(-441);
    }
@@ -604,13 +613,13 @@ int sort_minutiae_x_y(MINUTIAE *minutiae, const int iw, const int ih)
       newlist[i] = minutiae->list[order[i]];
 
    /* Deallocate non-sorted list of minutia pointers. */
-   free(minutiae->list);
+   lfs_free(minutiae->list);
    /* Assign new sorted list of minutia to minutiae list. */
    minutiae->list = newlist;
 
    /* Free the working memories supporting the sort. */
-   free(order);
-   free(ranks);
+   lfs_free(order);
+   lfs_free(ranks);
 
    /* Return normally. */
    return(0);
@@ -797,7 +806,7 @@ int create_minutia(MINUTIA **ominutia, const int x_loc, const int y_loc,
    MINUTIA *minutia;
 
    /* Allocate a minutia structure. */
-   minutia = (MINUTIA *)malloc(sizeof(MINUTIA));
+   minutia = (MINUTIA *)lfs_malloc(sizeof(MINUTIA));
    /* If allocation error... */
    if(minutia == (MINUTIA *)NULL){
       fprintf(stderr, "ERROR : create_minutia : malloc : minutia\n");
@@ -824,6 +833,82 @@ int create_minutia(MINUTIA **ominutia, const int x_loc, const int y_loc,
    return(0);
 }
 
+/*************************************************************************
+**************************************************************************
+#cat: copy_minutiae - Takes a minutiae list and allocates a copy of it,
+#cat:                 including the neighbor lists of its minutiae.
+
+   Input:
+      minutiae  - list of minutia structures to be copied
+   Output:
+      ominutiae - points to the allocated copy
+   Return Code:
+      Zero      - successful completion
+      Negative  - system error
+**************************************************************************/
+int copy_minutiae(MINUTIAE **ominutiae, const MINUTIAE *minutiae)
+{
+   MINUTIAE *copy;
+   MINUTIA *minutia;
+   int i, nalloc;
+
+   copy = (MINUTIAE *)lfs_malloc(sizeof(MINUTIAE));
+   if(copy == (MINUTIAE *)NULL){
+      fprintf(stderr, "ERROR : copy_minutiae : malloc : copy\n");
+      return(-722);
+   }
+   nalloc = max(minutiae->num, 1);
+   copy->list = (MINUTIA **)lfs_malloc(nalloc * sizeof(MINUTIA *));
+   if(copy->list == (MINUTIA **)NULL){
+      lfs_free(copy);
+      fprintf(stderr, "ERROR : copy_minutiae : malloc : copy->list\n");
+      return(-723);
+   }
+   copy->alloc = nalloc;
+   copy->num = 0;
+
+   for(i = 0; i < minutiae->num; i++){
+      minutia = (MINUTIA *)lfs_malloc(sizeof(MINUTIA));
+      if(minutia == (MINUTIA *)NULL){
+         free_minutiae(copy);
+         fprintf(stderr, "ERROR : copy_minutiae : malloc : minutia\n");
+         return(-724);
+      }
+      *minutia = *(minutiae->list[i]);
+      minutia->nbrs = (int *)NULL;
+      minutia->ridge_counts = (int *)NULL;
+      /* Add the minutia first, so that it is freed on error. */
+      copy->list[copy->num++] = minutia;
+
+      if(minutiae->list[i]->nbrs != (int *)NULL){
+         minutia->nbrs = (int *)lfs_malloc(max(minutia->num_nbrs, 1) *
+                                           sizeof(int));
+         if(minutia->nbrs == (int *)NULL){
+            free_minutiae(copy);
+            fprintf(stderr, "ERROR : copy_minutiae : malloc : nbrs\n");
+            return(-725);
+         }
+         memcpy(minutia->nbrs, minutiae->list[i]->nbrs,
+                minutia->num_nbrs * sizeof(int));
+      }
+      if(minutiae->list[i]->ridge_counts != (int *)NULL){
+         minutia->ridge_counts = (int *)lfs_malloc(
+                                    max(minutia->num_nbrs, 1) * sizeof(int));
+         if(minutia->ridge_counts == (int *)NULL){
+            free_minutiae(copy);
+            fprintf(stderr,
+                    "ERROR : copy_minutiae : malloc : ridge_counts\n");
+            return(-726);
+         }
+         memcpy(minutia->ridge_counts, minutiae->list[i]->ridge_counts,
+                minutia->num_nbrs * sizeof(int));
+      }
+   }
+
+   *ominutiae = copy;
+   return(0);
+}
+
 /*************************************************************************
 **************************************************************************
 #cat: free_minutiae - Takes a minutiae list and deallocates all memory
@@ -840,10 +925,10 @@ void free_minutiae(MINUTIAE *minutiae)
    for(i = 0; i < minutiae->num; i++)
       free_minutia(minutiae->list[i]);
    /* Deallocate list of minutia pointers. */
-   free(minutiae->list);
+   lfs_free(minutiae->list);
 
    /* Deallocate the list structure. */
-   free(minutiae);
+   lfs_free(minutiae);
 }
 
 /*************************************************************************
@@ -858,12 +943,12 @@ void free_minutia(MINUTIA *minutia)
 {
    /* Deallocate sublists. */
    if(minutia->nbrs != (int *)NULL)
-      free(minutia->nbrs);
+      lfs_free(minutia->nbrs);
    if(minutia->ridge_counts != (int *)NULL)
-      free(minutia->ridge_counts);
+      lfs_free(minutia->ridge_counts);
 
    /* Deallocate the minutia structure. */
-   free(minutia);
+   lfs_free(minutia);
 }
 
 /*************************************************************************
@@ -1034,8 +1119,8 @@ int join_minutia(const MINUTIA *minutia1, const MINUTIA *minutia2,
    }
 
    /* Deallocate points along connecting line. */
-   free(x_list);
-   free(y_list);
+   lfs_free(x_list);
+   lfs_free(y_list);
 
    /* Return normally. */
    return(0);
@@ -1375,8 +1460,9 @@ int scan4minutiae_horizontally(MINUTIAE *minutiae,
 
 /*************************************************************************
 **************************************************************************
-#cat: scan4minutiae_horizontally_V2 - Scans an entire binary image
-#cat:                horizontally, detecting potential minutiae points.
+#cat: scan4minutiae_horizontally_V2 - Scans a binary image horizontally
+#cat:                around its blocks with VALID direction, detecting
+#cat:                potential minutiae points.
 #cat:                Minutia detected via the horizontal scan process are
 #cat:                by nature vertically oriented (orthogonal to the scan).
 
@@ -1384,6 +1470,9 @@ int scan4minutiae_horizontally(MINUTIAE *minutiae,
       bdata     - binary image data (0==while & 1==black)
       iw        - width (in pixels) of image
       ih        - height (in pixels) of image
+      vsx, vsy  - left column and top row of the box around the blocks
+                  with VALID direction
+      vex, vey  - column and row one past the right and bottom of the box
       pdirection_map  - pixelized Direction Map
       plow_flow_map   - pixelized Low Ridge Flow Map
       phigh_curve_map - pixelized High Curvature Map
@@ -1396,6 +1485,7 @@ int scan4minutiae_horizontally(MINUTIAE *minutiae,
 **************************************************************************/
 int scan4minutiae_horizontally_V2(MINUTIAE *minutiae,
                 unsigned char *bdata, const int iw, const int ih,
+                const int vsx, const int vsy, const int vex, const int vey,
                 int *pdirection_map, int *plow_flow_map, int *phigh_curve_map,
                 const LFSPARMS *lfsparms)
 {
@@ -1404,11 +1494,15 @@ int scan4minutiae_horizontally_V2(MINUTIAE *minutiae,
    int possible[NFEATURES], nposs;
    int ret;
 
-   /* Set scan region to entire image. */
-   sx = 0;
-   ex = iw;
-   sy = 0;
-   ey = ih;
+   /* Set scan region to the box around the VALID blocks.  The image */
+   /* is white outside it, so no feature lies entirely outside.  The  */
+   /* box is grown by a pixel all around, for the pixel pairs         */
+   /* straddling its border, and so that each scan enters it in the   */
+   /* same state as it would have scanning from the image border.     */
+   sx = max(vsx-1, 0);
+   ex = min(vex+1, iw);
+   sy = max(vsy-1, 0);
+   ey = min(vey+1, ih);
 
    /* Start at first row in region. */
    cy = sy;
@@ -1636,8 +1730,9 @@ int scan4minutiae_vertically(MINUTIAE *minutiae,
 
 /*************************************************************************
 **************************************************************************
-#cat: scan4minutiae_vertically_V2 - Scans an entire binary image
-#cat:                vertically, detecting potential minutiae points.
+#cat: scan4minutiae_vertically_V2 - Scans a binary image vertically
+#cat:                around its blocks with VALID direction, detecting
+#cat:                potential minutiae points.
 #cat:                Minutia detected via the vetical scan process are
 #cat:                by nature horizontally oriented (orthogonal to  the scan).
 
@@ -1645,6 +1740,9 @@ int scan4minutiae_vertically(MINUTIAE *minutiae,
       bdata     - binary image data (0==while & 1==black)
       iw        - width (in pixels) of image
       ih        - height (in pixels) of image
+      vsx, vsy  - left column and top row of the box around the blocks
+                  with VALID direction
+      vex, vey  - column and row one past the right and bottom of the box
       pdirection_map  - pixelized Direction Map
       plow_flow_map   - pixelized Low Ridge Flow Map
       phigh_curve_map - pixelized High Curvature Map
@@ -1657,6 +1755,7 @@ int scan4minutiae_vertically(MINUTIAE *minutiae,
 **************************************************************************/
 int scan4minutiae_vertically_V2(MINUTIAE *minutiae,
                 unsigned char *bdata, const int iw, const int ih,
+                const int vsx, const int vsy, const int vex, const int vey,
                 int *pdirection_map, int *plow_flow_map, int *phigh_curve_map,
                 const LFSPARMS *lfsparms)
 {
@@ -1665,11 +1764,15 @@ int scan4minutiae_vertically_V2(MINUTIAE *minutiae,
    int possible[NFEATURES], nposs;
    int ret;
 
-   /* Set scan region to entire image. */
-   sx = 0;
-   ex = iw;
-   sy = 0;
-   ey = ih;
+   /* Set scan region to the box around the VALID blocks.  The image */
+   /* is white outside it, so no feature lies entirely outside.  The  */
+   /* box is grown by a pixel all around, for the pixel pairs         */
+   /* straddling its border, and so that each scan enters it in the   */
+   /* same state as it would have scanning from the image border.     */
+   sx = max(vsx-1, 0);
+   ex = min(vex+1, iw);
+   sy = max(vsy-1, 0);
+   ey = min(vey+1, ih);
 
    /* Start at first column in region. */
    cx = sx;
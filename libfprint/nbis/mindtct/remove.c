@@ -154,7 +154,7 @@ static int remove_hooks(MINUTIAE *minutiae,
    /* Allocate list of minutia indices that upon completion of testing */
    /* should be removed from the minutiae lists.  Note: That using      */
    /* "calloc" initializes the list to FALSE.                          */
-   to_remove = (int *)calloc(minutiae->num, sizeof(int));
+   to_remove = (int *)lfs_calloc(minutiae->num, sizeof(int));
    if(to_remove == (int *)NULL){
       fprintf(stderr, "ERROR : remove_hooks : calloc : to_remove\n");
       return(-640);
@@ -234,7 +234,7 @@ static int remove_hooks(MINUTIAE *minutiae,
                      if((deltadir = closest_dir_dist(minutia1->direction,
                                     minutia2->direction, full_ndirs)) ==
                                     INVALID_DIR){
-                        free(to_remove);
+                        lfs_free(to_remove);
                         fprintf(stderr,
                                 "ERROR : remove_hooks : INVALID direction\n");
                         return(-641);
@@ -278,7 +278,7 @@ static int remove_hooks(MINUTIAE *minutiae,
                            }
                            /* If system error occurred during hook test ... */
                            else if (ret < 0){
-                              free(to_remove);
+                              lfs_free(to_remove);
                               return(ret);
                            }
                            /* Otherwise, no hook found, so skip to next */
@@ -328,14 +328,14 @@ static int remove_hooks(MINUTIAE *minutiae,
       if(to_remove[i]){
          /* Remove the minutia from the minutiae list. */
          if((ret = remove_minutia(i, minutiae))){
-            free(to_remove);
+            lfs_free(to_remove);
             return(ret);
          }
       }
    }
 
    /* Deallocate flag list. */
-   free(to_remove);
+   lfs_free(to_remove);
 
    /* Return normally. */
    return(0);
@@ -382,7 +382,7 @@ static int remove_islands_and_lakes(MINUTIAE *minutiae,
    /* Allocate list of minutia indices that upon completion of testing */
    /* should be removed from the minutiae lists.  Note: That using      */
    /* "calloc" initializes the list to FALSE.                          */
-   to_remove = (int *)calloc(minutiae->num, sizeof(int));
+   to_remove = (int *)lfs_calloc(minutiae->num, sizeof(int));
    if(to_remove == (int *)NULL){
       fprintf(stderr,
               "ERROR : remove_islands_and_lakes : calloc : to_remove\n");
@@ -472,7 +472,7 @@ static int remove_islands_and_lakes(MINUTIAE *minutiae,
                         if((deltadir = closest_dir_dist(minutia1->direction,
                                        minutia2->direction, full_ndirs)) ==
                                        INVALID_DIR){
-                           free(to_remove);
+                           lfs_free(to_remove);
                            fprintf(stderr,
                      "ERROR : remove_islands_and_lakes : INVALID direction\n");
                            return(-611);
@@ -504,7 +504,7 @@ static int remove_islands_and_lakes(MINUTIAE *minutiae,
                                                  bdata, iw, ih))){
                                  free_contour(loop_x, loop_y,
                                               loop_ex, loop_ey);
-                                 free(to_remove);
+                                 lfs_free(to_remove);
                                  return(ret);
                               }
                               /* Set to remove first minutia. */
@@ -527,7 +527,7 @@ static int remove_islands_and_lakes(MINUTIAE *minutiae,
                            }
                            /* If ERROR while looking for island/lake ... */
                            else if (ret < 0){
-                              free(to_remove);
+                              lfs_free(to_remove);
                               return(ret);
                            }
                            else
@@ -572,14 +572,14 @@ static int remove_islands_and_lakes(MINUTIAE *minutiae,
       if(to_remove[i]){
          /* Remove the minutia from the minutiae list. */
          if((ret = remove_minutia(i, minutiae))){
-            free(to_remove);
+            lfs_free(to_remove);
             return(ret);
          }
       }
    }
 
    /* Deallocate flag list. */
-   free(to_remove);
+   lfs_free(to_remove);
 
    /* Return normally. */
    return(0);
@@ -781,8 +781,8 @@ static int remove_malformations(MINUTIAE *minutiae,
                         print2log("%d,%d RMMAL3 (%f)\n",
                                   minutia->x, minutia->y, ratio);
                         if((ret = remove_minutia(i, minutiae))){
-                           free(x_list);
-                           free(y_list);
+                           lfs_free(x_list);
+                           lfs_free(y_list);
                            /* If system error, return error code. */
                            return(ret);
                         }
@@ -792,8 +792,8 @@ static int remove_malformations(MINUTIAE *minutiae,
                   }
                }
 
-               free(x_list);
-               free(y_list);
+               lfs_free(x_list);
+               lfs_free(y_list);
 
             }
          }
@@ -1156,7 +1156,7 @@ static int remove_overlaps(MINUTIAE *minutiae,
    /* Allocate list of minutia indices that upon completion of testing */
    /* should be removed from the minutiae lists.  Note: That using      */
    /* "calloc" initializes the list to FALSE.                          */
-   to_remove = (int *)calloc(minutiae->num, sizeof(int));
+   to_remove = (int *)lfs_calloc(minutiae->num, sizeof(int));
    if(to_remove == (int *)NULL){
       fprintf(stderr, "ERROR : remove_overlaps : calloc : to_remove\n");
       return(-650);
@@ -1238,7 +1238,7 @@ static int remove_overlaps(MINUTIAE *minutiae,
                      if((deltadir = closest_dir_dist(minutia1->direction,
                                     minutia2->direction, full_ndirs)) ==
                                     INVALID_DIR){
-                        free(to_remove);
+                        lfs_free(to_remove);
                         fprintf(stderr,
                            "ERROR : remove_overlaps : INVALID direction\n");
                         return(-651);
@@ -1337,14 +1337,14 @@ static int remove_overlaps(MINUTIAE *minutiae,
       if(to_remove[i]){
          /* Remove the minutia from the minutiae list. */
          if((ret = remove_minutia(i, minutiae))){
-            free(to_remove);
+            lfs_free(to_remove);
             return(ret);
          }
       }
    }
 
    /* Deallocate flag list. */
-   free(to_remove);
+   lfs_free(to_remove);
 
    /* Return normally. */
    return(0);
@@ -1783,7 +1783,8 @@ static int remove_or_adjust_side_minutiae_V2(MINUTIAE *minutiae,
 
    /* Allocate working memory for holding rotated y-coord of a */
    /* minutia's contour.                                       */
-   rot_y = (int *)malloc(((lfsparms->side_half_contour<<1)+1) * sizeof(int));
+   rot_y = (int *)lfs_malloc(((lfsparms->side_half_contour<<1)+1) *
+                             sizeof(int));
    if(rot_y == (int *)NULL){
       fprintf(stderr,
               "ERROR : remove_or_adjust_side_minutiae_V2 : malloc : rot_y\n");
@@ -1810,7 +1811,7 @@ static int remove_or_adjust_side_minutiae_V2(MINUTIAE *minutiae,
       /* If system error occurred ... */
       if(ret < 0){
          /* Deallocate working memory. */
-         free(rot_y);
+         lfs_free(rot_y);
          /* Return error code. */
          return(ret);
       }
@@ -1826,7 +1827,7 @@ static int remove_or_adjust_side_minutiae_V2(MINUTIAE *minutiae,
          /* Remove minutia from list. */
          if((ret = remove_minutia(i, minutiae))){
             /* Deallocate working memory. */
-            free(rot_y);
+            lfs_free(rot_y);
             /* Return error code. */
             return(ret);
          }
@@ -1879,7 +1880,7 @@ static int remove_or_adjust_side_minutiae_V2(MINUTIAE *minutiae,
                           &minmax_alloc, &minmax_num,
                           rot_y, ncontour))){
             /* If system error, then deallocate working memories. */
-            free(rot_y);
+            lfs_free(rot_y);
             free_contour(contour_x, contour_y, contour_ex, contour_ey);
             /* Return error code. */
             return(ret);
@@ -1905,12 +1906,12 @@ static int remove_or_adjust_side_minutiae_V2(MINUTIAE *minutiae,
                /* Remove minutia from list. */
                if((ret = remove_minutia(i, minutiae))){
                   /* Deallocate working memory. */
-                  free(rot_y);
+                  lfs_free(rot_y);
                   free_contour(contour_x, contour_y, contour_ex, contour_ey);
                   if(minmax_alloc > 0){
-                     free(minmax_val);
-                     free(minmax_type);
-                     free(minmax_i);
+                     lfs_free(minmax_val);
+                     lfs_free(minmax_type);
+                     lfs_free(minmax_i);
                   }
                   /* Return error code. */
                   return(ret);
@@ -1951,12 +1952,12 @@ static int remove_or_adjust_side_minutiae_V2(MINUTIAE *minutiae,
                /* Remove minutia from list. */
                if((ret = remove_minutia(i, minutiae))){
                   /* Deallocate working memory. */
-                  free(rot_y);
+                  lfs_free(rot_y);
                   free_contour(contour_x, contour_y, contour_ex, contour_ey);
                   if(minmax_alloc > 0){
-                     free(minmax_val);
-                     free(minmax_type);
-                     free(minmax_i);
+                     lfs_free(minmax_val);
+                     lfs_free(minmax_type);
+                     lfs_free(minmax_i);
                   }
                   /* Return error code. */
                   return(ret);
@@ -1980,12 +1981,12 @@ static int remove_or_adjust_side_minutiae_V2(MINUTIAE *minutiae,
             /* Remove minutia from list. */
             if((ret = remove_minutia(i, minutiae))){
                /* If system error, then deallocate working memories. */
-               free(rot_y);
+               lfs_free(rot_y);
                free_contour(contour_x, contour_y, contour_ex, contour_ey);
                if(minmax_alloc > 0){
-                  free(minmax_val);
-                  free(minmax_type);
-                  free(minmax_i);
+                  lfs_free(minmax_val);
+                  lfs_free(minmax_type);
+                  lfs_free(minmax_i);
                }
                /* Return error code. */
                return(ret);
@@ -1997,15 +1998,15 @@ static int remove_or_adjust_side_minutiae_V2(MINUTIAE *minutiae,
          /* Deallocate contour and min/max buffers. */
          free_contour(contour_x, contour_y, contour_ex, contour_ey);
          if(minmax_alloc > 0){
-            free(minmax_val);
-            free(minmax_type);
-            free(minmax_i);
+            lfs_free(minmax_val);
+            lfs_free(minmax_type);
+            lfs_free(minmax_i);
          }
       } /* End else contour extracted. */
    } /* End while not end of minutiae list. */
 
    /* Deallocate working memory. */
-   free(rot_y);
+   lfs_free(rot_y);
 
    /* Return normally. */
    return(0);
@@ -134,7 +134,8 @@ static int insert_neighbor(const int pos, const int nbr_index, const double nbr_
 #cat:               determines if the new neighbor is sufficiently close
 #cat:               to be added to the list of nearest neighbors.  If added,
 #cat:               it is placed in the list in its proper order based on
-#cat:               squared distance to the primary point.
+#cat:               squared distance to the primary point.  Neighbors at
+#cat:               the same distance are ordered on their list index.
 
    Input:
       nbr_list - current list of nearest neighbor minutia indices
@@ -174,12 +175,20 @@ static int update_nbr_dists(int *nbr_list, double *nbr_sqr_dists,
 
    /* If maximum number of neighbors not yet stored in lists OR */
    /* if the squared distance to current secondary is less      */
-   /* than the largest stored neighbor distance ...             */
+   /* than the largest stored neighbor distance (or equal, with */
+   /* a smaller index) ...                                      */
    if((*nnbrs < max_nbrs) ||
-      (dist2 < nbr_sqr_dists[last_nbr])){
+      (dist2 < nbr_sqr_dists[last_nbr]) ||
+      ((dist2 == nbr_sqr_dists[last_nbr]) && (second < nbr_list[last_nbr]))){
 
       /* Find insertion point in neighbor lists. */
       pos = find_incr_position_dbl(dist2, nbr_sqr_dists, *nnbrs);
+      /* Neighbors are not visited in list order, so move the new */
+      /* neighbor ahead of those at the same distance with larger */
+      /* indices.                                                 */
+      while((pos > 0) && (nbr_sqr_dists[pos-1] == dist2) &&
+            (nbr_list[pos-1] > second))
+         pos--;
       /* If the position returned is >= maximum list length (this should */
       /* never happen, but just in case) ...                             */
       if(pos >= max_nbrs){
@@ -208,15 +217,18 @@ static int update_nbr_dists(int *nbr_list, double *nbr_sqr_dists,
 **************************************************************************
 #cat: find_neighbors - Takes a primary minutia and a list of all minutiae
 #cat:               and locates a specified maximum number of closest neighbors
-#cat:               to the primary point.  Neighbors are searched, starting
-#cat:               in the same pixel column, below, the primary point and then
-#cat:               along consecutive and complete pixel columns in the image
-#cat:               to the right of the primary point.
+#cat:               to the primary point among the minutiae that follow it in
+#cat:               the list.  The list is sorted on X and then on Y, so these
+#cat:               lie below the primary point in the same pixel column and
+#cat:               in the pixel columns to its right.  Neighbors are searched
+#cat:               in rings of grid cells around the primary point, until no
+#cat:               unvisited cell can hold a closer neighbor.
 
    Input:
       max_nbrs - maximum number of closest neighbors to be returned
       first    - index of the primary minutia point
       minutiae - list of minutiae
+      mingrid  - the minutiae bucketed by location
    Output:
       onbr_list - points to list of detected closest neighbors
       onnbrs    - points to number of neighbors returned
@@ -225,15 +237,17 @@ static int update_nbr_dists(int *nbr_list, double *nbr_sqr_dists,
       Negative  - system error
 **************************************************************************/
 static int find_neighbors(int **onbr_list, int *onnbrs, const int max_nbrs,
-                   const int first, MINUTIAE *minutiae)
+                   const int first, MINUTIAE *minutiae,
+                   const MINGRID *mingrid)
 {
    int ret, second, last_nbr;
-   MINUTIA *minutia1, *minutia2;
+   MINUTIA *minutia1;
    int *nbr_list, nnbrs;
-   double *nbr_sqr_dists, xdist, xdist2;
+   double *nbr_sqr_dists, bound;
+   int cx, cy, r, gx, gy, gstep, i;
 
    /* Allocate list of neighbor minutiae indices. */
-   nbr_list = (int *)malloc(max_nbrs * sizeof(int));
+   nbr_list = (int *)lfs_malloc(max_nbrs * sizeof(int));
    if(nbr_list == (int *)NULL){
       fprintf(stderr, "ERROR : find_neighbors : malloc : nbr_list\n");
       return(-460);
@@ -241,9 +255,9 @@ static int find_neighbors(int **onbr_list, int *onnbrs, const int max_nbrs,
 
    /* Allocate list of squared euclidean distances between neighbors */
    /* and current primary minutia point.                             */
-   nbr_sqr_dists = (double *)malloc(max_nbrs * sizeof(double));
+   nbr_sqr_dists = (double *)lfs_malloc(max_nbrs * sizeof(double));
    if(nbr_sqr_dists == (double *)NULL){
-      free(nbr_list);
+      lfs_free(nbr_list);
       fprintf(stderr,
               "ERROR : find_neighbors : malloc : nbr_sqr_dists\n");
       return(-461);
@@ -251,55 +265,66 @@ static int find_neighbors(int **onbr_list, int *onnbrs, const int max_nbrs,
 
    /* Initialize number of stored neighbors to 0. */
    nnbrs = 0;
-   /* Assign secondary to one passed current primary minutia. */
-   second = first + 1;
    /* Compute location of maximum last stored neighbor. */
    last_nbr = max_nbrs - 1;
 
-   /* While minutia (in sorted order) still remian for processing ... */
-   /* NOTE: The minutia in the input list have been sorted on X and   */
-   /* then on Y.  So, the neighbors are selected according to those   */
-   /* that lie below the primary minutia in the same pixel column and */
-   /* then subsequently those that lie in complete pixel columns to   */
-   /* the right of the primary minutia.                               */
-   while(second < minutiae->num){
-      /* Assign temporary minutia pointers. */
-      minutia1 = minutiae->list[first];
-      minutia2 = minutiae->list[second];
-
-      /* Compute squared distance between minutiae along x-axis. */
-      xdist = minutia2->x - minutia1->x;
-      xdist2 = xdist * xdist;
-
-      /* If the neighbor lists are not full OR the x-distance to current */
-      /* secondary is smaller than maximum neighbor distance stored ...  */
-      if((nnbrs < max_nbrs) ||
-         (xdist2 < nbr_sqr_dists[last_nbr])){
-         /* Append or insert the new neighbor into the neighbor lists. */
-         if((ret = update_nbr_dists(nbr_list, nbr_sqr_dists, &nnbrs, max_nbrs,
-                          first, second, minutiae))){
-            free(nbr_sqr_dists);
-            return(ret);
-         }
-      }
-      /* Otherwise, if the neighbor lists is full AND the x-distance   */
-      /* to current secondary is larger than maximum neighbor distance */
-      /* stored ...                                                    */
-      else
-         /* So, stop searching for more neighbors. */
+   /* Locate the cell of the primary minutia. */
+   minutia1 = minutiae->list[first];
+   cx = minutia1->x / mingrid->cellsize;
+   cy = minutia1->y / mingrid->cellsize;
+
+   /* Foreach ring of cells around the primary cell ... */
+   for(r = 0; ; r++){
+      /* If the ring lies entirely outside the grid, we are done. */
+      if((cx - r < 0) && (cy - r < 0) &&
+         (cx + r >= mingrid->gw) && (cy + r >= mingrid->gh))
          break;
 
-       /* Bump to next secondary minutia. */
-       second++;
+      /* If the neighbor lists are full AND every minutia in the ring */
+      /* is farther than the maximum neighbor distance stored ...     */
+      /* (a minutia r cells away is at least (r-1)*cellsize+1 pixels  */
+      /* away along x or y)                                           */
+      if((r > 0) && (nnbrs == max_nbrs)){
+         bound = ((r - 1) * mingrid->cellsize) + 1;
+         if((bound * bound) > nbr_sqr_dists[last_nbr])
+            /* So, stop searching for more neighbors. */
+            break;
+      }
+
+      /* Foreach cell on the ring inside the grid ... */
+      for(gy = max(cy - r, 0); gy <= min(cy + r, mingrid->gh - 1); gy++){
+         /* Rows strictly inside the ring only have their end cells. */
+         gstep = ((gy == cy - r) || (gy == cy + r)) ? 1 : (r << 1);
+         for(gx = cx - r; gx <= cx + r; gx += gstep){
+            if((gx < 0) || (gx >= mingrid->gw))
+               continue;
+            /* Foreach minutia in the cell ... */
+            for(i = mingrid->cells[(gy * mingrid->gw) + gx];
+                i < mingrid->cells[(gy * mingrid->gw) + gx + 1]; i++){
+               second = mingrid->items[i];
+               /* Only minutiae following the primary are neighbors. */
+               if(second <= first)
+                  continue;
+               /* Append or insert the new neighbor into the neighbor */
+               /* lists if it is close enough.                        */
+               if((ret = update_nbr_dists(nbr_list, nbr_sqr_dists, &nnbrs,
+                                max_nbrs, first, second, minutiae))){
+                  lfs_free(nbr_sqr_dists);
+                  lfs_free(nbr_list);
+                  return(ret);
+               }
+            }
+         }
+      }
    }
 
    /* Deallocate working memory. */
-   free(nbr_sqr_dists);
+   lfs_free(nbr_sqr_dists);
 
    /* If no neighbors found ... */
    if(nnbrs == 0){
       /* Deallocate the neighbor list. */
-      free(nbr_list);
+      lfs_free(nbr_list);
       *onnbrs = 0;
    }
    /* Otherwise, assign neighbors to output pointer. */
@@ -340,7 +365,7 @@ static int sort_neighbors(int *nbr_list, const int nnbrs, const int first,
 
    /* List of angles of lines joining the current primary to each */
    /* of the secondary neighbors.                                 */
-   join_thetas = (double *)malloc(nnbrs * sizeof(double));
+   join_thetas = (double *)lfs_malloc(nnbrs * sizeof(double));
    if(join_thetas == (double *)NULL){
       fprintf(stderr, "ERROR : sort_neighbors : malloc : join_thetas\n");
       return(-490);
@@ -366,7 +391,7 @@ static int sort_neighbors(int *nbr_list, const int nnbrs, const int first,
    bubble_sort_double_inc_2(join_thetas, nbr_list, nnbrs);
 
    /* Deallocate the list of angles. */
-   free(join_thetas);
+   lfs_free(join_thetas);
 
    /* Return normally. */
    return(0);      
@@ -587,8 +612,8 @@ static int ridge_count(const int first, const int second, MINUTIAE *minutiae,
    /* It there are no points on the line trajectory, then no ridges */
    /* to count (this should not happen, but just in case) ...       */
    if(num == 0){
-      free(xlist);
-      free(ylist);
+      lfs_free(xlist);
+      lfs_free(ylist);
       return(0);
    }
 
@@ -608,8 +633,8 @@ static int ridge_count(const int first, const int second, MINUTIAE *minutiae,
 
    /* If opposite pixel not found ... then no ridges to count */
    if(!found){
-      free(xlist);
-      free(ylist);
+      lfs_free(xlist);
+      lfs_free(ylist);
       return(0);
    }
 
@@ -624,8 +649,8 @@ static int ridge_count(const int first, const int second, MINUTIAE *minutiae,
       /* If 0-to-1 transition not found ... */
       if(!find_transition(&i, 0, 1, xlist, ylist, num, bdata, iw, ih)){
          /* Then we are done looking for ridges. */
-         free(xlist);
-         free(ylist);
+         lfs_free(xlist);
+         lfs_free(ylist);
 
          print2log("\n");
 
@@ -641,8 +666,8 @@ static int ridge_count(const int first, const int second, MINUTIAE *minutiae,
       /* If 1-to-0 transition not found ... */
       if(!find_transition(&i, 1, 0, xlist, ylist, num, bdata, iw, ih)){
          /* Then we are done looking for ridges. */
-         free(xlist);
-         free(ylist);
+         lfs_free(xlist);
+         lfs_free(ylist);
 
          print2log("\n");
 
@@ -668,8 +693,8 @@ static int ridge_count(const int first, const int second, MINUTIAE *minutiae,
 
       /* If system error ... */
       if(ret < 0){
-         free(xlist);
-         free(ylist);
+         lfs_free(xlist);
+         lfs_free(ylist);
          /* Return the error code. */
          return(ret);
       }
@@ -688,8 +713,8 @@ static int ridge_count(const int first, const int second, MINUTIAE *minutiae,
    }
 
    /* Deallocate working memories. */
-   free(xlist);
-   free(ylist);
+   lfs_free(xlist);
+   lfs_free(ylist);
 
    print2log("\n");
 
@@ -704,7 +729,9 @@ static int ridge_count(const int first, const int second, MINUTIAE *minutiae,
 #cat:                between the minutia point and each of its neighbors.
 
    Input:
-      minutia   - input minutia
+      first     - index of the input minutia
+      minutiae  - list of minutiae
+      mingrid   - the minutiae bucketed by location
       bdata     - binary image data (0==while & 1==black)
       iw        - width (in pixels) of image
       ih        - height (in pixels) of image
@@ -716,15 +743,15 @@ static int ridge_count(const int first, const int second, MINUTIAE *minutiae,
       Negative - system error
 **************************************************************************/
 static int count_minutia_ridges(const int first, MINUTIAE *minutiae,
-                      unsigned char *bdata, const int iw, const int ih,
+                      const MINGRID *mingrid, unsigned char *bdata, const int iw, const int ih,
                       const LFSPARMS *lfsparms)
 {
    int i, ret, *nbr_list = NULL, *nbr_nridges, nnbrs;
 
    /* Find up to the maximum number of qualifying neighbors. */
    if((ret = find_neighbors(&nbr_list, &nnbrs, lfsparms->max_nbrs,
-                           first, minutiae))){
-      free(nbr_list);
+                           first, minutiae, mingrid))){
+      lfs_free(nbr_list);
       return(ret);
    }
 
@@ -739,15 +766,15 @@ static int count_minutia_ridges(const int first, MINUTIAE *minutiae,
 
    /* Sort neighbors on delta dirs. */
    if((ret = sort_neighbors(nbr_list, nnbrs, first, minutiae))){
-      free(nbr_list);
+      lfs_free(nbr_list);
       return(ret);
    }
 
    /* Count ridges between first and neighbors. */
    /* List of ridge counts, one for each neighbor stored. */
-   nbr_nridges = (int *)malloc(nnbrs * sizeof(int));
+   nbr_nridges = (int *)lfs_malloc(nnbrs * sizeof(int));
    if(nbr_nridges == (int *)NULL){
-      free(nbr_list);
+      lfs_free(nbr_list);
       fprintf(stderr, "ERROR : count_minutia_ridges : malloc : nbr_nridges\n");
       return(-450);
    }
@@ -759,8 +786,8 @@ static int count_minutia_ridges(const int first, MINUTIAE *minutiae,
       /* If system error ... */
       if(ret < 0){
          /* Deallocate working memories. */
-         free(nbr_list);
-         free(nbr_nridges);
+         lfs_free(nbr_list);
+         lfs_free(nbr_nridges);
          /* Return error code. */
          return(ret);
       }
@@ -803,6 +830,7 @@ int count_minutiae_ridges(MINUTIAE *minutiae,
 {
    int ret;
    int i;
+   MINGRID *mingrid;
 
    print2log("\nFINDING NBRS AND COUNTING RIDGES:\n");
 
@@ -816,16 +844,25 @@ int count_minutiae_ridges(MINUTIAE *minutiae,
       return(ret);
    }
 
+   /* Bucket the remaining minutiae by location. */
+   if((ret = build_mingrid(&mingrid, minutiae, iw, ih))){
+      return(ret);
+   }
+
    /* Foreach remaining sorted minutia in list ... */
    for(i = 0; i < minutiae->num-1; i++){
       /* Located neighbors and count number of ridges in between. */
       /* NOTE: neighbor and ridge count results are stored in     */
       /*       minutiae->list[i].                                 */
-      if((ret = count_minutia_ridges(i, minutiae, bdata, iw, ih, lfsparms))){
+      if((ret = count_minutia_ridges(i, minutiae, mingrid,
+                                     bdata, iw, ih, lfsparms))){
+         free_mingrid(mingrid);
          return(ret);
       }
    }
 
+   free_mingrid(mingrid);
+
    /* Return normally. */
    return(0);
 }
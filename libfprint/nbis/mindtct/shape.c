@@ -77,7 +77,7 @@ static int alloc_shape(SHAPE **oshape, const int xmin, const int ymin,
    alloc_pts = xmax - xmin + 1;
 
    /* Allocate the shape structure. */
-   shape = (SHAPE *)malloc(sizeof(SHAPE));
+   shape = (SHAPE *)lfs_malloc(sizeof(SHAPE));
    /* If there is an allocation error... */
    if(shape == (SHAPE *)NULL){
       fprintf(stderr, "ERROR : alloc_shape : malloc : shape\n");
@@ -86,11 +86,11 @@ static int alloc_shape(SHAPE **oshape, const int xmin, const int ymin,
 
    /* Allocate the list of row pointers.  We now this number will fit */
    /* the shape exactly.                                              */
-   shape->rows = (ROW **)malloc(alloc_rows * sizeof(ROW *));
+   shape->rows = (ROW **)lfs_malloc(alloc_rows * sizeof(ROW *));
    /* If there is an allocation error... */
    if(shape->rows == (ROW **)NULL){
       /* Deallocate memory alloated by this routine to this point. */
-      free(shape);
+      lfs_free(shape);
       fprintf(stderr, "ERROR : alloc_shape : malloc : shape->rows\n");
       return(-251);
    }
@@ -107,32 +107,32 @@ static int alloc_shape(SHAPE **oshape, const int xmin, const int ymin,
    for(i = 0, y = ymin; i < alloc_rows; i++, y++){
       /* Allocate a row structure and store it in its respective position */
       /* in the shape structure's list of row pointers.                   */
-      shape->rows[i] = (ROW *)malloc(sizeof(ROW));
+      shape->rows[i] = (ROW *)lfs_malloc(sizeof(ROW));
       /* If there is an allocation error... */
       if(shape->rows[i] == (ROW *)NULL){
          /* Deallocate memory alloated by this routine to this point. */
          for(j = 0; j < i; j++){
-            free(shape->rows[j]->xs);
-            free(shape->rows[j]);
+            lfs_free(shape->rows[j]->xs);
+            lfs_free(shape->rows[j]);
          }
-         free(shape->rows);
-         free(shape);
+         lfs_free(shape->rows);
+         lfs_free(shape);
          fprintf(stderr, "ERROR : alloc_shape : malloc : shape->rows[i]\n");
          return(-252);
       }
 
       /* Allocate the current rows list of x-coords. */
-      shape->rows[i]->xs = (int *)malloc(alloc_pts * sizeof(int));
+      shape->rows[i]->xs = (int *)lfs_malloc(alloc_pts * sizeof(int));
       /* If there is an allocation error... */
       if(shape->rows[i]->xs == (int *)NULL){
          /* Deallocate memory alloated by this routine to this point. */
          for(j = 0; j < i; j++){
-            free(shape->rows[j]->xs);
-            free(shape->rows[j]);
+            lfs_free(shape->rows[j]->xs);
+            lfs_free(shape->rows[j]);
          }
-         free(shape->rows[i]);
-         free(shape->rows);
-         free(shape);
+         lfs_free(shape->rows[i]);
+         lfs_free(shape->rows);
+         lfs_free(shape);
          fprintf(stderr,
                  "ERROR : alloc_shape : malloc : shape->rows[i]->xs\n");
          return(-253);
@@ -167,15 +167,15 @@ void free_shape(SHAPE *shape)
    /* Foreach allocated row in the shape ... */
    for(i = 0; i < shape->alloc; i++){
       /* Deallocate the current row's list of x-coords. */
-      free(shape->rows[i]->xs);
+      lfs_free(shape->rows[i]->xs);
       /* Deallocate the current row structure. */
-      free(shape->rows[i]);
+      lfs_free(shape->rows[i]);
    }
 
    /* Deallocate the list of row pointers. */
-   free(shape->rows);
+   lfs_free(shape->rows);
    /* Deallocate the shape structure. */
-   free(shape);
+   lfs_free(shape);
 }
 
 /*************************************************************************
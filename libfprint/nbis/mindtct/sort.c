@@ -35,6 +35,7 @@ identified are necessarily the best available for the purpose.
 ***********************************************************************
                ROUTINES:
                         sort_indices_int_inc()
+                        cmp_rank_items()
                         sort_indices_double_inc()
                         bubble_sort_int_inc_2()
                         bubble_sort_double_inc_2()
@@ -46,12 +47,22 @@ identified are necessarily the best available for the purpose.
 #include <stdlib.h>
 #include <lfs.h>
 
+/* Rank of an item being sorted by sort_indices_int_inc(). */
+typedef struct rankitem{
+   int rank;
+   int item;
+} RANKITEM;
+
+static int cmp_rank_items(const void *, const void *);
+
 /*************************************************************************
 **************************************************************************
 #cat: sort_indices_int_inc - Takes a list of integers and returns a list of
 #cat:                 indices referencing the integer list in increasing order.
 #cat:                 The original list of integers is also returned in sorted
-#cat:                 order.
+#cat:                 order.  Equal integers keep their original order, as
+#cat:                 with bubble_sort_int_inc_2(), but the list is sorted
+#cat:                 in O(N log N) time.
 
    Input:
       ranks  - list of integers to be sorted
@@ -66,20 +77,36 @@ identified are necessarily the best available for the purpose.
 int sort_indices_int_inc(int **optr, int *ranks, const int num)
 {
    int *order;
+   RANKITEM *pairs;
    int i;
 
    /* Allocate list of sequential indices. */
-   order = (int *)malloc(num * sizeof(int));
+   order = (int *)lfs_malloc(num * sizeof(int));
    if(order == (int *)NULL){
       fprintf(stderr, "ERROR : sort_indices_int_inc : malloc : order\n");
       return(-390);
    }
-   /* Initialize list of sequential indices. */
-   for(i = 0; i < num; i++)
-      order[i] = i;
+   /* Allocate list of (rank, index) pairs to be sorted. */
+   pairs = (RANKITEM *)lfs_malloc(max(num, 1) * sizeof(RANKITEM));
+   if(pairs == (RANKITEM *)NULL){
+      lfs_free(order);
+      fprintf(stderr, "ERROR : sort_indices_int_inc : malloc : pairs\n");
+      return(-391);
+   }
+   /* Pair each rank with its sequential index. */
+   for(i = 0; i < num; i++){
+      pairs[i].rank = ranks[i];
+      pairs[i].item = i;
+   }
 
-   /* Sort the indecies into rank order. */
-   bubble_sort_int_inc_2(ranks, order, num);
+   /* Sort the indecies into rank order.  No two pairs are equal, so */
+   /* the order is the same as the stable bubble sort's.             */
+   qsort(pairs, num, sizeof(RANKITEM), cmp_rank_items);
+   for(i = 0; i < num; i++){
+      ranks[i] = pairs[i].rank;
+      order[i] = pairs[i].item;
+   }
+   lfs_free(pairs);
 
    /* Set output pointer to the resulting order of sorted indices. */
    *optr = order;
@@ -87,6 +114,29 @@ int sort_indices_int_inc(int **optr, int *ranks, const int num)
    return(0);
 }
 
+/*************************************************************************
+**************************************************************************
+#cat: cmp_rank_items - Compares two (rank, item) pairs for qsort(), on
+#cat:                 their ranks and then on their items.
+
+   Input:
+      a      - first RANKITEM
+      b      - second RANKITEM
+   Return Code:
+      Negative, zero or positive as a sorts before, with or after b
+**************************************************************************/
+static int cmp_rank_items(const void *a, const void *b)
+{
+   const RANKITEM *pa = (const RANKITEM *)a;
+   const RANKITEM *pb = (const RANKITEM *)b;
+
+   if(pa->rank != pb->rank)
+      return((pa->rank < pb->rank) ? -1 : 1);
+   if(pa->item != pb->item)
+      return((pa->item < pb->item) ? -1 : 1);
+   return(0);
+}
+
 /*************************************************************************
 **************************************************************************
 #cat: sort_indices_double_inc - Takes a list of doubles and returns a list of
@@ -110,7 +160,7 @@ int sort_indices_double_inc(int **optr, double *ranks, const int num)
    int i;
 
    /* Allocate list of sequential indices. */
-   order = (int *)malloc(num * sizeof(int));
+   order = (int *)lfs_malloc(num * sizeof(int));
    if(order == (int *)NULL){
       fprintf(stderr, "ERROR : sort_indices_double_inc : malloc : order\n");
       return(-400);
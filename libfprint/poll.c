@@ -21,9 +21,30 @@
 
 #include <config.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include <sys/time.h>
 
+/* The Linux event notification fds are used where available. Elsewhere, the
+ * event loop polls the poll fds, worker wakeups go through a pipe, and the
+ * first timeout of the library bounds the waits instead of a timerfd. */
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_EPOLL_CREATE1)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#endif
+#if defined(HAVE_SYS_EVENTFD_H) && defined(HAVE_EVENTFD)
+#define USE_EVENTFD
+#include <sys/eventfd.h>
+#endif
+#if defined(HAVE_SYS_TIMERFD_H) && defined(HAVE_TIMERFD_CREATE)
+#define USE_TIMERFD
+#include <sys/timerfd.h>
+#endif
+
 #include <glib.h>
 #include <libusb.h>
 
@@ -34,13 +55,14 @@
  * These functions are only applicable to users of libfprint's asynchronous
  * API.
  *
- * libfprint does not create internal library threads and hence can only
- * execute when your application is calling a libfprint function. However,
- * libfprint often has work to be do, such as handling of completed USB
- * transfers, and processing of timeouts required in order for the library
- * to function. Therefore it is essential that your own application must
- * regularly "phone into" libfprint so that libfprint can handle any pending
- * events.
+ * Apart from a pool of worker threads used internally to spread print
+ * matching over several CPUs, libfprint does not create internal library
+ * threads and hence can only execute when your application is calling a
+ * libfprint function. However, libfprint often has work to be do, such as
+ * handling of completed USB transfers, and processing of timeouts required
+ * in order for the library to function. Therefore it is essential that your
+ * own application must regularly "phone into" libfprint so that libfprint
+ * can handle any pending events.
  *
  * The function you must call is fp_handle_events() or a variant of it. This
  * function will handle any pending events, and it is from this context that
@@ -55,43 +77,169 @@
  *
  * TODO: document how application is supposed to know when to call these
  * functions.
+ *
+ * All devices of a \ref context "context" are served by the same events: a
+ * single fp_handle_events() call dispatches the pending USB transfers and
+ * timeouts of every device open in the context of the calling thread, each
+ * to the callback of its own asynchronous operation. A single thread can
+ * therefore drive many devices at once through the asynchronous API.
+ * Applications without an event loop of their own can let an fp_event_loop
+ * wait for the events of all devices:
+ *
+ * \code
+ * struct fp_event_loop *loop = fp_event_loop_new();
+ *
+ * fp_async_verify_start(dev1, print1, verify_cb, ctx1);
+ * fp_async_verify_start(dev2, print2, verify_cb, ctx2);
+ * fp_event_loop_run(loop);	// until a callback calls fp_event_loop_quit()
+ * fp_event_loop_free(loop);
+ * \endcode
  */
 
-/* this is a singly-linked list of pending timers, sorted with the timer that
- * is expiring soonest at the head. */
-static GSList *active_timers = NULL;
+/* The pending timers of a context are kept in its active_timers array as a
+ * binary min-heap ordered by expiry, so the timer expiring soonest is at index
+ * 0. Each timer knows its own index, which lets it be cancelled without a
+ * search. Timers with the same expiry are ordered by the sequence number they
+ * were added with. */
 
-/* notifiers for added or removed poll fds */
-static fp_pollfd_added_cb fd_added_cb = NULL;
-static fp_pollfd_removed_cb fd_removed_cb = NULL;
+/* An event loop waiting on the poll fds of a context, through an epoll
+ * instance watching them where available. There is at most one per context,
+ * since all its devices share the same poll fds. */
+struct fp_event_loop {
+	struct fp_context *ctx;
+#ifdef USE_EPOLL
+	int epfd;
+#endif
+	int quit;
+};
+
+/* index of a timer in the held_timers array rather than in the heap */
+#define TIMER_HELD	G_MAXUINT
 
 struct fpi_timeout {
+	struct fp_context *ctx;
 	struct timeval expiry;
+	guint64 seq;
+	guint index;
 	fpi_timeout_fn callback;
 	void *data;
 };
 
-static int timeout_sort_fn(gconstpointer _a, gconstpointer _b)
+/* returns TRUE if timeout a is due before timeout b */
+static gboolean timeout_before(struct fpi_timeout *a, struct fpi_timeout *b)
+{
+	if (timercmp(&a->expiry, &b->expiry, !=))
+		return timercmp(&a->expiry, &b->expiry, <);
+	return a->seq < b->seq;
+}
+
+static void timer_heap_set(GPtrArray *timers, guint index,
+	struct fpi_timeout *timeout)
+{
+	g_ptr_array_index(timers, index) = timeout;
+	timeout->index = index;
+}
+
+/* move the timer at index towards the root until its parent is due first */
+static void timer_heap_sift_up(GPtrArray *timers, guint index)
+{
+	struct fpi_timeout *timeout = g_ptr_array_index(timers, index);
+	struct fpi_timeout *parent;
+
+	while (index > 0) {
+		parent = g_ptr_array_index(timers, (index - 1) / 2);
+		if (!timeout_before(timeout, parent))
+			break;
+		timer_heap_set(timers, index, parent);
+		index = (index - 1) / 2;
+	}
+	timer_heap_set(timers, index, timeout);
+}
+
+/* move the timer at index towards the leaves until it is due before both of
+ * its children */
+static void timer_heap_sift_down(GPtrArray *timers, guint index)
+{
+	struct fpi_timeout *timeout = g_ptr_array_index(timers, index);
+	struct fpi_timeout *child;
+	guint len = timers->len;
+	guint c;
+
+	while ((c = 2 * index + 1) < len) {
+		child = g_ptr_array_index(timers, c);
+		if (c + 1 < len && timeout_before(
+				g_ptr_array_index(timers, c + 1), child)) {
+			c++;
+			child = g_ptr_array_index(timers, c);
+		}
+		if (!timeout_before(child, timeout))
+			break;
+		timer_heap_set(timers, index, child);
+		index = c;
+	}
+	timer_heap_set(timers, index, timeout);
+}
+
+/* take a timer out of the heap, filling its slot with the last timer */
+static void timer_heap_remove(struct fpi_timeout *timeout)
 {
-	struct fpi_timeout *a = (struct fpi_timeout *) _a;
-	struct fpi_timeout *b = (struct fpi_timeout *) _b;
-	struct timeval *tv_a = &a->expiry;
-	struct timeval *tv_b = &b->expiry;
+	GPtrArray *timers = timeout->ctx->active_timers;
+	guint index = timeout->index;
+	struct fpi_timeout *last;
 
-	if (timercmp(tv_a, tv_b, <))
-		return -1;
-	else if (timercmp(tv_a, tv_b, >))
-		return 1;
+	last = g_ptr_array_remove_index_fast(timers, timers->len - 1);
+	if (last == timeout)
+		return;
+
+	timer_heap_set(timers, index, last);
+	if (index > 0 && timeout_before(last,
+			g_ptr_array_index(timers, (index - 1) / 2)))
+		timer_heap_sift_up(timers, index);
 	else
-		return 0;
+		timer_heap_sift_down(timers, index);
+}
+
+/* Arm the timerfd of the context to the expiry of its first timeout, or
+ * disarm it if there is none, so that applications polling the fds of the
+ * library wake up for the timeouts without asking for them. Rearming also
+ * makes the fd unreadable again after it fired. Without a timerfd, the
+ * waits are bounded by the first timeout instead. */
+#ifndef USE_TIMERFD
+static void arm_timer_fd(struct fp_context *ctx)
+{
 }
+#else
+static void arm_timer_fd(struct fp_context *ctx)
+{
+	struct itimerspec its = { { 0, 0 }, { 0, 0 } };
+	struct timeval expiry;
+	struct fpi_timeout *first;
+
+	timerclear(&expiry);
+	if (ctx->active_timers && ctx->active_timers->len > 0) {
+		first = g_ptr_array_index(ctx->active_timers, 0);
+		expiry = first->expiry;
+	}
+	if (timercmp(&expiry, &ctx->timer_fd_expiry, ==))
+		return;
+
+	TIMEVAL_TO_TIMESPEC(&expiry, &its.it_value);
+	if (timerfd_settime(ctx->timer_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+		fp_err("timerfd_settime failed, errno=%d", errno);
+		return;
+	}
+	ctx->timer_fd_expiry = expiry;
+}
+#endif
 
 /* A timeout is the asynchronous equivalent of sleeping. You create a timeout
  * saying that you'd like to have a function invoked at a certain time in
- * the future. */
+ * the future. The timeout belongs to the context of the calling thread,
+ * which is that of the device whose callback is running. */
 struct fpi_timeout *fpi_timeout_add(unsigned int msec, fpi_timeout_fn callback,
 	void *data)
 {
+	struct fp_context *ctx = fpi_get_context();
 	struct timespec ts;
 	struct timeval add_msec;
 	struct fpi_timeout *timeout;
@@ -106,8 +254,10 @@ struct fpi_timeout *fpi_timeout_add(unsigned int msec, fpi_timeout_fn callback,
 	}
 
 	timeout = g_malloc(sizeof(*timeout));
+	timeout->ctx = ctx;
 	timeout->callback = callback;
 	timeout->data = data;
+	timeout->seq = ctx->timer_seq++;
 	TIMESPEC_TO_TIMEVAL(&timeout->expiry, &ts);
 
 	/* calculate timeout expiry by adding delay to current monotonic clock */
@@ -116,16 +266,26 @@ struct fpi_timeout *fpi_timeout_add(unsigned int msec, fpi_timeout_fn callback,
 	add_msec.tv_usec = (msec % 1000) * 1000;
 	timeradd(&timeout->expiry, &add_msec, &timeout->expiry);
 
-	active_timers = g_slist_insert_sorted(active_timers, timeout,
-		timeout_sort_fn);
+	g_ptr_array_add(ctx->active_timers, timeout);
+	timer_heap_sift_up(ctx->active_timers, ctx->active_timers->len - 1);
+	if (timeout->index == 0)
+		arm_timer_fd(ctx);
 
 	return timeout;
 }
 
 void fpi_timeout_cancel(struct fpi_timeout *timeout)
 {
+	struct fp_context *ctx = timeout->ctx;
+
 	fp_dbg("");
-	active_timers = g_slist_remove(active_timers, timeout);
+	if (timeout->index == TIMER_HELD) {
+		g_ptr_array_remove_fast(ctx->held_timers, timeout);
+	} else if (ctx->active_timers) {
+		timer_heap_remove(timeout);
+		if (timeout->index == 0)
+			arm_timer_fd(ctx);
+	}
 	g_free(timeout);
 }
 
@@ -134,15 +294,15 @@ void fpi_timeout_cancel(struct fpi_timeout *timeout)
  * timeval/timeout output parameters were populated. if the returned timeval
  * is zero then it means the timeout has already expired and should be handled
  * ASAP. */
-static int get_next_timeout_expiry(struct timeval *out,
-	struct fpi_timeout **out_timeout)
+static int get_next_timeout_expiry(struct fp_context *ctx,
+	struct timeval *out, struct fpi_timeout **out_timeout)
 {
 	struct timespec ts;
 	struct timeval tv;
 	struct fpi_timeout *next_timeout;
 	int r;
 
-	if (active_timers == NULL)
+	if (ctx->active_timers == NULL || ctx->active_timers->len == 0)
 		return 0;
 
 	r = clock_gettime(CLOCK_MONOTONIC, &ts);
@@ -152,7 +312,7 @@ static int get_next_timeout_expiry(struct timeval *out,
 	}
 	TIMESPEC_TO_TIMEVAL(&tv, &ts);
 
-	next_timeout = active_timers->data;
+	next_timeout = g_ptr_array_index(ctx->active_timers, 0);
 	if (out_timeout)
 		*out_timeout = next_timeout;
 
@@ -167,56 +327,270 @@ static int get_next_timeout_expiry(struct timeval *out,
 	return 1;
 }
 
-/* handle a timeout that has expired */
-static void handle_timeout(struct fpi_timeout *timeout)
+/* handle all the timeouts that have expired, in order of expiry. Timeouts
+ * added by the callbacks are left for the next pass, even if they are
+ * already due, so that a callback re-arming a zero timeout cannot keep this
+ * from returning. They are held out of the heap until the pass is over, so
+ * that the older timeouts behind them still fire in this pass. */
+static int handle_expired_timeouts(struct fp_context *ctx)
 {
-	fp_dbg("");
-	timeout->callback(timeout->data);
-	active_timers = g_slist_remove(active_timers, timeout);
-	g_free(timeout);
+	struct timespec ts;
+	struct timeval now;
+	struct fpi_timeout *timeout;
+	guint64 seq_limit = ctx->timer_seq;
+	int r;
+
+	r = clock_gettime(CLOCK_MONOTONIC, &ts);
+	if (r < 0) {
+		fp_err("failed to read monotonic clock, errno=%d", errno);
+		return r;
+	}
+	TIMESPEC_TO_TIMEVAL(&now, &ts);
+
+	while (ctx->active_timers && ctx->active_timers->len > 0) {
+		timeout = g_ptr_array_index(ctx->active_timers, 0);
+		if (timercmp(&timeout->expiry, &now, >))
+			break;
+
+		timer_heap_remove(timeout);
+		if (timeout->seq >= seq_limit) {
+			timeout->index = TIMER_HELD;
+			g_ptr_array_add(ctx->held_timers, timeout);
+			continue;
+		}
+
+		fp_dbg("");
+		timeout->callback(timeout->data);
+		g_free(timeout);
+	}
+
+	while (ctx->active_timers && ctx->held_timers->len > 0) {
+		timeout = g_ptr_array_remove_index_fast(ctx->held_timers,
+			ctx->held_timers->len - 1);
+		g_ptr_array_add(ctx->active_timers, timeout);
+		timer_heap_sift_up(ctx->active_timers,
+			ctx->active_timers->len - 1);
+	}
+
+	arm_timer_fd(ctx);
+	return 0;
 }
 
-static int handle_timeouts(void)
+struct fpi_work {
+	struct fp_context *ctx;
+	fpi_work_fn work;
+	fpi_work_fn done;
+	/* called instead of done if the work was cancelled */
+	fpi_work_fn destroy;
+	void *data;
+	gboolean cancelled;
+};
+
+/* Make the wake fd of the context readable, to interrupt a wait on the poll
+ * fds. Without eventfd, the wake fd is the read end of a pipe. */
+static void wake_context(struct fp_context *ctx)
 {
-	struct timeval next_timeout_expiry;
-	struct fpi_timeout *next_timeout;
-	int r;
+#ifdef USE_EVENTFD
+	eventfd_write(ctx->wake_fd, 1);
+#else
+	char c = 0;
 
-	r = get_next_timeout_expiry(&next_timeout_expiry, &next_timeout);
-	if (r <= 0)
-		return r;
+	/* a full pipe is readable already */
+	if (write(ctx->wake_write_fd, &c, 1) < 0 && errno != EAGAIN)
+		fp_err("cannot write wake pipe, errno=%d", errno);
+#endif
+}
+
+/* make the wake fd of the context unreadable again */
+static void drain_wake_fd(struct fp_context *ctx)
+{
+#ifdef USE_EVENTFD
+	eventfd_t count;
+
+	eventfd_read(ctx->wake_fd, &count);
+#else
+	char buf[64];
+
+	while (read(ctx->wake_fd, buf, sizeof(buf)) > 0)
+		;
+#endif
+}
 
-	if (!timerisset(&next_timeout_expiry))
-		handle_timeout(next_timeout);
+static int open_wake_fd(struct fp_context *ctx)
+{
+#ifdef USE_EVENTFD
+	ctx->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (ctx->wake_fd < 0) {
+		fp_err("eventfd failed, errno=%d", errno);
+		return -errno;
+	}
+	ctx->wake_write_fd = ctx->wake_fd;
+#else
+	int fds[2];
+	int i;
 
+	if (pipe(fds) < 0) {
+		fp_err("pipe failed, errno=%d", errno);
+		return -errno;
+	}
+	for (i = 0; i < 2; i++) {
+		fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+		fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+	}
+	ctx->wake_fd = fds[0];
+	ctx->wake_write_fd = fds[1];
+#endif
 	return 0;
 }
 
+static void close_wake_fd(struct fp_context *ctx)
+{
+	if (ctx->wake_write_fd != ctx->wake_fd)
+		close(ctx->wake_write_fd);
+	close(ctx->wake_fd);
+}
+
+static void work_thread(gpointer data, gpointer user_data)
+{
+	struct fpi_work *work = data;
+	struct fp_context *ctx = work->ctx;
+
+	work->work(work->data);
+
+	g_mutex_lock(&ctx->work_lock);
+	ctx->work_done = g_slist_prepend(ctx->work_done, work);
+	g_mutex_unlock(&ctx->work_lock);
+
+	wake_context(ctx);
+}
+
+/* Run work(data) on a worker thread. Once it returns, done(data) is called
+ * from the events of the context of the calling thread, in the order the
+ * work finished. Returns the work for fpi_work_cancel(). */
+struct fpi_work *fpi_work_queue(fpi_work_fn work, fpi_work_fn done,
+	void *data)
+{
+	struct fp_context *ctx = fpi_get_context();
+	struct fpi_work *w;
+	GError *err = NULL;
+
+	if (!ctx->work_pool) {
+		ctx->work_pool = g_thread_pool_new(work_thread, NULL,
+			g_get_num_processors(), FALSE, &err);
+		if (!ctx->work_pool) {
+			fp_err("could not create work pool: %s", err->message);
+			g_error_free(err);
+		}
+	}
+
+	w = g_malloc0(sizeof(*w));
+	w->ctx = ctx;
+	w->work = work;
+	w->done = done;
+	w->data = data;
+
+	/* without a pool, run the work right away; done is still called from
+	 * the events, never from within this call */
+	if (ctx->work_pool)
+		g_thread_pool_push(ctx->work_pool, w, NULL);
+	else
+		work_thread(w, NULL);
+	return w;
+}
+
+/* Cancel queued work without waiting for it. The work function may still be
+ * running; once it has returned, destroy(data) is called from the events of
+ * the context instead of the done function. Must be called from the events
+ * of the context, before the done function has run. */
+void fpi_work_cancel(struct fpi_work *work, fpi_work_fn destroy)
+{
+	fp_dbg("");
+	work->cancelled = TRUE;
+	work->destroy = destroy;
+}
+
+/* complete the work that has finished on the worker threads */
+static void handle_done_work(struct fp_context *ctx)
+{
+	GSList *done;
+	GSList *elem;
+
+	/* always reset the wake fd, a worker may write it after we took its
+	 * work on the previous call */
+	drain_wake_fd(ctx);
+	g_mutex_lock(&ctx->work_lock);
+	done = g_slist_reverse(ctx->work_done);
+	ctx->work_done = NULL;
+	g_mutex_unlock(&ctx->work_lock);
+
+	for (elem = done; elem; elem = g_slist_next(elem)) {
+		struct fpi_work *work = elem->data;
+
+		if (!work->cancelled)
+			work->done(work->data);
+		else if (work->destroy)
+			work->destroy(work->data);
+		g_free(work);
+	}
+	g_slist_free(done);
+}
+
+/* Returns the poll fds of the context as struct pollfd, rebuilt only after
+ * the fds have changed. */
+static struct pollfd *get_poll_buf(struct fp_context *ctx, nfds_t *nfds)
+{
+	guint i;
+
+	if (ctx->poll_buf_stale) {
+		g_array_set_size(ctx->poll_buf, ctx->pollfds->len);
+		for (i = 0; i < ctx->pollfds->len; i++) {
+			struct fp_pollfd *pollfd =
+				&g_array_index(ctx->pollfds, struct fp_pollfd, i);
+			struct pollfd *pfd =
+				&g_array_index(ctx->poll_buf, struct pollfd, i);
+			pfd->fd = pollfd->fd;
+			pfd->events = pollfd->events;
+			pfd->revents = 0;
+		}
+		ctx->poll_buf_stale = FALSE;
+	}
+
+	*nfds = ctx->poll_buf->len;
+	return (struct pollfd *) ctx->poll_buf->data;
+}
+
 /** \ingroup poll
  * Handle any pending events. If a non-zero timeout is specified, the function
  * will potentially block for the specified amount of time, although it may
  * return sooner if events have been handled. The function acts as non-blocking
  * for a zero timeout.
  *
+ * Only the events of the context of the calling thread are handled; see
+ * fp_context_set_thread_default().
+ *
  * \param timeout Maximum timeout for this blocking function
  * \returns 0 on success, non-zero on error.
  */
 API_EXPORTED int fp_handle_events_timeout(struct timeval *timeout)
 {
+	struct fp_context *ctx = fpi_get_context();
 	struct timeval next_timeout_expiry;
+	struct timeval usb_timeout;
 	struct timeval select_timeout;
-	struct fpi_timeout *next_timeout;
+	struct timeval zero_tv = { 0, 0 };
+	struct pollfd *fds;
+	nfds_t nfds;
 	int r;
 
-	r = get_next_timeout_expiry(&next_timeout_expiry, &next_timeout);
+	r = get_next_timeout_expiry(ctx, &next_timeout_expiry, NULL);
 	if (r < 0)
 		return r;
 
 	if (r) {
 		/* timer already expired? */
 		if (!timerisset(&next_timeout_expiry)) {
-			handle_timeout(next_timeout);
-			return 0;
+			handle_done_work(ctx);
+			return handle_expired_timeouts(ctx);
 		}
 
 		/* choose the smallest of next URB timeout or user specified timeout */
@@ -228,12 +602,28 @@ API_EXPORTED int fp_handle_events_timeout(struct timeval *timeout)
 		select_timeout = *timeout;
 	}
 
-	r = libusb_handle_events_timeout(fpi_usb_ctx, &select_timeout);
+	if (libusb_get_next_timeout(ctx->usb_ctx, &usb_timeout) == 1
+			&& timercmp(&usb_timeout, &select_timeout, <))
+		select_timeout = usb_timeout;
+
+	/* wait on the fds of libusb together with the wake fd, so that work
+	 * finishing on a worker thread interrupts the wait, then let libusb
+	 * handle whatever is ready without blocking */
+	fds = get_poll_buf(ctx, &nfds);
+	r = poll(fds, nfds, select_timeout.tv_sec * 1000
+		+ (select_timeout.tv_usec + 999) / 1000);
 	*timeout = select_timeout;
+	if (r < 0 && errno != EINTR) {
+		fp_err("poll failed, errno=%d", errno);
+		return -errno;
+	}
+
+	r = libusb_handle_events_timeout(ctx->usb_ctx, &zero_tv);
 	if (r < 0)
 		return r;
 
-	return handle_timeouts();
+	handle_done_work(ctx);
+	return handle_expired_timeouts(ctx);
 }
 
 /** \ingroup poll
@@ -251,19 +641,15 @@ API_EXPORTED int fp_handle_events(void)
 	return fp_handle_events_timeout(&tv);
 }
 
-/* FIXME: docs
- * returns 0 if no timeouts active
- * returns 1 if timeout returned
- * zero timeout means events are to be handled immediately */
-API_EXPORTED int fp_get_next_timeout(struct timeval *tv)
+static int get_next_timeout(struct fp_context *ctx, struct timeval *tv)
 {
 	struct timeval fprint_timeout;
 	struct timeval libusb_timeout;
 	int r_fprint;
 	int r_libusb;
 
-	r_fprint = get_next_timeout_expiry(&fprint_timeout, NULL);
-	r_libusb = libusb_get_next_timeout(fpi_usb_ctx, &libusb_timeout);
+	r_fprint = get_next_timeout_expiry(ctx, &fprint_timeout, NULL);
+	r_libusb = libusb_get_next_timeout(ctx->usb_ctx, &libusb_timeout);
 
 	/* if we have no pending timeouts and the same is true for libusb,
 	 * indicate that we have no pending timouts */
@@ -286,6 +672,15 @@ API_EXPORTED int fp_get_next_timeout(struct timeval *tv)
 	return 1;
 }
 
+/* FIXME: docs
+ * returns 0 if no timeouts active
+ * returns 1 if timeout returned
+ * zero timeout means events are to be handled immediately */
+API_EXPORTED int fp_get_next_timeout(struct timeval *tv)
+{
+	return get_next_timeout(fpi_get_context(), tv);
+}
+
 /** \ingroup poll
  * Retrieve a list of file descriptors that should be polled for events
  * interesting to libfprint. This function is only for users who wish to
@@ -293,70 +688,376 @@ API_EXPORTED int fp_get_next_timeout(struct timeval *tv)
  * simplistic users will be able to call fp_handle_events() or a variant
  * directly.
  *
+ * Besides the file descriptors of libusb, the list includes one that becomes
+ * readable when image processing running on a worker thread has finished.
+ * On Linux, it also includes one that becomes readable when the first timeout
+ * of the library is due, and only the timeouts of libusb itself then need
+ * fp_get_next_timeout(). Elsewhere, fp_get_next_timeout() reports both.
+ *
  * \param pollfds output location for a list of pollfds. If non-NULL, must be
  * released with free() when done.
  * \returns the number of pollfds in the resultant list, or negative on error.
+ * \sa fp_peek_pollfds()
  */
 API_EXPORTED size_t fp_get_pollfds(struct fp_pollfd **pollfds)
 {
-	const struct libusb_pollfd **usbfds;
-	const struct libusb_pollfd *usbfd;
-	struct fp_pollfd *ret;
-	size_t cnt = 0;
-	size_t i = 0;
-
-	usbfds = libusb_get_pollfds(fpi_usb_ctx);
-	if (!usbfds) {
-		*pollfds = NULL;
-		return -EIO;
-	}
+	GArray *fds = fpi_get_context()->pollfds;
+	size_t size = fds->len * sizeof(struct fp_pollfd);
 
-	while ((usbfd = usbfds[i++]) != NULL)
-		cnt++;
+	*pollfds = g_malloc(size);
+	memcpy(*pollfds, fds->data, size);
+	return fds->len;
+}
 
-	ret = g_malloc(sizeof(struct fp_pollfd) * cnt);
-	i = 0;
-	while ((usbfd = usbfds[i]) != NULL) {
-		ret[i].fd = usbfd->fd;
-		ret[i].events = usbfd->events;
-		i++;
-	}
+/** \ingroup poll
+ * Like fp_get_pollfds(), but without copying the list. The list is owned by
+ * the library and stays valid until the next call handling events or
+ * opening or closing a device, as the file descriptors may come and go then.
+ * This suits applications that rebuild their poll set every iteration.
+ *
+ * \param pollfds output location for the list of pollfds
+ * \returns the number of pollfds in the list
+ */
+API_EXPORTED size_t fp_peek_pollfds(const struct fp_pollfd **pollfds)
+{
+	GArray *fds = fpi_get_context()->pollfds;
 
-	*pollfds = ret;
-	return cnt;
+	*pollfds = (const struct fp_pollfd *) fds->data;
+	return fds->len;
 }
 
 /* FIXME: docs */
 API_EXPORTED void fp_set_pollfd_notifiers(fp_pollfd_added_cb added_cb,
 	fp_pollfd_removed_cb removed_cb)
 {
-	fd_added_cb = added_cb;
-	fd_removed_cb = removed_cb;
+	struct fp_context *ctx = fpi_get_context();
+
+	ctx->fd_added_cb = added_cb;
+	ctx->fd_removed_cb = removed_cb;
 }
 
+#ifdef USE_EPOLL
+static int event_loop_add_fd(struct fp_event_loop *loop, int fd, short events)
+{
+	struct epoll_event ev = { 0 };
+
+	if (events & POLLIN)
+		ev.events |= EPOLLIN;
+	if (events & POLLOUT)
+		ev.events |= EPOLLOUT;
+	ev.data.fd = fd;
+	if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		fp_err("cannot watch fd %d, errno=%d", fd, errno);
+		return -errno;
+	}
+	return 0;
+}
+#endif
+
 static void add_pollfd(int fd, short events, void *user_data)
 {
-	if (fd_added_cb)
-		fd_added_cb(fd, events);
+	struct fp_context *ctx = user_data;
+	struct fp_pollfd pollfd = { fd, events };
+
+	g_array_append_val(ctx->pollfds, pollfd);
+	ctx->poll_buf_stale = TRUE;
+
+#ifdef USE_EPOLL
+	if (ctx->event_loop)
+		event_loop_add_fd(ctx->event_loop, fd, events);
+#endif
+	if (ctx->fd_added_cb)
+		ctx->fd_added_cb(fd, events);
 }
 
 static void remove_pollfd(int fd, void *user_data)
 {
-	if (fd_removed_cb)
-		fd_removed_cb(fd);
+	struct fp_context *ctx = user_data;
+	guint i;
+
+	for (i = 0; i < ctx->pollfds->len; i++)
+		if (g_array_index(ctx->pollfds, struct fp_pollfd, i).fd == fd) {
+			g_array_remove_index(ctx->pollfds, i);
+			ctx->poll_buf_stale = TRUE;
+			break;
+		}
+
+#ifdef USE_EPOLL
+	if (ctx->event_loop)
+		epoll_ctl(ctx->event_loop->epfd, EPOLL_CTL_DEL, fd, NULL);
+#endif
+	if (ctx->fd_removed_cb)
+		ctx->fd_removed_cb(fd);
+}
+
+/** \ingroup poll
+ * Create an event loop waiting for the events of all devices of the context
+ * of the calling thread. The loop watches the poll fds of the context as
+ * they come and go, and its iterations dispatch USB transfers and timeouts
+ * to the callbacks of the asynchronous operations running on any of its
+ * devices. The callbacks run with the context of the loop as the thread
+ * default.
+ *
+ * There can only be one event loop per context at a time. Do not mix it
+ * with calls to fp_handle_events() on the same context.
+ *
+ * \returns a new event loop, or NULL if one already exists or on error.
+ * Must be freed with fp_event_loop_free() after use.
+ */
+API_EXPORTED struct fp_event_loop *fp_event_loop_new(void)
+{
+	struct fp_context *ctx = fpi_get_context();
+	struct fp_event_loop *loop;
+#ifdef USE_EPOLL
+	struct fp_pollfd *pollfd;
+	guint i;
+#endif
+
+	if (ctx->event_loop) {
+		fp_err("the context already has an event loop");
+		return NULL;
+	}
+
+	loop = g_malloc0(sizeof(*loop));
+	loop->ctx = ctx;
+#ifdef USE_EPOLL
+	loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epfd < 0) {
+		fp_err("epoll_create1 failed, errno=%d", errno);
+		g_free(loop);
+		return NULL;
+	}
+
+	for (i = 0; i < ctx->pollfds->len; i++) {
+		pollfd = &g_array_index(ctx->pollfds, struct fp_pollfd, i);
+		if (event_loop_add_fd(loop, pollfd->fd, pollfd->events) < 0) {
+			close(loop->epfd);
+			g_free(loop);
+			return NULL;
+		}
+	}
+#endif
+
+	ctx->event_loop = loop;
+	return loop;
+}
+
+/** \ingroup poll
+ * Free an event loop. Devices keep running; their events can then be
+ * handled with fp_handle_events() or a new event loop.
+ * \param loop the event loop to free. If NULL, function simply returns.
+ */
+API_EXPORTED void fp_event_loop_free(struct fp_event_loop *loop)
+{
+	if (!loop)
+		return;
+	if (loop->ctx->event_loop == loop)
+		loop->ctx->event_loop = NULL;
+#ifdef USE_EPOLL
+	close(loop->epfd);
+#endif
+	g_free(loop);
+}
+
+/** \ingroup poll
+ * Get a file descriptor that becomes readable when the loop has events to
+ * handle, including timeouts of the library, so that the loop can be nested
+ * in another event loop. Call fp_event_loop_iterate() with a zero timeout
+ * when it becomes readable, and at the latest when the time reported by
+ * fp_get_next_timeout() has passed.
+ *
+ * Only Linux provides such a file descriptor. Elsewhere, poll the file
+ * descriptors of fp_get_pollfds() instead.
+ *
+ * \param loop an event loop
+ * \returns the file descriptor, owned by the loop, or -1 if there is none
+ */
+API_EXPORTED int fp_event_loop_get_fd(struct fp_event_loop *loop)
+{
+#ifdef USE_EPOLL
+	return loop->epfd;
+#else
+	return -1;
+#endif
 }
 
-void fpi_poll_init(void)
+/** \ingroup poll
+ * Wait for events on any device and dispatch them. Returns once events
+ * have been handled, or once the timeout has passed without any.
+ *
+ * \param loop an event loop
+ * \param timeout_ms maximum time to wait in milliseconds, or -1 to wait
+ * until an event occurs
+ * \returns 0 on success, or a negative error code on failure
+ */
+API_EXPORTED int fp_event_loop_iterate(struct fp_event_loop *loop,
+	int timeout_ms)
 {
-	libusb_set_pollfd_notifiers(fpi_usb_ctx, add_pollfd, remove_pollfd, NULL);
+	struct fp_context *ctx = loop->ctx;
+	struct fp_context *prev_ctx;
+#ifdef USE_EPOLL
+	struct epoll_event events[16];
+#else
+	struct pollfd *fds;
+	nfds_t nfds;
+#endif
+	struct timeval next_timeout;
+	struct timeval zero_tv = { 0, 0 };
+	int next_ms;
+	int r;
+
+	/* the timeouts of the library wake the loop up through the timerfd,
+	 * so only those of libusb bound the wait; without it, both do */
+#ifdef USE_TIMERFD
+	r = libusb_get_next_timeout(ctx->usb_ctx, &next_timeout);
+#else
+	r = get_next_timeout(ctx, &next_timeout);
+#endif
+	if (r == 1) {
+		next_ms = next_timeout.tv_sec * 1000
+			+ (next_timeout.tv_usec + 999) / 1000;
+		if (timeout_ms < 0 || next_ms < timeout_ms)
+			timeout_ms = next_ms;
+	}
+
+#ifdef USE_EPOLL
+	r = epoll_wait(loop->epfd, events, G_N_ELEMENTS(events), timeout_ms);
+	if (r < 0 && errno != EINTR) {
+		fp_err("epoll_wait failed, errno=%d", errno);
+		return -errno;
+	}
+#else
+	fds = get_poll_buf(ctx, &nfds);
+	r = poll(fds, nfds, timeout_ms);
+	if (r < 0 && errno != EINTR) {
+		fp_err("poll failed, errno=%d", errno);
+		return -errno;
+	}
+#endif
+
+	/* timeouts added by the callbacks must go to this loop's context */
+	prev_ctx = fpi_set_context(ctx);
+	r = libusb_handle_events_timeout(ctx->usb_ctx, &zero_tv);
+	if (r == 0) {
+		handle_done_work(ctx);
+		r = handle_expired_timeouts(ctx);
+	}
+	fpi_set_context(prev_ctx);
+	return r;
 }
 
-void fpi_poll_exit(void)
+/** \ingroup poll
+ * Dispatch the events of all devices until fp_event_loop_quit() is called,
+ * typically from the callback of an asynchronous operation.
+ * \param loop an event loop
+ * \returns 0 once the loop was asked to quit, or a negative error code on
+ * failure
+ */
+API_EXPORTED int fp_event_loop_run(struct fp_event_loop *loop)
 {
-	g_slist_free(active_timers);
-	active_timers = NULL;
-	fd_added_cb = NULL;
-	fd_removed_cb = NULL;
-	libusb_set_pollfd_notifiers(fpi_usb_ctx, NULL, NULL, NULL);
+	int r = 0;
+
+	loop->quit = 0;
+	while (!loop->quit && r == 0)
+		r = fp_event_loop_iterate(loop, -1);
+	return r;
+}
+
+/** \ingroup poll
+ * Make fp_event_loop_run() return once the events being handled have been
+ * dispatched. Must be called from the thread running the loop.
+ * \param loop an event loop
+ */
+API_EXPORTED void fp_event_loop_quit(struct fp_event_loop *loop)
+{
+	loop->quit = 1;
+}
+
+int fpi_poll_init(struct fp_context *ctx)
+{
+	const struct libusb_pollfd **usbfds;
+	struct fp_pollfd pollfd;
+	int r;
+	int i;
+
+#ifdef USE_TIMERFD
+	ctx->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+	if (ctx->timer_fd < 0) {
+		fp_err("timerfd_create failed, errno=%d", errno);
+		return -errno;
+	}
+#else
+	ctx->timer_fd = -1;
+#endif
+	timerclear(&ctx->timer_fd_expiry);
+
+	r = open_wake_fd(ctx);
+	if (r < 0) {
+		if (ctx->timer_fd >= 0)
+			close(ctx->timer_fd);
+		return r;
+	}
+	g_mutex_init(&ctx->work_lock);
+	ctx->work_pool = NULL;
+	ctx->work_done = NULL;
+
+	ctx->active_timers = g_ptr_array_new();
+	ctx->held_timers = g_ptr_array_new();
+	ctx->timer_seq = 0;
+
+	ctx->pollfds = g_array_new(FALSE, FALSE, sizeof(struct fp_pollfd));
+	ctx->poll_buf = g_array_new(FALSE, FALSE, sizeof(struct pollfd));
+	ctx->poll_buf_stale = TRUE;
+	pollfd.events = POLLIN;
+	if (ctx->timer_fd >= 0) {
+		pollfd.fd = ctx->timer_fd;
+		g_array_append_val(ctx->pollfds, pollfd);
+	}
+	pollfd.fd = ctx->wake_fd;
+	g_array_append_val(ctx->pollfds, pollfd);
+
+	libusb_set_pollfd_notifiers(ctx->usb_ctx, add_pollfd, remove_pollfd, ctx);
+	usbfds = libusb_get_pollfds(ctx->usb_ctx);
+	if (usbfds) {
+		for (i = 0; usbfds[i]; i++) {
+			pollfd.fd = usbfds[i]->fd;
+			pollfd.events = usbfds[i]->events;
+			g_array_append_val(ctx->pollfds, pollfd);
+		}
+		free(usbfds);
+	}
+	return 0;
+}
+
+void fpi_poll_exit(struct fp_context *ctx)
+{
+	struct fp_context *prev_ctx;
+
+	/* let running work finish, then complete it so that its data is
+	 * released */
+	if (ctx->work_pool)
+		g_thread_pool_free(ctx->work_pool, FALSE, TRUE);
+	ctx->work_pool = NULL;
+	prev_ctx = fpi_set_context(ctx);
+	handle_done_work(ctx);
+	fpi_set_context(prev_ctx);
+	g_mutex_clear(&ctx->work_lock);
+	close_wake_fd(ctx);
+	if (ctx->timer_fd >= 0)
+		close(ctx->timer_fd);
+
+	if (ctx->active_timers)
+		g_ptr_array_free(ctx->active_timers, TRUE);
+	ctx->active_timers = NULL;
+	if (ctx->held_timers)
+		g_ptr_array_free(ctx->held_timers, TRUE);
+	ctx->held_timers = NULL;
+	ctx->fd_added_cb = NULL;
+	ctx->fd_removed_cb = NULL;
+	libusb_set_pollfd_notifiers(ctx->usb_ctx, NULL, NULL, NULL);
+	g_array_free(ctx->pollfds, TRUE);
+	ctx->pollfds = NULL;
+	g_array_free(ctx->poll_buf, TRUE);
+	ctx->poll_buf = NULL;
 }
 